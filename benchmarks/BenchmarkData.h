@@ -0,0 +1,48 @@
+/** @file
+    @brief Header with deterministic input data shared by the benchmarks.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_BenchmarkData_h_GUID_2F6A9C41_7D3E_4B58_A1E6_93C0D4B7E215
+#define INCLUDED_BenchmarkData_h_GUID_2F6A9C41_7D3E_4B58_A1E6_93C0D4B7E215
+
+// Internal Includes
+#include <subdiv2d/Types.h>
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace benchmark_data {
+using sensics::subdiv2d::Point2f;
+using sensics::subdiv2d::Rect;
+
+/// All benchmark points lie in this rect.
+static const Rect Bounds(0, 0, 1000, 1000);
+
+/// Uniformly-distributed points in Bounds, in arbitrary (generation) order, like a measurement file.
+inline std::vector<Point2f> makeRandomPoints(std::size_t n, unsigned int seed = 1234) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.f, 999.f);
+    std::vector<Point2f> ret;
+    ret.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ret.emplace_back(dist(rng), dist(rng));
+    }
+    return ret;
+}
+} // namespace benchmark_data
+
+#endif // INCLUDED_BenchmarkData_h_GUID_2F6A9C41_7D3E_4B58_A1E6_93C0D4B7E215
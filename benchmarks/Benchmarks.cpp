@@ -0,0 +1,16 @@
+/** @file
+    @brief Main file for the benchmarks: run in an optimized build, e.g. `Benchmarks [construction]`
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include "catch.hpp"
@@ -0,0 +1,190 @@
+/** @file
+    @brief Benchmarks for building a triangulation.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#include "BenchmarkData.h"
+#include <subdiv2d/Predicates.h>
+#include <subdiv2d/Subdivision2D.h>
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+using namespace sensics::subdiv2d;
+using namespace benchmark_data;
+
+TEST_CASE("Insertion order", "[construction]") {
+    for (std::size_t n : {10000, 200000}) {
+        const auto pts = makeRandomPoints(n);
+        std::ostringstream suffix;
+        suffix << " (" << n << " points)";
+
+        BENCHMARK("Single-point insert loop, file order" + suffix.str()) {
+            Subdiv2D subdiv(Bounds);
+            for (auto& pt : pts) {
+                subdiv.insert(pt);
+            }
+        }
+
+        BENCHMARK("Bulk insert, spatially sorted" + suffix.str()) {
+            Subdiv2D subdiv(Bounds);
+            subdiv.insert(pts);
+        }
+
+        BENCHMARK("Divide and conquer build" + suffix.str()) { auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts); }
+
+        BENCHMARK("Divide and conquer build, all cores" + suffix.str()) {
+            auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts, 0u);
+        }
+    }
+}
+
+TEST_CASE("Grid input", "[construction][grid]") {
+    // A measurement grid far from the origin with a spacing that floats can't represent: nearly every set of four
+    // neighbors is cocircular to within rounding, the worst case for the predicates.
+    static const int side = 300;
+    std::vector<Point2f> pts;
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            pts.emplace_back(float(1000000.1 + x / 3.), float(1000000.1 + y / 3.));
+        }
+    }
+    const Rect bounds(0, 0, 2000000, 2000000);
+    auto reportStats = [&](const char* name) {
+        const auto stats = getPredicateStats();
+        std::cout << name << ": " << stats.orientationExact << " exact orientation and " << stats.inCircleExact
+                  << " exact in-circle evaluations for " << pts.size() << " points" << std::endl;
+    };
+
+    resetPredicateStats();
+    BENCHMARK("Bulk insert, 300x300 grid") {
+        Subdiv2D subdiv(bounds);
+        subdiv.insert(pts);
+    }
+    reportStats("Bulk insert");
+
+    resetPredicateStats();
+    BENCHMARK("Divide and conquer build, 300x300 grid") { auto subdiv = Subdiv2D::buildDelaunay(bounds, pts); }
+    reportStats("Divide and conquer build");
+}
+
+TEST_CASE("Storage", "[construction][storage]") {
+    const auto pts = makeRandomPoints(200000);
+
+    BENCHMARK("Bulk insert, growing arrays (200000 points)") {
+        Subdiv2D subdiv(Bounds);
+        subdiv.insert(pts);
+    }
+
+    BENCHMARK("Bulk insert, reserved (200000 points)") {
+        Subdiv2D subdiv(Bounds);
+        subdiv.reserve(pts.size());
+        subdiv.insert(pts);
+    }
+
+    BENCHMARK("Bulk insert, reserved in an arena (200000 points)") {
+        ArenaMemoryResource arena;
+        Subdiv2D subdiv(Bounds, SubdivMode::DelaunayAndVoronoi, &arena);
+        subdiv.reserve(pts.size());
+        subdiv.insert(pts);
+    }
+
+    HugePageMemoryResource hugePages;
+    BENCHMARK("Bulk insert, reserved in huge pages (200000 points)") {
+        Subdiv2D subdiv(Bounds, SubdivMode::DelaunayAndVoronoi, &hugePages);
+        subdiv.reserve(pts.size());
+        subdiv.insert(pts);
+    }
+
+    BENCHMARK("Divide and conquer build in huge pages (200000 points)") {
+        auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts, nullptr, SubdivMode::DelaunayAndVoronoi, &hugePages);
+    }
+}
+
+TEST_CASE("Snapshots", "[construction][snapshot]") {
+    const auto pts = makeRandomPoints(200000);
+    const char* path = "subdiv2d_snapshot_benchmark.bin";
+    auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    const auto queries = makeRandomPoints(1000, 4321);
+
+    BENCHMARK("Save snapshot (200000 points)") { subdiv.save(path); }
+
+    BENCHMARK("Divide and conquer build, then 1000 queries (200000 points)") {
+        auto built = Subdiv2D::buildDelaunay(Bounds, pts);
+        LocateCursor cursor;
+        for (auto& pt : queries) {
+            built.findNearest(pt, nullptr, &cursor);
+        }
+    }
+
+    BENCHMARK("Load snapshot, then 1000 queries (200000 points)") {
+        auto loaded = Subdiv2D::load(path);
+        LocateCursor cursor;
+        for (auto& pt : queries) {
+            loaded.findNearest(pt, nullptr, &cursor);
+        }
+    }
+    std::remove(path);
+}
+
+TEST_CASE("Journaling", "[construction][journal]") {
+    const auto pts = makeRandomPoints(20000);
+    const char* snapshotPath = "subdiv2d_journal_benchmark.snapshot";
+    const char* journalPath = "subdiv2d_journal_benchmark.journal";
+
+    BENCHMARK("Single-point insert loop (20000 points)") {
+        Subdiv2D subdiv(Bounds);
+        for (auto& pt : pts) {
+            subdiv.insert(pt);
+        }
+    }
+
+    BENCHMARK("Single-point insert loop, journaled (20000 points)") {
+        Subdiv2D subdiv(Bounds);
+        subdiv.startJournal(snapshotPath, journalPath);
+        for (auto& pt : pts) {
+            subdiv.insert(pt);
+        }
+    }
+
+    BENCHMARK("Recovery (20000 points)") { auto subdiv = Subdiv2D::recover(snapshotPath, journalPath); }
+    std::remove(snapshotPath);
+    std::remove(journalPath);
+}
+
+TEST_CASE("Growing the bounds", "[construction][grow]") {
+    const auto pts = makeRandomPoints(200000);
+    const auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    // A run of samples drifting out past the right edge.
+    std::vector<Point2f> outside;
+    for (int i = 0; i < 100; ++i) {
+        outside.push_back(Point2f(1000.5f + 10.f * i, 500.f + 0.5f * i));
+    }
+
+    BENCHMARK("Copy (200000 points)") { auto copy = subdiv; }
+
+    BENCHMARK("Copy, then insert 100 points outside, growing the bounds (200000 points)") {
+        auto copy = subdiv;
+        copy.setGrowableBounds(true);
+        for (auto& pt : outside) {
+            copy.insert(pt);
+        }
+    }
+
+    BENCHMARK("Rebuild with bounds taking 100 points outside (200000 points)") {
+        auto all = pts;
+        all.insert(all.end(), outside.begin(), outside.end());
+        auto rebuilt = Subdiv2D::buildDelaunay(Rect(0, 0, 2000, 1000), all);
+    }
+}
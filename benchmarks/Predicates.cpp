@@ -0,0 +1,61 @@
+/** @file
+    @brief Benchmarks for the batch geometric predicates at each supported instruction set.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#include "BenchmarkData.h"
+#include <subdiv2d/Predicates.h>
+
+#include "catch.hpp"
+
+using namespace sensics::subdiv2d;
+using namespace benchmark_data;
+
+TEST_CASE("Batch predicates", "[predicates]") {
+    static const std::size_t n = 1000000;
+    const auto pts = makeRandomPoints(n);
+    const auto a = makeRandomPoints(n, 1);
+    const auto b = makeRandomPoints(n, 2);
+    const auto c = makeRandomPoints(n, 3);
+    std::vector<double> areas(n);
+    std::vector<int> results(n);
+
+    BENCHMARK("doubleTriangleArea loop (1M)") {
+        for (std::size_t i = 0; i < n; ++i) {
+            areas[i] = doubleTriangleArea(a[i], b[i], c[i]);
+        }
+    }
+
+    BENCHMARK("isPtInCircle3 loop (1M)") {
+        for (std::size_t i = 0; i < n; ++i) {
+            results[i] = isPtInCircle3(pts[i], a[i], b[i], c[i]);
+        }
+    }
+
+    const auto supported = getSupportedSimdLevel();
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (level > supported) {
+            break;
+        }
+        setSimdLevel(level);
+        const char* name = level == SimdLevel::Scalar ? "scalar" : (level == SimdLevel::SSE2 ? "SSE2" : "AVX2");
+
+        BENCHMARK(std::string("doubleTriangleAreaBatch, ") + name + " (1M)") {
+            doubleTriangleAreaBatch(a.data(), b.data(), c.data(), areas.data(), n);
+        }
+
+        BENCHMARK(std::string("isPtInCircle3Batch, ") + name + " (1M)") {
+            isPtInCircle3Batch(pts.data(), a.data(), b.data(), c.data(), results.data(), n);
+        }
+    }
+    setSimdLevel(supported);
+}
@@ -0,0 +1,250 @@
+/** @file
+    @brief Benchmarks for queries on a triangulation.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#include "BenchmarkData.h"
+#include <subdiv2d/Subdivision2D.h>
+#include <subdiv2d/VersionPublisher.h>
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace sensics::subdiv2d;
+using namespace benchmark_data;
+
+TEST_CASE("Point location", "[queries]") {
+    const auto pts = makeRandomPoints(100000);
+    const auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    // Random order, as from a grid evaluation over a distorted mapping. (Few enough that the slow loops stay within
+    // the 32-bit nanosecond range of this version of Catch's benchmark timer.)
+    const auto queries = makeRandomPoints(100000, 5678);
+    std::vector<PtLoc> locs(queries.size());
+    std::vector<VertexArray> vertices(queries.size());
+
+    BENCHMARK("locateVertexIdsArray loop (100k queries, 100k points)") {
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            vertices[i] = subdiv.locateVertexIdsArray(queries[i]);
+        }
+    }
+
+    BENCHMARK("locateVertexIdsArray loop with cursor (100k queries, 100k points)") {
+        LocateCursor cursor;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            vertices[i] = subdiv.locateVertexIdsArray(queries[i], &cursor);
+        }
+    }
+
+    BENCHMARK("locateBatch (100k queries, 100k points)") {
+        subdiv.locateBatch(queries.data(), queries.size(), locs.data(), nullptr, vertices.data());
+    }
+}
+
+TEST_CASE("Point location in a large triangulation", "[queries][large]") {
+    // Large enough that the quad-edges don't fit in cache, so that each walk step costs memory traffic.
+    const auto pts = makeRandomPoints(1000000);
+    const auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    const auto queries = makeRandomPoints(200000, 5678);
+    std::vector<PtLoc> locs(queries.size());
+    std::vector<VertexArray> vertices(queries.size());
+
+    BENCHMARK("locateVertexIdsArray loop with cursor (10k queries, 1M points)") {
+        LocateCursor cursor;
+        for (std::size_t i = 0; i < 10000; ++i) {
+            vertices[i] = subdiv.locateVertexIdsArray(queries[i], &cursor);
+        }
+    }
+
+    BENCHMARK("locateBatch (200k queries, 1M points)") {
+        subdiv.locateBatch(queries.data(), queries.size(), locs.data(), nullptr, vertices.data());
+    }
+}
+
+TEST_CASE("Nearest vertex", "[queries][nearest]") {
+    const auto pts = makeRandomPoints(100000);
+    auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    const auto queries = makeRandomPoints(100000, 5678);
+    std::vector<VertexId> nearest(queries.size());
+
+    BENCHMARK("findNearest loop with cursor (100k queries, 100k points)") {
+        LocateCursor cursor;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            nearest[i] = subdiv.findNearest(queries[i], nullptr, &cursor);
+        }
+    }
+
+    BENCHMARK("findNearestBatch (100k queries, 100k points)") {
+        subdiv.findNearestBatch(queries.data(), queries.size(), nearest.data());
+    }
+}
+
+TEST_CASE("Neighbor queries", "[queries][neighbors]") {
+    const auto pts = makeRandomPoints(100000);
+    auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    // In a spatially-coherent order, as when smoothing over a grid, so the time is in the searches rather than the
+    // walks between them.
+    std::vector<Point2f> queries;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            queries.emplace_back(x * 9.99f + 0.5f, y * 9.99f + 0.5f);
+        }
+    }
+    NeighborSearchScratch scratch;
+    std::vector<VertexId> result(16);
+
+    BENCHMARK("findKNearest, k = 8 (10k queries, 100k points)") {
+        LocateCursor cursor;
+        for (auto& q : queries) {
+            subdiv.findKNearest(q, 8, result.data(), &scratch, &cursor);
+        }
+    }
+
+    BENCHMARK("findWithinRadius, about 8 results (10k queries, 100k points)") {
+        LocateCursor cursor;
+        for (auto& q : queries) {
+            subdiv.findWithinRadius(q, 5.f, result, &scratch, &cursor);
+        }
+    }
+}
+
+TEST_CASE("Interleaved insertion and nearest-vertex queries", "[queries][voronoi]") {
+    const auto pts = makeRandomPoints(100000);
+    const auto extra = makeRandomPoints(1000, 91);
+    const auto queries = makeRandomPoints(1000, 5678);
+    const auto base = Subdiv2D::buildDelaunay(Bounds, pts);
+
+    BENCHMARK("1000 x (insert, findNearest) (100k points)") {
+        auto subdiv = base;
+        for (std::size_t i = 0; i < extra.size(); ++i) {
+            subdiv.insert(extra[i]);
+            subdiv.findNearest(queries[i]);
+        }
+    }
+}
+
+TEST_CASE("Mesh export", "[queries][export]") {
+    const auto pts = makeRandomPoints(1000000);
+    const auto subdiv = Subdiv2D::buildDelaunay(Bounds, pts);
+    std::vector<Subdiv2D::Triangle> triangles;
+    std::vector<EdgeId> edges;
+    IndexedMesh mesh;
+    // Let the outputs grow once, so only the traversals are measured.
+    subdiv.getTriangleList(triangles);
+    subdiv.getLeadingEdgeList(edges);
+    subdiv.getIndexedMesh(mesh);
+
+    BENCHMARK("getTriangleList (1M points)") { subdiv.getTriangleList(triangles); }
+
+    BENCHMARK("getLeadingEdgeList (1M points)") { subdiv.getLeadingEdgeList(edges); }
+
+    BENCHMARK("getIndexedMesh (1M points)") { subdiv.getIndexedMesh(mesh); }
+
+    BENCHMARK("Sum of triangles() areas (1M points)") {
+        double area = 0;
+        for (auto t : subdiv.triangles(ElementFilter::SkipBoundary)) {
+            auto pts = t.positions();
+            area += doubleTriangleArea(pts[0], pts[1], pts[2]);
+        }
+        REQUIRE(area > 0);
+    }
+}
+
+TEST_CASE("Compaction", "[queries][compact]") {
+    // A long-lived mesh: built a point at a time in arbitrary order, so neighbors are scattered through the arrays,
+    // then a third of the points removed, leaving free slots.
+    const auto pts = makeRandomPoints(300000);
+    Subdiv2D scattered(Bounds);
+    std::vector<VertexId> ids;
+    for (auto& pt : pts) {
+        ids.push_back(scattered.insert(pt));
+    }
+    for (std::size_t i = 0; i < ids.size(); i += 3) {
+        scattered.remove(ids[i]);
+    }
+    auto compacted = scattered;
+    compacted.compact();
+    const auto queries = makeRandomPoints(200000, 5678);
+    std::vector<PtLoc> locs(queries.size());
+    std::vector<VertexArray> vertices(queries.size());
+    std::vector<VertexId> nearest(queries.size());
+
+    BENCHMARK("compact (200k points, 100k removed)") {
+        auto subdiv = scattered;
+        subdiv.compact();
+    }
+
+    for (auto subdiv : {&scattered, &compacted}) {
+        const std::string suffix = subdiv == &scattered ? ", scattered (200k points)" : ", compacted (200k points)";
+
+        BENCHMARK("locateVertexIdsArray loop with cursor (10k queries)" + suffix) {
+            LocateCursor cursor;
+            for (std::size_t i = 0; i < 10000; ++i) {
+                vertices[i] = subdiv->locateVertexIdsArray(queries[i], &cursor);
+            }
+        }
+
+        BENCHMARK("locateBatch (200k queries)" + suffix) {
+            subdiv->locateBatch(queries.data(), queries.size(), locs.data(), nullptr, vertices.data());
+        }
+
+        BENCHMARK("findNearestBatch (200k queries)" + suffix) {
+            subdiv->findNearestBatch(queries.data(), queries.size(), nearest.data());
+        }
+    }
+}
+
+TEST_CASE("Published versions", "[queries][publish]") {
+    const auto pts = makeRandomPoints(100000);
+    VersionPublisher<Subdiv2D> publisher(Subdiv2D::buildDelaunay(Bounds, pts));
+    // Few enough queries to stay within the range of the benchmark timer, with the writer taking turns on the cores.
+    const auto queries = makeRandomPoints(20000, 5678);
+    std::vector<VertexId> nearest(queries.size());
+    VersionReader<Subdiv2D> reader(publisher);
+
+    BENCHMARK("findNearest loop with cursor, pinning once (20k queries, 100k points)") {
+        LocateCursor cursor;
+        auto pinned = reader.pin();
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            nearest[i] = pinned->findNearest(queries[i], nullptr, &cursor);
+        }
+    }
+
+    BENCHMARK("findNearest loop with cursor, pinning per query (20k queries, 100k points)") {
+        LocateCursor cursor;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            nearest[i] = reader.pin()->findNearest(queries[i], nullptr, &cursor);
+        }
+    }
+
+    // A writer copying, extending and publishing new versions the whole time: the readers never wait for it.
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        const auto extra = makeRandomPoints(1000, 91);
+        std::size_t i = 0;
+        while (!done) {
+            auto next = publisher.copyCurrent();
+            next.insert(extra[i++ % extra.size()]);
+            publisher.publish(std::move(next));
+        }
+    });
+
+    BENCHMARK("findNearest loop with cursor, pinning per query, while publishing (20k queries, 100k points)") {
+        LocateCursor cursor;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            nearest[i] = reader.pin()->findNearest(queries[i], nullptr, &cursor);
+        }
+    }
+    done = true;
+    writer.join();
+}
@@ -16,6 +16,7 @@
 #include <array>
 #include <cstddef>
 #include <stdexcept>
+#include <utility>
 
 template <typename T, std::size_t MaxSize> class MaxSizeVector {
     using container_type = std::array<T, MaxSize>;
@@ -44,6 +45,12 @@ template <typename T, std::size_t MaxSize> class MaxSizeVector {
     T const& front() const { return data_[0]; }
     T& front() { return data_[0]; }
 
+    T const& operator[](std::size_t i) const { return data_[i]; }
+    T& operator[](std::size_t i) { return data_[i]; }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
     iterator begin() { return data_.begin(); }
     const_iterator begin() const { return data_.begin(); }
     const_iterator cbegin() const { return data_.cbegin(); }
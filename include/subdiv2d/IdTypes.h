@@ -22,6 +22,7 @@
 // - none
 
 // Standard includes
+#include <cstdint>
 #include <limits>
 
 namespace sensics {
@@ -34,6 +35,8 @@ namespace subdiv2d {
         struct EdgeTag;
         /// Used by Subdivision2D
         struct QuadEdgeTag;
+        /// Used by Subdivision2D
+        struct FaceTag;
 
         /// Used by SubdivContainer.
         struct VertexValueTag;
@@ -67,6 +70,15 @@ namespace detail {
     /// Right now, using int for QuadEdge ids
     template <> struct TypeSafeIndexValueTypeTrait<subdiv2d::detail::QuadEdgeTag> { using type = int; };
 
+    template <> struct TypeSafeIndexNameTrait<subdiv2d::detail::FaceTag> {
+        static constexpr const char* get() { return "FaceId"; }
+    };
+    /// Face IDs are dense from 0, so using the max value of a 32-bit unsigned type as the invalid value.
+    template <> struct TypeSafeIndexValueTypeTrait<subdiv2d::detail::FaceTag> { using type = std::uint32_t; };
+    template <> struct TypeSafeIndexInitValueTrait<subdiv2d::detail::FaceTag> {
+        static constexpr std::uint32_t get() { return std::numeric_limits<std::uint32_t>::max(); }
+    };
+
     template <> struct TypeSafeIndexNameTrait<subdiv2d::detail::VertexValueTag> {
         static constexpr const char* get() { return "VertexValueId"; }
     };
@@ -88,6 +100,9 @@ namespace subdiv2d {
     using QuadEdgeId = ::sensics::detail::TypeSafeIndex<detail::QuadEdgeTag>;
     static const QuadEdgeId InvalidQuadEdge = QuadEdgeId();
 
+    using FaceId = ::sensics::detail::TypeSafeIndex<detail::FaceTag>;
+    static const FaceId InvalidFace = FaceId();
+
     using VertexValueId = ::sensics::detail::TypeSafeIndex<detail::VertexValueTag>;
     static const VertexValueId InvalidVertexValueId = VertexValueId();
 } // namespace subdiv2d
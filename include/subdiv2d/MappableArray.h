@@ -0,0 +1,184 @@
+/** @file
+    @brief Header providing the array type for the large arrays of a subdivision: a minimal vector that can also borrow
+    its elements from memory it does not own, such as a memory-mapped snapshot file.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_MappableArray_h_GUID_7D3A1C5E_4B82_4F96_A0E3_5C9B2D8F1E47
+#define INCLUDED_MappableArray_h_GUID_7D3A1C5E_4B82_4F96_A0E3_5C9B2D8F1E47
+
+// Internal Includes
+#include "MemoryResource.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /** @brief A vector of trivially-copyable elements, with its memory from a MemoryResource, that can instead
+        borrow elements it does not own.
+
+        A borrowed array reads and writes the borrowed memory in place (so that memory must be writable, for instance a
+        private mapping, where writes are copy-on-write), and only copies the elements into memory of its own when it
+        has to grow. Copies of the array always own their elements. */
+        template <typename T> class MappableArray {
+            static_assert(std::is_trivially_copyable<T>::value, "Elements are copied and borrowed as raw bytes");
+
+          public:
+            using value_type = T;
+            using iterator = T*;
+            using const_iterator = T const*;
+
+            /// @param resource nullptr for the default resource.
+            explicit MappableArray(MemoryResource* resource = nullptr)
+                : resource_(resource ? resource : getDefaultMemoryResource()) {}
+            MappableArray(MappableArray const& other) : resource_(other.resource_) { assign(other); }
+            MappableArray(MappableArray&& other) : resource_(other.resource_) { steal(other); }
+            /// Assigning a copy keeps this array's resource, while moving takes the other's.
+            MappableArray& operator=(MappableArray const& other) {
+                if (this != &other) {
+                    assign(other);
+                }
+                return *this;
+            }
+            MappableArray& operator=(MappableArray&& other) {
+                if (this != &other) {
+                    release();
+                    resource_ = other.resource_;
+                    steal(other);
+                }
+                return *this;
+            }
+            ~MappableArray() { release(); }
+
+            std::size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+            std::size_t capacity() const { return capacity_; }
+            MemoryResource* resource() const { return resource_; }
+            /// Whether the elements are borrowed rather than owned.
+            bool isBorrowed() const { return static_cast<bool>(borrowed_); }
+
+            T* data() { return data_; }
+            T const* data() const { return data_; }
+            T& operator[](std::size_t i) { return data_[i]; }
+            T const& operator[](std::size_t i) const { return data_[i]; }
+            T* begin() { return data_; }
+            T* end() { return data_ + size_; }
+            T const* begin() const { return data_; }
+            T const* end() const { return data_ + size_; }
+
+            void reserve(std::size_t n) {
+                if (n > capacity_) {
+                    reallocate(n);
+                }
+            }
+
+            void resize(std::size_t n, T const& value = T()) {
+                if (n > capacity_) {
+                    // Geometric growth, as for push_back(): the edge array grows one at a time.
+                    reallocate(std::max(n, 2 * capacity_));
+                }
+                for (std::size_t i = size_; i < n; ++i) {
+                    ::new (static_cast<void*>(data_ + i)) T(value);
+                }
+                size_ = n;
+            }
+
+            void push_back(T const& value) {
+                if (size_ == capacity_) {
+                    // Copy first, in case value is one of our own elements.
+                    const T copy = value;
+                    reallocate(std::max<std::size_t>(2 * capacity_, 8));
+                    ::new (static_cast<void*>(data_ + size_)) T(copy);
+                } else {
+                    ::new (static_cast<void*>(data_ + size_)) T(value);
+                }
+                ++size_;
+            }
+
+            /// Empties the array, also dropping any borrowed elements, but keeps owned memory for reuse.
+            void clear() {
+                if (borrowed_) {
+                    forget();
+                }
+                size_ = 0;
+            }
+
+            /// Discards the current elements and borrows n elements at data, which must stay valid and writable as long
+            /// as keepAlive is held.
+            void borrow(T* data, std::size_t n, std::shared_ptr<void> keepAlive) {
+                release();
+                data_ = data;
+                size_ = capacity_ = n;
+                borrowed_ = std::move(keepAlive);
+            }
+
+          private:
+            void reallocate(std::size_t n) {
+                T* p = static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+                if (size_) {
+                    std::memcpy(static_cast<void*>(p), static_cast<void const*>(data_), size_ * sizeof(T));
+                }
+                const auto size = size_;
+                release();
+                data_ = p;
+                size_ = size;
+                capacity_ = n;
+            }
+            void assign(MappableArray const& other) {
+                clear();
+                reserve(other.size_);
+                if (other.size_) {
+                    std::memcpy(static_cast<void*>(data_), static_cast<void const*>(other.data_),
+                                other.size_ * sizeof(T));
+                }
+                size_ = other.size_;
+            }
+            void steal(MappableArray& other) {
+                data_ = other.data_;
+                size_ = other.size_;
+                capacity_ = other.capacity_;
+                borrowed_ = std::move(other.borrowed_);
+                other.forget();
+            }
+            void release() {
+                if (data_ && !borrowed_) {
+                    resource_->deallocate(data_, capacity_ * sizeof(T), alignof(T));
+                }
+                forget();
+            }
+            void forget() {
+                data_ = nullptr;
+                size_ = capacity_ = 0;
+                borrowed_.reset();
+            }
+
+            MemoryResource* resource_;
+            T* data_ = nullptr;
+            std::size_t size_ = 0;
+            std::size_t capacity_ = 0;
+            /// Non-null exactly when the elements are borrowed.
+            std::shared_ptr<void> borrowed_;
+        };
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_MappableArray_h_GUID_7D3A1C5E_4B82_4F96_A0E3_5C9B2D8F1E47
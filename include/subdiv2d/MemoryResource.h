@@ -0,0 +1,96 @@
+/** @file
+    @brief Header providing pluggable sources of memory for the large arrays of a subdivision: an interface, an arena,
+    and a huge-page-backed resource.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_MemoryResource_h_GUID_2E6B4F1A_9C57_4D83_B0E2_7A1C5D3F8E64
+#define INCLUDED_MemoryResource_h_GUID_2E6B4F1A_9C57_4D83_B0E2_7A1C5D3F8E64
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <vector>
+
+namespace sensics {
+namespace subdiv2d {
+    /** @brief A source of memory: a C++11 stand-in for std::pmr::memory_resource.
+
+    Implementations must be safe to use from several threads at once if the subdivisions using them are. */
+    class MemoryResource {
+      public:
+        virtual ~MemoryResource();
+        /// Returns at least bytes of memory aligned to alignment, or throws std::bad_alloc.
+        virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+        /// Returns memory obtained from allocate() with the same size and alignment.
+        virtual void deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+    };
+
+    /** @brief Returns the resource used when none is given: plain operator new and delete. */
+    MemoryResource* getDefaultMemoryResource();
+
+    /** @brief Carves allocations out of large chunks, and frees them all at once, when released or destroyed.
+
+    Deallocation does nothing, so the memory of an array that grows is not reused: reserve() the subdivision first.
+    Not thread-safe. Must outlive every subdivision (and copy of a subdivision) using it. */
+    class ArenaMemoryResource : public MemoryResource {
+      public:
+        /// @param chunkSize Size of each chunk requested from upstream. Larger allocations get a chunk of their own.
+        /// @param upstream Where the chunks come from: nullptr for the default resource.
+        explicit ArenaMemoryResource(std::size_t chunkSize = DefaultChunkSize, MemoryResource* upstream = nullptr);
+        ~ArenaMemoryResource() override;
+        ArenaMemoryResource(ArenaMemoryResource const&) = delete;
+        ArenaMemoryResource& operator=(ArenaMemoryResource const&) = delete;
+
+        void* allocate(std::size_t bytes, std::size_t alignment) override;
+        void deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+        /// Returns all of the chunks upstream. Any memory allocated from this arena must no longer be in use.
+        void release();
+
+        /// Total size of the chunks currently held.
+        std::size_t getBytesHeld() const { return bytesHeld_; }
+
+        static const std::size_t DefaultChunkSize = 1 << 20;
+
+      private:
+        struct Chunk {
+            void* data;
+            std::size_t size;
+        };
+        std::size_t chunkSize_;
+        MemoryResource* upstream_;
+        std::vector<Chunk> chunks_;
+        char* cur_ = nullptr;
+        char* end_ = nullptr;
+        std::size_t bytesHeld_ = 0;
+    };
+
+    /** @brief Maps large allocations directly from the operating system, asking for them to be backed by huge pages to
+    reduce TLB misses on a big mesh.
+
+    Allocations smaller than a huge page, or on platforms without support (anything but Linux, for now), are passed on
+    to the default resource. Thread-safe. */
+    class HugePageMemoryResource : public MemoryResource {
+      public:
+        void* allocate(std::size_t bytes, std::size_t alignment) override;
+        void deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+        static const std::size_t HugePageSize = 2 << 20;
+    };
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_MemoryResource_h_GUID_2E6B4F1A_9C57_4D83_B0E2_7A1C5D3F8E64
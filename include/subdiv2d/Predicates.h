@@ -0,0 +1,83 @@
+/** @file
+    @brief Header providing batch versions of the geometric predicates in Types.h, with SIMD implementations selected
+    at runtime, and statistics on how often the predicates needed exact arithmetic.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_Predicates_h_GUID_5B0E7C2D_3A94_4F61_8D27_C4E19A6B0F85
+#define INCLUDED_Predicates_h_GUID_5B0E7C2D_3A94_4F61_8D27_C4E19A6B0F85
+
+// Internal Includes
+#include "Types.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+namespace sensics {
+namespace subdiv2d {
+    /** @brief The instruction sets the batch predicates may be evaluated with. */
+    enum class SimdLevel {
+        /// Plain C++: the same code as the single predicates in Types.h.
+        Scalar,
+        /// Two doubles at a time: available on every x86-64 processor.
+        SSE2,
+        /// Four doubles at a time.
+        AVX2
+    };
+
+    /** @brief Returns the best instruction set that both this build and the processor it is running on support. */
+    SimdLevel getSupportedSimdLevel();
+
+    /** @brief Returns the instruction set the batch predicates are currently using: by default, the best supported. */
+    SimdLevel getSimdLevel();
+
+    /** @brief Selects the instruction set for the batch predicates (in all threads), for testing or benchmarking. A
+    level beyond what is supported is lowered to getSupportedSimdLevel(). */
+    void setSimdLevel(SimdLevel level);
+
+    /** @brief Counts of predicate evaluations that the floating-point filter could not settle, so that were redone with
+    exact arithmetic. */
+    struct PredicateStats {
+        /// From triangleOrientation() and isRightOf(), single or batch.
+        std::uint64_t orientationExact = 0;
+        /// From isPtInCircle3(), single or batch.
+        std::uint64_t inCircleExact = 0;
+    };
+
+    /** @brief Returns the counts since the program started or resetPredicateStats() was last called, over all threads.
+     */
+    PredicateStats getPredicateStats();
+
+    /** @brief Sets the counts returned by getPredicateStats() back to zero. */
+    void resetPredicateStats();
+
+    /** @brief Computes out[i] = doubleTriangleArea(a[i], b[i], c[i]) for i in [0, n).
+
+    The results are bit-for-bit identical to those of the single version, whichever instruction set is in use: the
+    same operations are performed in the same order, just on several points at once. */
+    void doubleTriangleAreaBatch(Point2f const* a, Point2f const* b, Point2f const* c, double* out, std::size_t n);
+
+    /** @brief Computes out[i] = isRightOf(pt[i], a[i], b[i]) for i in [0, n).
+
+    Like the single version, the result is exact: the kernels apply the same floating-point filter, and inputs it
+    cannot settle are redone with exact arithmetic. */
+    void isRightOfBatch(Point2f const* pt, Point2f const* a, Point2f const* b, int* out, std::size_t n);
+
+    /** @brief Computes out[i] = isPtInCircle3(pt[i], a[i], b[i], c[i]) for i in [0, n): exact, as isRightOfBatch(). */
+    void isPtInCircle3Batch(Point2f const* pt, Point2f const* a, Point2f const* b, Point2f const* c, int* out,
+                            std::size_t n);
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_Predicates_h_GUID_5B0E7C2D_3A94_4F61_8D27_C4E19A6B0F85
@@ -24,8 +24,13 @@
 // - none
 
 // Standard includes
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace sensics {
@@ -73,16 +78,19 @@ namespace subdiv2d {
         explicit SubdivContainerBase(Rect bounds);
 
       protected:
-        VertexStatus categorizeVertex(VertexId id);
-        VertexValueId getValueId(VertexId id);
+        // Leaves the subdivision empty, for loadSnapshot() to fill.
+        SubdivContainerBase() = default;
+
+        VertexStatus categorizeVertex(VertexId id) const;
+        VertexValueId getValueId(VertexId id) const;
         bool hasValue(VertexValueId valueId) const;
 
         using BaseVector = MaxSizeVector<ContainerVertexBase, MaxNeighborhoodSize>;
-        BaseVector locateNeighborhood(Point2f const& pt);
+        BaseVector locateNeighborhood(Point2f const& pt, LocateCursor* cursor) const;
 
         // Lookup a vertex by location. If it exists, a valid VertexValueId will be returned. (It may be that no value
         // is set for that id - that's a separate question/call)
-        VertexValueId lookup(Point2f const& pt);
+        VertexValueId lookup(Point2f const& pt, LocateCursor* cursor) const;
 
         static const std::size_t NoResizingNeededSentinel = 0;
 
@@ -90,13 +98,68 @@ namespace subdiv2d {
         // contains the size to resize your vector to, or 0 (NoResizingNeededSentinel) if no resize is needed.
         std::pair<VertexValueId, std::size_t> insert(Point2f const& pt);
 
+        // Remove a point from the subdivision. If it was a vertex, its (now unset) VertexValueId is returned, otherwise
+        // an invalid one.
+        VertexValueId erase(Point2f const& pt);
+
+        // Move a vertex, keeping its VertexValueId. Returns false if from is not a vertex.
+        bool move(Point2f const& from, Point2f const& to);
+
+        // Compact the subdivision (see Subdiv2D::compact()), moving which values are set to match. Returns the new ID
+        // of each vertex, by old ID, for moving the values themselves.
+        std::vector<VertexId> compact();
+
+        // See Subdiv2D::setGrowableBounds() and Subdiv2D::growBounds(), which keep the VertexValueIds.
+        void setGrowableBounds(bool growable);
+        bool hasGrowableBounds() const;
+        Rect getBounds() const;
+        void growBounds(Rect rect);
+
+        // The number of VertexValueIds, set or not: the size to keep the value vector at.
+        std::size_t numValues() const { return valuesSet_.size(); }
+
+        // Write the subdivision, which values are set, and the values (numValues of valueSize bytes each, one per
+        // VertexValueId) to a snapshot file.
+        void saveSnapshot(std::string const& path, void const* values, std::size_t valueSize,
+                          std::size_t numValues) const;
+
+        // Replace the contents with those of a snapshot file written by saveSnapshot(). Returns the values, which stay
+        // valid until the subdivision is next modified, and sets numValues. If journalSequence is not nullptr, it is
+        // set to the sequence number saved by a checkpoint.
+        void const* loadSnapshot(std::string const& path, std::size_t valueSize, std::size_t& numValues,
+                                 std::uint64_t* journalSequence = nullptr);
+
+        // Start journaling changes to a new journal, of values of valueSize bytes, numbered from sequence on, saving a
+        // checkpoint of the values given right away.
+        void startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                          std::size_t checkpointInterval, std::uint64_t sequence, void const* values,
+                          std::size_t valueSize, std::size_t numValues);
+        void stopJournal();
+        bool isJournaling() const;
+        // Save a checkpoint, as by saveSnapshot(), to the journal's snapshot file.
+        void checkpoint(void const* values, std::size_t valueSize, std::size_t numValues);
+        // Append a change to the journal: each returns true if a checkpoint is due.
+        bool journalInsert(Point2f const& pt, void const* value);
+        bool journalErase(Point2f const& pt);
+        bool journalMove(Point2f const& from, Point2f const& to);
+        bool journalCompact();
+        bool journalGrowBounds(Rect rect);
+        bool journalGrowableBounds(bool growable);
+        // Replay the changes in a journal from sequence on, moving points and growing the bounds directly and passing
+        // inserts, erases and compactions to the callbacks. Returns the sequence number after the last change.
+        std::uint64_t replayJournal(std::string const& journalPath, std::size_t valueSize, std::uint64_t sequence,
+                                    std::function<void(Point2f const&, void const*)> const& insertValue,
+                                    std::function<void(Point2f const&)> const& eraseValue,
+                                    std::function<void()> const& compactValues);
+
       private:
-        void populate(VertexId id, ContainerVertexBase& data);
+        void populate(VertexId id, ContainerVertexBase& data) const;
         /// returns the size the value vector should be resized to, or 0 if no resizing needed.
         std::size_t set(VertexValueId valueId);
         static const int NumDummyVertices = 4;
         Subdiv2D subdiv_;
         std::vector<bool> valuesSet_;
+        detail::JournalHandle journal_;
     };
 
     template <typename T> class SubdivContainer : public SubdivContainerBase {
@@ -109,27 +172,85 @@ namespace subdiv2d {
         explicit SubdivContainer(Rect bounds);
 
         /// Insert a new point into the subdivision, along with its associated value. If it is outside the bounds, a
-        /// runtime error is raised. If it is an already-existing point, the value will be replaced.
+        /// runtime error is raised, unless they are growable. If it is an already-existing point, the value will be
+        /// replaced.
         void insert(Point2f const& pt, value_type const& val);
 
+        /// Remove a point, and its associated value, from the subdivision. Returns true if it was a vertex, false
+        /// otherwise (not found/out of bounds/etc).
+        bool erase(Point2f const& pt);
+
+        /// Move a point to a new position, carrying its associated value along. Returns true if from was a vertex,
+        /// false otherwise. If to is outside the bounds (and they are not growable) or already a vertex, a runtime
+        /// error is raised.
+        bool move(Point2f const& from, Point2f const& to);
+
+        /// Renumber the vertices densely and in spatial order, dropping the slots left by erased points, and move the
+        /// values to match: see Subdiv2D::compact(). Worth doing after many erasures, or to speed up lookups after
+        /// inserting in arbitrary order.
+        void compact();
+
+        /// Set whether inserting (or moving to) a point outside the bounds grows them, rather than raising a runtime
+        /// error: see Subdiv2D::setGrowableBounds(). Off by default.
+        void setGrowableBounds(bool growable);
+
+        /// Whether the bounds grow to take points outside them.
+        bool hasGrowableBounds() const { return Base::hasGrowableBounds(); }
+
+        /// The bounds given at construction, as grown since.
+        Rect getBounds() const { return Base::getBounds(); }
+
+        /// Grow the bounds to include rect, without rebuilding: see Subdiv2D::growBounds().
+        void growBounds(Rect rect);
+
+        /// Write the subdivision and values to a binary snapshot file: see Subdiv2D::save(). Only for trivially
+        /// copyable value types.
+        void save(std::string const& path) const;
+
+        /// Read a container from a snapshot file written by save(). The subdivision is mapped rather than read, as by
+        /// Subdiv2D::load(), while the values are copied out.
+        static SubdivContainer load(std::string const& path);
+
+        /// Start recording every change (insert, erase and move, with values) in a journal file, with periodic
+        /// checkpoints to a snapshot file: see Subdiv2D::startJournal(). Only for trivially copyable value types.
+        void startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                          std::size_t checkpointInterval = 4096);
+
+        /// Save a checkpoint now: see Subdiv2D::checkpoint().
+        void checkpoint();
+
+        /// Stop journaling changes, leaving the files as they are.
+        void stopJournal() { Base::stopJournal(); }
+
+        /// Whether changes are being journaled.
+        bool isJournaling() const { return Base::isJournaling(); }
+
+        /// Rebuild a journaled container from its last checkpoint and the changes journaled since, then resume
+        /// journaling to the same files: see Subdiv2D::recover().
+        static SubdivContainer recover(std::string const& snapshotPath, std::string const& journalPath,
+                                       std::size_t checkpointInterval = 4096);
+
+        // The lookup methods are const and take an optional LocateCursor (see Subdiv2D::locate()), so that many
+        // threads may query one container concurrently, each with its own cursor.
+
         /// Returns true if the given point is a vertex in the subdivision and outVal has been set. Returns false in all
         /// other cases.
-        bool lookup(Point2f const& pt, value_type& outVal);
+        bool lookup(Point2f const& pt, value_type& outVal, LocateCursor* cursor = nullptr) const;
 
         /// Returns true if the given point is a vertex in the subdivision. Iff outPtr is not nullptr and it will return
         /// true, outPtr is assigned the associated value.  Returns false in all other cases (point not found/out of
         /// bounds/etc).
-        bool lookup(Point2f const& pt, pointer_type outPtr = nullptr);
+        bool lookup(Point2f const& pt, pointer_type outPtr = nullptr, LocateCursor* cursor = nullptr) const;
 
         /// Gets the value associated with a point. If no value is associated with the given point, throws a runtime
         /// error.
-        value_type get(Point2f const& pt);
+        value_type get(Point2f const& pt, LocateCursor* cursor = nullptr) const;
 
         /// If the point is a vertex in the subdivision, return just the point and its value in outVertices.
         /// If the point is on an edge, return the vertices and values at either end of the edge.
         /// If the point is in some facet, return the three vertices and values of that facet.
         /// Otherwise (out of bounds, etc), return an empty container.
-        ContainerVertices<value_type> findNeighborhood(Point2f const& pt);
+        ContainerVertices<value_type> findNeighborhood(Point2f const& pt, LocateCursor* cursor = nullptr) const;
 
         ContainerVertices<value_type> findNeighborsAndWeightsForInterpolation(Point2f const& pt);
 #if 0
@@ -140,11 +261,12 @@ namespace subdiv2d {
         bool findNearest(Point2f const& pt, Vertices& outVertices);
 #endif
       private:
+        SubdivContainer() = default;
         using Base = SubdivContainerBase;
-        bool get_(VertexValueId valueId, value_type& outVal);
-        bool get_(VertexValueId valueId, pointer_type outPtr = nullptr);
-        bool get_(VertexId vertexId, value_type& outVal);
-        bool get_(VertexId vertexId, pointer_type outPtr = nullptr);
+        bool get_(VertexValueId valueId, value_type& outVal) const;
+        bool get_(VertexValueId valueId, pointer_type outPtr = nullptr) const;
+        bool get_(VertexId vertexId, value_type& outVal) const;
+        bool get_(VertexId vertexId, pointer_type outPtr = nullptr) const;
 #if 0
         bool setFromVertex_(Point2f const& pt, VertexId vertexId, Vertices& outVertices);
         bool setFromEdge_(EdgeId edgeId, Vertices& outVertices);
@@ -165,26 +287,134 @@ namespace subdiv2d {
             associatedValues_.resize(newSize);
         }
         associatedValues_[valueId.get()] = val;
+        if (isJournaling() && Base::journalInsert(pt, &val)) {
+            checkpoint();
+        }
     }
-    template <typename T> inline bool SubdivContainer<T>::lookup(Point2f const& pt, value_type& outVal) {
-        return lookup(pt, &outVal);
+    template <typename T> inline bool SubdivContainer<T>::erase(Point2f const& pt) {
+        auto valueId = Base::erase(pt);
+        if (!valueId) {
+            return false;
+        }
+        if (valueId.get() < associatedValues_.size()) {
+            // Don't keep whatever the value holds alive until the slot is reused.
+            associatedValues_[valueId.get()] = value_type();
+        }
+        if (isJournaling() && Base::journalErase(pt)) {
+            checkpoint();
+        }
+        return true;
+    }
+    template <typename T> inline bool SubdivContainer<T>::move(Point2f const& from, Point2f const& to) {
+        if (!Base::move(from, to)) {
+            return false;
+        }
+        if (isJournaling() && Base::journalMove(from, to)) {
+            checkpoint();
+        }
+        return true;
+    }
+
+    template <typename T> inline void SubdivContainer<T>::compact() {
+        const auto vertexMap = Base::compact();
+        std::vector<value_type> values(Base::numValues());
+        for (std::size_t i = 0; i < vertexMap.size(); ++i) {
+            auto from = getValueId(VertexId(static_cast<int>(i)));
+            auto to = getValueId(vertexMap[i]);
+            if (from && to && from.get() < associatedValues_.size()) {
+                values[to.get()] = std::move(associatedValues_[from.get()]);
+            }
+        }
+        associatedValues_.swap(values);
+        if (isJournaling() && Base::journalCompact()) {
+            checkpoint();
+        }
+    }
+
+    template <typename T> inline void SubdivContainer<T>::setGrowableBounds(bool growable) {
+        Base::setGrowableBounds(growable);
+        if (isJournaling() && Base::journalGrowableBounds(growable)) {
+            checkpoint();
+        }
+    }
+
+    template <typename T> inline void SubdivContainer<T>::growBounds(Rect rect) {
+        Base::growBounds(rect);
+        if (isJournaling() && Base::journalGrowBounds(rect)) {
+            checkpoint();
+        }
+    }
+
+    template <typename T> inline void SubdivContainer<T>::save(std::string const& path) const {
+        static_assert(std::is_trivially_copyable<value_type>::value, "Values are saved as raw bytes");
+        Base::saveSnapshot(path, associatedValues_.data(), sizeof(value_type), associatedValues_.size());
+    }
+    template <typename T> inline SubdivContainer<T> SubdivContainer<T>::load(std::string const& path) {
+        static_assert(std::is_trivially_copyable<value_type>::value, "Values are loaded as raw bytes");
+        SubdivContainer ret;
+        std::size_t numValues = 0;
+        auto values = static_cast<value_type const*>(ret.loadSnapshot(path, sizeof(value_type), numValues));
+        ret.associatedValues_.assign(values, values + numValues);
+        return ret;
+    }
+    template <typename T>
+    inline void SubdivContainer<T>::startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                                                 std::size_t checkpointInterval) {
+        static_assert(std::is_trivially_copyable<value_type>::value, "Values are journaled as raw bytes");
+        Base::startJournal(snapshotPath, journalPath, checkpointInterval, 0, associatedValues_.data(),
+                           sizeof(value_type), associatedValues_.size());
+    }
+    template <typename T> inline void SubdivContainer<T>::checkpoint() {
+        Base::checkpoint(associatedValues_.data(), sizeof(value_type), associatedValues_.size());
+    }
+    template <typename T>
+    inline SubdivContainer<T> SubdivContainer<T>::recover(std::string const& snapshotPath,
+                                                          std::string const& journalPath,
+                                                          std::size_t checkpointInterval) {
+        static_assert(std::is_trivially_copyable<value_type>::value, "Values are journaled as raw bytes");
+        SubdivContainer ret;
+        std::size_t numValues = 0;
+        std::uint64_t sequence = 0;
+        auto values =
+            static_cast<value_type const*>(ret.loadSnapshot(snapshotPath, sizeof(value_type), numValues, &sequence));
+        ret.associatedValues_.assign(values, values + numValues);
+        sequence = ret.replayJournal(
+            journalPath, sizeof(value_type), sequence,
+            [&](Point2f const& pt, void const* value) {
+                value_type val;
+                std::memcpy(&val, value, sizeof(val));
+                ret.insert(pt, val);
+            },
+            [&](Point2f const& pt) { ret.erase(pt); }, [&] { ret.compact(); });
+        ret.Base::startJournal(snapshotPath, journalPath, checkpointInterval, sequence, ret.associatedValues_.data(),
+                               sizeof(value_type), ret.associatedValues_.size());
+        return ret;
+    }
+
+    template <typename T>
+    inline bool SubdivContainer<T>::lookup(Point2f const& pt, value_type& outVal, LocateCursor* cursor) const {
+        return lookup(pt, &outVal, cursor);
     }
-    template <typename T> inline bool SubdivContainer<T>::lookup(Point2f const& pt, pointer_type outPtr) {
-        auto valueId = Base::lookup(pt);
+    template <typename T>
+    inline bool SubdivContainer<T>::lookup(Point2f const& pt, pointer_type outPtr, LocateCursor* cursor) const {
+        auto valueId = Base::lookup(pt, cursor);
         if (valueId && hasValue(valueId)) {
             return get_(valueId, outPtr);
         }
         return false;
     }
-    template <typename T> inline typename SubdivContainer<T>::value_type SubdivContainer<T>::get(Point2f const& pt) {
+    template <typename T>
+    inline typename SubdivContainer<T>::value_type SubdivContainer<T>::get(Point2f const& pt,
+                                                                           LocateCursor* cursor) const {
         value_type ret;
-        if (!lookup(pt, ret)) {
+        if (!lookup(pt, ret, cursor)) {
             throw std::runtime_error("Vertex not found with a value in subdivision");
         }
         return ret;
     }
-    template <typename T> inline ContainerVertices<T> SubdivContainer<T>::findNeighborhood(Point2f const& pt) {
-        auto baseNeighborhood = Base::locateNeighborhood(pt);
+    template <typename T>
+    inline ContainerVertices<T> SubdivContainer<T>::findNeighborhood(Point2f const& pt, LocateCursor* cursor) const {
+        auto baseNeighborhood = Base::locateNeighborhood(pt, cursor);
         Vertices ret;
         for (auto& baseData : baseNeighborhood) {
             ret.push_back(baseData);
@@ -195,10 +425,10 @@ namespace subdiv2d {
         return ret;
     }
 
-    template <typename T> inline bool SubdivContainer<T>::get_(VertexValueId valueId, value_type& outVal) {
+    template <typename T> inline bool SubdivContainer<T>::get_(VertexValueId valueId, value_type& outVal) const {
         return get_(valueId, &outVal);
     }
-    template <typename T> inline bool SubdivContainer<T>::get_(VertexValueId valueId, pointer_type outPtr) {
+    template <typename T> inline bool SubdivContainer<T>::get_(VertexValueId valueId, pointer_type outPtr) const {
         if (!hasValue(valueId)) {
             return false;
         }
@@ -207,10 +437,10 @@ namespace subdiv2d {
         }
         return true;
     }
-    template <typename T> inline bool SubdivContainer<T>::get_(VertexId vertexId, value_type& outVal) {
+    template <typename T> inline bool SubdivContainer<T>::get_(VertexId vertexId, value_type& outVal) const {
         return get_(getValueId(vertexId), &outVal);
     }
-    template <typename T> inline bool SubdivContainer<T>::get_(VertexId vertexId, pointer_type outPtr) {
+    template <typename T> inline bool SubdivContainer<T>::get_(VertexId vertexId, pointer_type outPtr) const {
         return get_(getValueId(vertexId), outPtr);
     }
 } // namespace subdiv2d
@@ -60,14 +60,22 @@
 
 // Internal Includes
 #include "IdTypes.h"
+#include "MappableArray.h"
+#include "MemoryResource.h"
 #include "Types.h"
 
 // Library/third-party includes
 // - none
 
 // Standard includes
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -113,8 +121,136 @@ namespace subdiv2d {
             VertexArray vertices = {{InvalidVertex, InvalidVertex, InvalidVertex}};
         };
 
-        class EdgeIterationHelper;
+        class FaceIterationHelper;
+        class DelaunayBuilder;
+        class SubdivTestAccess;
+        class SnapshotWriter;
+        class SnapshotReader;
+        class Journal;
+        struct JournalRecord;
+        enum class JournalOp : std::uint32_t;
+
+        /** Owns the journal of a subdivision or container, if it has one. Only one object may write to a journal, so
+        copies (and objects assigned a copy, whose contents no longer match their journal) have none. */
+        class JournalHandle {
+          public:
+            JournalHandle();
+            JournalHandle(JournalHandle const&);
+            JournalHandle(JournalHandle&& other);
+            JournalHandle& operator=(JournalHandle const&);
+            JournalHandle& operator=(JournalHandle&& other);
+            ~JournalHandle();
+
+            explicit operator bool() const { return static_cast<bool>(journal_); }
+            Journal* operator->() const { return journal_.get(); }
+            void reset(Journal* journal = nullptr);
+
+          private:
+            std::unique_ptr<Journal> journal_;
+        };
     } // namespace detail
+    class SubdivContainerBase;
+
+    /** @brief Caller-owned starting point for point location walks.
+
+    Each walk starts from the edge where the previous walk with the same cursor ended, so a series of nearby queries
+    takes short walks. Since the cursor, rather than the subdivision, holds this state, the query methods taking one
+    are const: any number of threads may query a shared Subdiv2D concurrently, each with its own cursor, as long as
+    none is modifying it.
+
+    A cursor may be kept across modifications of the subdivision: if its edge has since been deleted, the next walk
+    starts from the subdivision's default instead.
+    */
+    class LocateCursor {
+      public:
+        /** @brief Forgets the starting point, so the next walk starts from the subdivision's default. */
+        void reset() { edge_ = InvalidEdge; }
+
+      private:
+        friend class Subdiv2D;
+        EdgeId edge_ = InvalidEdge;
+    };
+
+    /** @brief Caller-owned working storage for Subdiv2D::findKNearest() and Subdiv2D::findWithinRadius().
+
+    Both search outward from the nearest vertex, keeping a heap of candidates and a set of the vertices already seen.
+    Passing the same one to each query reuses that storage, so that once it has grown to fit, queries allocate nothing.
+    As with LocateCursor, each thread querying concurrently needs its own.
+    */
+    class NeighborSearchScratch {
+      private:
+        friend class Subdiv2D;
+        struct Candidate {
+            double dist;
+            VertexId vertex;
+        };
+        /// Empties the heap and the set of seen vertices.
+        void reset();
+        /// Adds a vertex to the set of seen vertices: returns false if it was already there.
+        bool markSeen(VertexId vertex);
+        void growSeen();
+
+        std::vector<Candidate> heap_;
+        /// Open-addressed hash set of vertex IDs (Invalid for an empty slot): a power of two in size.
+        std::vector<VertexId> seen_;
+        /// The slots of seen_ in use, so that reset() need not clear all of them.
+        std::vector<std::size_t> seenSlots_;
+    };
+
+    /** @brief The triangulation as an indexed mesh: each vertex position stored once, and three indices into it per
+    triangle, as filled in by Subdiv2D::getIndexedMesh().
+
+    Passing the same one to each export reuses its arrays, so that once they have grown to fit, an export allocates
+    nothing. Reserve them beforehand to avoid even the first allocations.
+    */
+    class IndexedMesh {
+      public:
+        /// Vertex positions, in increasing order of vertex ID.
+        std::vector<Point2f> vertices;
+        /// The vertex ID of each entry of vertices, for attaching per-vertex values.
+        std::vector<VertexId> vertexIds;
+        /// Indices into vertices, three per triangle, counterclockwise (as getTriangleList() gives them).
+        std::vector<std::uint32_t> indices;
+
+        /// Number of triangles in indices.
+        std::size_t numTriangles() const { return indices.size() / 3; }
+
+      private:
+        friend class Subdiv2D;
+        /// Index into vertices of each vertex ID, or the maximum value if not exported.
+        std::vector<std::uint32_t> remap_;
+    };
+
+    /** @brief Elements to leave out of the ranges from Subdiv2D::vertices(), Subdiv2D::edges() and
+    Subdiv2D::triangles(), combined with |.
+
+    Free slots, the placeholder vertex and the outside of the bounding triangle are always left out. */
+    enum class ElementFilter : unsigned {
+        None = 0,
+        /// Virtual (Voronoi) vertices. No edges or triangles are virtual.
+        SkipVirtual = 1,
+        /// The three outer bounding vertices, and the edges and triangles touching them.
+        SkipBoundary = 2
+    };
+
+    inline ElementFilter operator|(ElementFilter a, ElementFilter b) {
+        return static_cast<ElementFilter>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+    }
+
+    /** @brief Does filters include filter? */
+    inline bool hasFilter(ElementFilter filters, ElementFilter filter) {
+        return (static_cast<unsigned>(filters) & static_cast<unsigned>(filter)) != 0;
+    }
+
+    /** @brief Whether a subdivision keeps storage for the Voronoi diagram (the dual of the triangulation). */
+    enum class SubdivMode {
+        /// calcVoronoi() is available.
+        DelaunayAndVoronoi,
+        /// No dual storage: each quad-edge takes 24 bytes rather than 32, and no virtual Voronoi vertices are ever
+        /// added. calcVoronoi() raises a runtime error, getVoronoiFacetList() computes each facet on the fly (see
+        /// getVoronoiFacet()).
+        DelaunayOnly
+    };
 
     /**
     The Subdiv2D class described in this section is used to perform various planar subdivision on
@@ -153,20 +289,162 @@ namespace subdiv2d {
         /** @overload
 
         @param rect Rectangle that includes all of the 2D points that are to be added to the subdivision.
+        @param mode Whether to keep storage for the Voronoi diagram.
+        @param resource Where the vertex and edge arrays get their memory: nullptr for the default, operator new. It
+        must outlive this subdivision and any copies of it.
 
         The function creates an empty Delaunay subdivision where 2D points can be added using the function
         insert() . All of the points to be added must be within the specified rectangle, otherwise a runtime
         error is raised.
          */
-        Subdiv2D(Rect rect);
+        Subdiv2D(Rect rect, SubdivMode mode = SubdivMode::DelaunayAndVoronoi, MemoryResource* resource = nullptr);
+
+        /** @brief Builds a Delaunay subdivision of a whole set of points at once.
+
+        @param rect Rectangle that includes all of the 2D points: as passed to initDelaunay().
+        @param ptvec Points to triangulate.
+        @param outIds Optional output: the ID of each point, in the same order as ptvec.
+        @param mode Whether to keep storage for the Voronoi diagram.
+        @param resource Where the vertex and edge arrays get their memory, as for the constructor.
+
+        Uses the Guibas-Stolfi divide-and-conquer algorithm, taking O(n log n) time regardless of the order of the
+        input. The result is in the same state as if initDelaunay(rect) and insert() had been called: the same bounding
+        vertices (IDs 1-3) and triangulation (up to the choice of diagonal among cocircular points), so insert() and
+        locate() may be used on it afterward. Unique points are assigned IDs in a spatially-coherent order rather than
+        input order: use outIds to map points to their IDs.
+
+        @note Only exactly-equal points are merged, unlike insert() which treats points within EPSILON() as
+        coincident. If any point is outside of rect a runtime error is raised.
+         */
+        static Subdiv2D buildDelaunay(Rect rect, std::vector<Point2f> const& ptvec,
+                                      std::vector<VertexId>* outIds = nullptr,
+                                      SubdivMode mode = SubdivMode::DelaunayAndVoronoi,
+                                      MemoryResource* resource = nullptr);
+
+        /** @brief Builds a Delaunay subdivision of a whole set of points at once, using multiple threads.
+
+        @param numThreads Maximum number of threads to use (including the calling thread), or 0 for the hardware
+        concurrency.
+
+        As buildDelaunay() above: the points are partitioned into cells of the rect, which are triangulated
+        concurrently and then merged along their seams. The result (including the IDs assigned) is identical to that
+        of the single-threaded build, whatever the number of threads.
+         */
+        static Subdiv2D buildDelaunay(Rect rect, std::vector<Point2f> const& ptvec, unsigned int numThreads,
+                                      std::vector<VertexId>* outIds = nullptr,
+                                      SubdivMode mode = SubdivMode::DelaunayAndVoronoi,
+                                      MemoryResource* resource = nullptr);
+
+        /** @brief Writes the subdivision to a binary snapshot file, for load() to read back.
+
+        The file holds the vertex and edge arrays as they are in memory (along with the free lists and bounds), in a
+        versioned layout tagged with the byte order of this machine, so it can only be loaded by a build with the same
+        layout on a machine with the same byte order. The face table is not saved: call calcFaces() after loading, if
+        needed. The file is written under a temporary name, then renamed over path, so a subdivision loaded from path
+        may be saved back to it. Raises a runtime error if the file cannot be written.
+         */
+        void save(std::string const& path) const;
+
+        /** @brief Reads a subdivision from a snapshot file written by save().
+
+        @param resource Where the vertex and edge arrays get their memory if they have to grow, as for the constructor.
+
+        Where supported (Linux, for now), the file is mapped into memory rather than read: queries are answered
+        straight from the mapped pages, so loading takes time independent of the size of the subdivision, and pages are
+        only read from disk as they are touched. The mapping is private, so changes to the subdivision never reach the
+        file, and it is released along with the subdivision (and any copies, which have arrays of their own). Raises a
+        runtime error if the file is not a snapshot compatible with this build.
+         */
+        static Subdiv2D load(std::string const& path, MemoryResource* resource = nullptr);
+
+        /** @brief Starts recording every change to this subdivision in a journal file, with periodic checkpoints to a
+        snapshot file, so that recover() can rebuild it if the process stops.
+
+        @param snapshotPath Where checkpoints are saved, as by save().
+        @param journalPath Where changes since the last checkpoint are appended.
+        @param checkpointInterval Number of changes between checkpoints: 0 for only when checkpoint() is called.
+
+        Each change (insert(), remove(), move(), compact(), initDelaunay(), and computing the Voronoi diagram) appends
+        a small fixed-size record, flushed to the operating system before the call returns. A checkpoint is saved right
+        away, replacing any existing files. Copies of the subdivision do not journal their changes. Raises a runtime
+        error if the files cannot be written.
+         */
+        void startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                          std::size_t checkpointInterval = 4096);
+
+        /** @brief Saves a checkpoint now: the snapshot file is replaced with the current state, and the journal
+         * emptied. */
+        void checkpoint();
+
+        /** @brief Stops journaling changes, leaving the files as they are. */
+        void stopJournal();
+
+        /** @brief Returns whether changes are being journaled. */
+        bool isJournaling() const;
+
+        /** @brief Rebuilds a journaled subdivision: loads the last checkpoint, as by load(), and replays the changes
+        journaled since, then resumes journaling to the same files.
+
+        Replaying gives the same vertex IDs as the original, so they may be kept by the caller. A change being written
+        when the process stopped is dropped. Raises a runtime error if the files are not a snapshot and journal.
+         */
+        static Subdiv2D recover(std::string const& snapshotPath, std::string const& journalPath,
+                                std::size_t checkpointInterval = 4096, MemoryResource* resource = nullptr);
 
         /** @brief Creates a new empty Delaunay subdivision
 
         @param rect Rectangle that includes all of the 2D points that are to be added to the subdivision.
 
+        The mode is kept from construction, as is whether the bounds are growable.
          */
         void initDelaunay(Rect rect);
 
+        /** @brief Returns the bounds: the rect given to initDelaunay(), as grown since. */
+        Rect getBounds() const;
+
+        /** @brief Grows the bounds to include rect, in place of rebuilding the subdivision with the larger rect.
+
+        The bounding vertices move out to where initDelaunay() would put them for the grown bounds, and edges are
+        flipped until the triangulation is Delaunay again: it is then the one inserting the same points after that
+        initDelaunay() would give (up to the choice among cocircular points). Only the triangles next to the bounding
+        vertices change shape, so this takes time in proportion to the vertices near the hull, and the flips they lead
+        to, rather than to the whole subdivision.
+
+        Each bounding vertex moves in steps that keep every triangle around it counterclockwise. Should those stall
+        (which takes a hull with edges lined up on a bounding vertex), the triangulation is rebuilt instead, keeping
+        the vertex IDs, in O(n log n) time. Either way the Voronoi diagram and face table, if computed, are kept up to
+        date, though face IDs change after a rebuild.
+
+        @note Coordinates are limited to +/- 2^24, within which the bounds stay exact as floats.
+         */
+        void growBounds(Rect rect);
+
+        /** @brief Sets whether inserting (or moving a vertex to) a point outside the bounds grows them, rather than
+        raising a runtime error. Off by default.
+
+        The bounds grow as by growBounds(), by at least half their size past each side the point is beyond, so that
+        points walking steadily outward grow them only a logarithmic number of times. Journaled, and kept by save().
+         */
+        void setGrowableBounds(bool growable);
+
+        /** @brief Returns whether the bounds grow to take points outside them: see setGrowableBounds(). */
+        bool hasGrowableBounds() const;
+
+        /** @brief Returns whether this subdivision keeps storage for the Voronoi diagram. */
+        SubdivMode getMode() const;
+
+        /** @brief Returns where the vertex and edge arrays get their memory. */
+        MemoryResource* getMemoryResource() const;
+
+        /** @brief Sets aside room for a number of points, so that inserting that many (in total, including any
+        already inserted) does not reallocate the vertex and edge arrays.
+
+        A triangulation of n points (plus the three bounding vertices) has 3n + 3 edges, so this reserves n + 4
+        vertices and 3n + 10 quad-edges, counting the placeholders and the slack buildDelaunay() sets aside. The
+        Voronoi vertices added by calcVoronoi() are not included.
+         */
+        void reserve(std::size_t numPoints);
+
         /** @brief Insert a single point into a Delaunay triangulation.
 
         @param pt Point to insert.
@@ -175,7 +453,8 @@ namespace subdiv2d {
         appropriately. If a point with the same coordinates exists already, no new point is added.
         @returns the ID of the point.
 
-        @note If the point is outside of the triangulation specified rect a runtime error is raised.
+        @note If the point is outside of the triangulation specified rect a runtime error is raised, unless the bounds
+        are growable: see setGrowableBounds().
          */
         VertexId insert(Point2f pt);
 
@@ -184,9 +463,55 @@ namespace subdiv2d {
         @param ptvec Points to insert.
 
         The function inserts a vector of points into a subdivision and modifies the subdivision topology
-        appropriately.
+        appropriately. The points are inserted in a spatially-coherent order (randomized rounds, each sorted along a
+        Hilbert curve) rather than the order given, which keeps the point location walk for each insertion short.
+
+        @returns the ID of each point, in the same order as ptvec.
+
+        @note If any point is outside of the triangulation specified rect a runtime error is raised, and only some of
+        the points will have been inserted. If the bounds are growable, they instead grow once, to take all of the
+        points, before any are inserted.
+         */
+        std::vector<VertexId> insert(const std::vector<Point2f>& ptvec);
+
+        /** @brief Removes a single vertex from the current triangulation.
+
+        @param vertex The vertex to remove: one inserted, not one of the bounding vertices or a Voronoi vertex,
+        otherwise a runtime error is raised.
+
+        The triangles around the vertex are deleted, and the hole they leave is re-triangulated, in O(d log d) time
+        for a vertex with d edges. Its ID, and the quad-edges, are reused by later insertions. The Voronoi diagram, if
+        computed, is kept up to date; the face table is invalidated.
+         */
+        void remove(VertexId vertex);
+
+        /** @brief Moves a single vertex of the current triangulation, keeping its ID.
+
+        @param vertex The vertex to move: one inserted, as for remove().
+        @param pt Its new position. If it is outside of the rect (and the bounds are not growable), or already a
+        vertex, a runtime error is raised.
+
+        While the vertex stays within the kernel of the polygon around it (as it does for small moves), only the
+        position changes, and edges are flipped nearby until the triangulation is Delaunay again. Otherwise, the vertex
+        is removed and re-inserted. The Voronoi diagram and face table, if computed, are kept up to date in the first
+        case; the face table is invalidated in the second.
+         */
+        void move(VertexId vertex, Point2f pt);
+
+        /** @brief Renumbers the vertices and quad-edges densely, in order along a Hilbert curve, dropping free slots.
+
+        Removal (and recomputing the Voronoi diagram) leaves free slots in the vertex and edge arrays, and insertion in
+        arbitrary order scatters neighboring vertices across them: this restores the layout buildDelaunay() gives, so
+        that walks touch little memory. The inserted vertices get IDs from 4 up, in order along the curve, and each
+        quad-edge is numbered after the first vertex (in that order) it touches. The bounding vertices keep their IDs.
+
+        Takes O(n log n) time, and needs room for a second copy of the arrays while it runs. The Voronoi diagram and
+        face table, if computed, are recomputed (so face IDs change). A LocateCursor kept across this still works, but
+        starts its next walk from an arbitrary place.
+
+        @returns the new ID of each vertex, indexed by its old ID: InvalidVertex for free slots and Voronoi vertices.
          */
-        void insert(const std::vector<Point2f>& ptvec);
+        std::vector<VertexId> compact();
 
         /** @brief Returns the location of a point within a Delaunay triangulation.
 
@@ -207,25 +532,139 @@ namespace subdiv2d {
            and no pointers are filled.
         -  One of input arguments is invalid. A runtime error is raised or, if silent or "parent" error
            processing mode is selected, CV_PTLOC_ERROR is returned.
+
+        @param cursor Optional starting point for the walk, updated to where it ended. Without one, the walk starts
+        near the most recently inserted point.
          */
-        PtLoc locate(Point2f pt, EdgeId& edge, VertexId& vertex);
+        PtLoc locate(Point2f pt, EdgeId& edge, VertexId& vertex, LocateCursor* cursor = nullptr) const;
 
         /** @overload */
-        std::tuple<PtLoc, EdgeId, VertexId> locate(Point2f pt);
+        std::tuple<PtLoc, EdgeId, VertexId> locate(Point2f pt, LocateCursor* cursor = nullptr) const;
+
+        /** @overload
+
+        @param face Output face containing the point: for a point on an edge, one of the two faces sharing it, and for
+        a point on a vertex, one of the faces around it.
+
+        The face table must be up to date (see calcFaces()), otherwise a runtime error is raised.
+         */
+        PtLoc locate(Point2f pt, EdgeId& edge, VertexId& vertex, FaceId& face, LocateCursor* cursor = nullptr) const;
+
+        /** @brief Locates many points at once.
+
+        @param pts Points to locate.
+        @param n Number of points.
+        @param outLocs Optional output array of n locations, as returned by locate().
+        @param outEdges Optional output array of n edges, as from locate().
+        @param outVertices Optional output array of n vertex sets, as from locateVertexIdsArray().
+        @param cursor Optional starting point for the walks, as for locate().
+
+        The queries are executed in order along a Hilbert curve, so each walk starts next to where the last one ended,
+        and the results are written at the index of the corresponding input point. This makes large batches of
+        incoherent queries much cheaper than calling locate() for each. Unlike locate(), points outside of the
+        bounding rect do not raise an error: their location is PTLOC_OUTSIDE_RECT, with invalid edge and vertices.
+         */
+        void locateBatch(Point2f const* pts, std::size_t n, PtLoc* outLocs, EdgeId* outEdges = nullptr,
+                         VertexArray* outVertices = nullptr, LocateCursor* cursor = nullptr) const;
 
         /** @brief Finds the subdivision vertex closest to the given point.
 
         @param pt Input point.
         @param nearestPt Output subdivision vertex point.
+        @param cursor Optional cursor, as for locate().
 
         The function is another function that locates the input point within the subdivision. It finds the
         subdivision vertex that is the closest to the input point. It is not necessarily one of vertices
         of the facet containing the input point, though the facet (located using locate() ) is used as a
-        starting point.
+        starting point: from its nearest vertex, this repeatedly moves to any neighbor closer to the input point. (In a
+        Delaunay triangulation, a vertex with no closer neighbor is the closest of all.) The Voronoi diagram is not
+        needed.
 
         @returns vertex ID.
          */
-        VertexId findNearest(Point2f pt, Point2f* nearestPt = nullptr);
+        VertexId findNearest(Point2f pt, Point2f* nearestPt = nullptr, LocateCursor* cursor = nullptr) const;
+
+        /** @brief Finds the nearest vertex to each of many points.
+
+        @param pts Points to find the nearest vertices of.
+        @param n Number of points.
+        @param outVertices Output array of n vertex IDs, as from findNearest().
+        @param cursor Optional starting point for the walks, as for locate().
+
+        Allocates nothing. The queries are answered in blocks of a thousand or so, each in order along a Hilbert curve
+        so that every walk starts near where the last one ended, and the results are written at the index of the
+        corresponding input point. Unlike findNearest(), points outside of the bounding rect do not raise an error:
+        their nearest vertex is InvalidVertex.
+         */
+        void findNearestBatch(Point2f const* pts, std::size_t n, VertexId* outVertices,
+                              LocateCursor* cursor = nullptr) const;
+
+        /** @brief Finds the k vertices closest to a point, nearest first.
+
+        @param pt Input point.
+        @param k Number of vertices wanted.
+        @param outVertices Output array of (at least) k vertex IDs.
+        @param scratch Optional working storage, reused across queries; without it, some is allocated for the query.
+        @param cursor Optional starting point for the walk, as for locate().
+        @returns the number of vertices written: k, unless the subdivision has fewer vertices than that.
+
+        Locates the nearest vertex as findNearest() does, then expands outward along Delaunay edges, best first: every
+        vertex within any circle around pt is connected to the nearest by a path of Delaunay edges that gets closer to
+        pt at every step, so the first k vertices reached this way are the k nearest. The bounding vertices are never
+        returned. If pt is outside of the bounding rect a runtime error is raised.
+         */
+        std::size_t findKNearest(Point2f pt, std::size_t k, VertexId* outVertices,
+                                 NeighborSearchScratch* scratch = nullptr, LocateCursor* cursor = nullptr) const;
+
+        /** @brief Finds all of the vertices within a distance of a point, nearest first.
+
+        @param pt Input point.
+        @param radius Distance: vertices exactly this far away are included.
+        @param outVertices Output vector: cleared, then filled, so its capacity is reused.
+        @param scratch Optional working storage, as for findKNearest().
+        @param cursor Optional starting point for the walk, as for locate().
+
+        Expands outward from the nearest vertex as findKNearest() does, never past the circle. If pt is outside of the
+        bounding rect a runtime error is raised.
+         */
+        void findWithinRadius(Point2f pt, float radius, std::vector<VertexId>& outVertices,
+                              NeighborSearchScratch* scratch = nullptr, LocateCursor* cursor = nullptr) const;
+
+        /** @brief Computes the Voronoi diagram (the dual of the triangulation), if it is not already up to date.
+
+        getVoronoiFacetList() calls this itself when it needs to. Once computed, insert() keeps it up to date,
+        recomputing just the Voronoi vertices of the triangles each insertion creates. Raises a runtime error in
+        SubdivMode::DelaunayOnly.
+         */
+        void calcVoronoi();
+
+        /** @brief Builds the face table, if it is not already up to date.
+
+        The table gives each triangle inside the bounding triangle (including those touching the bounding vertices) a
+        FaceId, dense from 0, with its vertices and neighbors, and maps each edge to the face on its left, all in
+        constant time. Once built, insert() patches it: the triangles an insertion replaces give their IDs to the new
+        ones, and the other triangles keep theirs, so face IDs can key per-triangle caches across insertions.
+         */
+        void calcFaces();
+
+        /** @brief Whether the face table is up to date, so the face accessors may be used. */
+        bool hasValidFaces() const { return validFaces; }
+
+        /** @brief Gets the number of faces in the face table. */
+        std::size_t getNumFaces() const;
+
+        /** @brief Gets the vertices of a face, counterclockwise, starting from the origin of getFaceEdge(). */
+        VertexArray const& getFaceVertices(FaceId face) const;
+
+        /** @brief Gets the faces sharing the edges of a face: entry i is across the edge from vertex i to vertex i + 1
+        (as given by getFaceVertices()), or InvalidFace if that edge is on the bounding triangle. */
+        std::array<FaceId, 3> const& getFaceNeighbors(FaceId face) const;
+
+        /** @brief Gets an edge of the face (the one out of its first vertex), with the face on its left. */
+        EdgeId getFaceEdge(FaceId face) const;
+
+        /** @brief Gets the face to the left of an edge: InvalidFace for the outside of the bounding triangle. */
+        FaceId getEdgeFace(EdgeId edge) const;
 
         /** @brief Gets the number of vertices, including virtual ones, dummy ones, and the placeholder. */
         std::size_t getNumVertices() const { return vtx.size(); }
@@ -260,16 +699,149 @@ namespace subdiv2d {
          */
         void getTriangleList(std::vector<Triangle>& triangleList) const;
 
+        /** @brief Exports the triangulation as a shared vertex array and a triangle index array.
+
+        @param mesh Output mesh: its previous contents are replaced.
+        @param includeBoundary Whether to include the three outer bounding vertices and the triangles touching them.
+        By default, only the triangles between inserted points are exported.
+
+        Free and virtual (Voronoi) vertices are left out, so the indices are not vertex IDs: see IndexedMesh::vertexIds.
+         */
+        void getIndexedMesh(IndexedMesh& mesh, bool includeBoundary = false) const;
+
+        /** @brief A vertex, as given by the range from vertices(). */
+        class VertexView {
+          public:
+            VertexId id;
+            Point2f const& position() const;
+
+          private:
+            friend class Subdiv2D;
+            Subdiv2D const* subdiv_;
+        };
+
+        /** @brief An edge, as given by the range from edges(): each undirected edge once. */
+        class EdgeView {
+          public:
+            EdgeId id;
+            VertexId org;
+            VertexId dst;
+            Edge positions() const;
+
+          private:
+            friend class Subdiv2D;
+            Subdiv2D const* subdiv_;
+        };
+
+        /** @brief A triangle, as given by the range from triangles(). */
+        class TriangleView {
+          public:
+            /// The triangle's lowest-numbered edge, with the triangle on its left.
+            EdgeId edge;
+            /// Counterclockwise, starting from the origin of edge.
+            VertexArray vertices;
+            Triangle positions() const;
+
+          private:
+            friend class Subdiv2D;
+            Subdiv2D const* subdiv_;
+        };
+
+        /** @brief Iterator over the elements of a subdivision, yielding View values computed as it goes.
+
+        Any number may traverse the same subdivision at once, but modifying the subdivision invalidates them all. */
+        template <typename View> class ElementIterator {
+          public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = View;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = View;
+
+            View operator*() const;
+            ElementIterator& operator++() {
+                do {
+                    i_ += step_;
+                } while (i_ < end_ && skip());
+                return *this;
+            }
+            ElementIterator operator++(int) {
+                auto ret = *this;
+                ++*this;
+                return ret;
+            }
+            bool operator==(ElementIterator const& other) const { return i_ == other.i_; }
+            bool operator!=(ElementIterator const& other) const { return i_ != other.i_; }
+
+          private:
+            friend class Subdiv2D;
+            ElementIterator(Subdiv2D const& subdiv, std::size_t i, std::size_t end, std::size_t step,
+                            ElementFilter filter)
+                : subdiv_(&subdiv), i_(i), end_(end), step_(step), filter_(filter) {
+                if (i_ < end_ && skip()) {
+                    ++*this;
+                }
+            }
+            bool skip() const;
+            Subdiv2D const* subdiv_;
+            std::size_t i_;
+            std::size_t end_;
+            std::size_t step_;
+            ElementFilter filter_;
+        };
+
+        /** @brief A pair of iterators, for range-based for. Holds no elements: they are found as it is traversed. */
+        template <typename Iterator> class ElementRange {
+          public:
+            ElementRange(Iterator first, Iterator last) : first_(first), last_(last) {}
+            Iterator begin() const { return first_; }
+            Iterator end() const { return last_; }
+
+          private:
+            Iterator first_;
+            Iterator last_;
+        };
+
+        using VertexRange = ElementRange<ElementIterator<VertexView> >;
+        using EdgeRange = ElementRange<ElementIterator<EdgeView> >;
+        using TriangleRange = ElementRange<ElementIterator<TriangleView> >;
+
+        /** @brief Returns a lazy range over the vertices, in increasing order of ID. Allocates nothing. */
+        VertexRange vertices(ElementFilter filter = ElementFilter::None) const;
+
+        /** @brief Returns a lazy range over the edges, each once, including those of the bounding triangle. Allocates
+         * nothing. */
+        EdgeRange edges(ElementFilter filter = ElementFilter::None) const;
+
+        /** @brief Returns a lazy range over the triangles inside the bounding triangle (as getTriangleList() gives
+        them, but with their IDs, and without the outside of the bounding triangle). Allocates nothing. */
+        TriangleRange triangles(ElementFilter filter = ElementFilter::None) const;
+
         /** @brief Returns a list of all Voroni facets.
 
         @param idx Vector of vertices IDs to consider. For all vertices you can pass empty vector.
         @param facetList Output vector of the Voroni facets.
         @param facetCenters Output vector of the Voroni facets center points.
 
+        For all vertices, this computes the Voronoi diagram (see calcVoronoi()) if it is not already up to date.
+        Otherwise, or in SubdivMode::DelaunayOnly, each facet is computed on its own, as by getVoronoiFacet(), and
+        the diagram is left as it was.
          */
         void getVoronoiFacetList(const std::vector<VertexId>& idx, std::vector<std::vector<Point2f> >& facetList,
                                  std::vector<Point2f>& facetCenters);
 
+        /** @brief Computes the Voronoi facet (cell) of a single vertex.
+
+        @param vertex ID of a vertex of the triangulation.
+        @param facet Output: the circumcenters of the triangles around the vertex, counterclockwise.
+
+        Takes time proportional to the degree of the vertex, and touches neither the stored Voronoi diagram nor any
+        other state, so it works in either SubdivMode and may be called from several threads at once. The points are
+        the same (to the bit, and in the same order) as getVoronoiFacetList() returns. A triangle whose circumcenter
+        is too far away to represent contributes Point2f(MAX_VAL(), MAX_VAL()).
+         */
+        void getVoronoiFacet(VertexId vertex, std::vector<Point2f>& facet) const;
+
         /** @brief Returns vertex location from vertex ID.
 
         @param vertex vertex ID.
@@ -343,11 +915,11 @@ namespace subdiv2d {
 
         /** @brief Returns the applicable vertex or vertices (non-invalid count will be 1 if on a vertex, 2 if on an
         edge, 3 if in a facet) for a given point */
-        VertexArray locateVertexIdsArray(Point2f const& pt);
+        VertexArray locateVertexIdsArray(Point2f const& pt, LocateCursor* cursor = nullptr) const;
 
         /** @brief Returns the applicable vertex or vertices (1 if on a vertex, 2 if on an edge, 3 if in a facet) for a
         given point */
-        std::vector<VertexId> locateVertexIds(Point2f const& pt);
+        std::vector<VertexId> locateVertexIds(Point2f const& pt, LocateCursor* cursor = nullptr) const;
 
         /** @brief Returns the applicable user-supplied vertex or vertices (non-invalid count will be 1 if on a vertex,
         2 if on an edge, 3 if in a facet) for a given point
@@ -355,15 +927,15 @@ namespace subdiv2d {
         Unlike ordinary locateVertexIds, this function will not return the special "bounding" vertices not supplied by
         the user, but will instead choose the nearest fully-user-supplied triangle.
         */
-        VertexArray locateVertexIdsForInterpolationArray(Point2f const& pt);
+        VertexArray locateVertexIdsForInterpolationArray(Point2f const& pt, LocateCursor* cursor = nullptr) const;
 
         /** @brief Returns the location of the applicable vertex or vertices (1 if on a vertex, 2 if on an edge, 3 if in
         a facet) for a given point */
-        void locateVertices(Point2f const& pt, std::vector<Point>& outVertices);
+        void locateVertices(Point2f const& pt, std::vector<Point>& outVertices, LocateCursor* cursor = nullptr) const;
 
         /** @brief Returns the location of the applicable vertex or vertices (1 if on a vertex, 2 if on an edge, 3 if in
         a facet) for a given point */
-        std::vector<Point> locateVertices(Point const& pt);
+        std::vector<Point> locateVertices(Point const& pt, LocateCursor* cursor = nullptr) const;
 
         static constexpr value_type MAX_VAL() { return std::numeric_limits<value_type>::max(); }
         static constexpr value_type EPSILON() { return std::numeric_limits<value_type>::epsilon(); }
@@ -374,6 +946,9 @@ namespace subdiv2d {
         /** @brief is a given vertex a non-user-supplied boundary vertex? */
         static bool isVertexBoundary(VertexId vertex);
 
+        /** @brief Checks the consistency of the quad-edge structure, raising an error if it is broken. */
+        void checkSubdiv() const;
+
       private:
         static const int Invalid = 0;
         EdgeId newEdge();
@@ -385,17 +960,100 @@ namespace subdiv2d {
         EdgeId connectEdges(EdgeId edgeA, EdgeId edgeB);
         void swapEdges(EdgeId edge);
         int isRightOf(Point2f pt, EdgeId edge) const;
-        void calcVoronoi();
         void clearVoronoi();
-        void checkSubdiv() const;
+        /** @brief calcVoronoi(), without the checks or journaling: adds the Voronoi vertices of every face lacking one.
+         */
+        void computeVoronoi();
+        /** @brief Computes the circumcenter of the face to the left of edge: Point2f(MAX_VAL(), MAX_VAL()) if it has
+         * none. */
+        Point2f faceCircumcenter(EdgeId edge) const;
+        /** @brief Adds the Voronoi vertex of the face to the left of edge, if it is finite. */
+        void calcVoronoiFace(EdgeId edge);
+        /** @brief Replaces the Voronoi vertices of the faces around a newly-inserted vertex. */
+        void updateVoronoiAround(VertexId vertex);
+        /** @brief Deletes the Voronoi vertices of the faces around a vertex, and clears the edges' references to them.
+         */
+        void clearVoronoiAround(VertexId vertex);
+        /** @brief Deletes the Voronoi vertex of the face left of edge, and clears the edges' references to it. */
+        void clearVoronoiFace(EdgeId edge);
+        /** @brief Is pt in the kernel of the polygon around vertex (the region from which it sees all of the edges
+        around it)? The outside of the bounding triangle is not part of the polygon. */
+        bool isInKernel(VertexId vertex, Point2f pt) const;
+        /** @brief Moves a vertex to a point in the kernel of the polygon around it, then flips edges until the
+        triangulation is Delaunay again, keeping the Voronoi diagram and face table up to date. */
+        void relocateInKernel(VertexId vertex, Point2f pt);
+        /** @brief Moves a bounding vertex to pt in steps, each by relocateInKernel(). Returns false, having gone part
+        way, if the steps stall. */
+        bool moveBoundingVertex(VertexId vertex, Point2f pt);
+        /** @brief growBounds(), without the journaling. */
+        void growBoundsSub(Rect rect);
+        /** @brief Grows the bounds to include the points from lo to hi (their componentwise minimum and
+        maximum), with room to spare: see setGrowableBounds(). Leaves them alone if they already include them. */
+        void growBoundsToInclude(Point2f lo, Point2f hi);
+        /** @brief Re-triangulates the vertices from scratch, keeping their IDs, within the bounding vertices where they
+        are now. */
+        void retriangulate();
+        /** @brief Connects the bounding vertices into the bounding triangle. */
+        void initBoundingEdges();
+        /** @brief Raises a runtime error unless vertex is one inserted, and still in the triangulation. */
+        void checkUserVertex(VertexId vertex) const;
+        /** @brief insert(), into the given vertex (detached from the triangulation) rather than a new one, if valid. */
+        VertexId insertSub(Point2f pt, VertexId vertex);
+        /** @brief Takes a vertex out of the triangulation, re-triangulating the hole it leaves, but keeps its slot. */
+        void detachVertex(VertexId vertex);
+        /** @brief Is edge the lowest-numbered of the three edges of the face on its left? */
+        bool isLowestEdgeOfFace(EdgeId edge) const;
+        /** @brief Is this face (given by its vertices, counterclockwise) the outside of the bounding triangle? */
+        bool isOuterFace(VertexArray const& vertices) const;
+        /** @brief Raises a runtime error unless the face table is up to date and face is in it. */
+        void checkFace(FaceId face) const;
+        /** @brief Sets the neighbors of a face from the faces of the reverse of its edges. */
+        void updateFaceNeighbors(FaceId face);
+        /** @brief Reassigns the IDs of the faces replaced by inserting a vertex to the new faces around it. */
+        void updateFacesAround(VertexId vertex);
+        /** @brief Gives the faces on either side of an edge just swapped the IDs of the two it replaced. */
+        void updateFacesAfterSwap(EdgeId edge, FaceId leftFace, FaceId rightFace);
         std::size_t getNumQuadEdges() const;
         std::size_t getMaxNumEdges() const;
         void dbgAssertEdgeInRange(EdgeId edge) const;
         void dbgAssertVertexInRange(VertexId vertex) const;
 
+        /** @brief Adds the sections of a snapshot of this subdivision, which must not change until it is written. */
+        void writeSnapshot(detail::SnapshotWriter& writer) const;
+        /** @brief Replaces this subdivision with the one in a snapshot, borrowing its arrays. */
+        void readSnapshot(detail::SnapshotReader const& reader);
+
+        /** @brief startJournal(), numbering the records from sequence on. */
+        void startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                          std::size_t checkpointInterval, std::uint64_t sequence);
+        /** @brief Appends a change to the journal, saving a checkpoint if one is due. */
+        void journalChange(detail::JournalOp op, VertexId vertex = InvalidVertex, Point2f pt = Point2f(),
+                           Point2f pt2 = Point2f());
+        /** @brief journalChange() for initDelaunay() or growBounds(). */
+        void journalRect(detail::JournalOp op, Rect rect);
+        /** @brief Makes a change read back from the journal. */
+        void applyJournalRecord(detail::JournalRecord const& record);
+
+        /** @brief Resets to just the placeholder and bounding vertices, with no edges. */
+        void initBoundingVertices(Rect rect);
+        /** @brief Is the point within the bounding rect (which is inclusive of the top and left only)? */
+        bool isInBounds(Point2f const& pt) const;
+
         /** @brief Performs the first, common portion of locate and locateVertices, preserving and returning more data
          * for the use of the wrapping functions */
-        detail::LocateSubResults locateSub(Point2f const& pt);
+        detail::LocateSubResults locateSub(Point2f const& pt, LocateCursor* cursor) const;
+
+        /** @brief The greedy walk of findNearest(), over the triangulation, starting from an endpoint of the edge that
+         * locate() returned for pt. */
+        VertexId findNearestByDescent(Point2f pt, EdgeId edge) const;
+        /** @brief findNearest() for a point known to be in bounds. */
+        VertexId findNearestSub(Point2f pt, LocateCursor* cursor) const;
+        /** @brief The search shared by findKNearest() and findWithinRadius(): visits the vertices within maxDist2
+         * (squared distance) of pt, nearest first, passing each (other than the bounding vertices) to visit until it
+         * returns false. Defined, and only used, in the implementation file. */
+        template <typename F>
+        void visitNeighborsBestFirst(Point2f pt, double maxDist2, NeighborSearchScratch& scratch, LocateCursor* cursor,
+                                     F&& visit) const;
 
         struct Vertex {
             Vertex();
@@ -409,53 +1067,176 @@ namespace subdiv2d {
             Point2f pt;
         };
 
-        struct QuadEdge {
-            QuadEdge();
-            QuadEdge(EdgeId edgeidx);
-            bool isfree() const;
+        /** @brief The quad-edges, with the parts used by walks stored apart from the rest.
+
+        Each quad-edge has four links (the next edge counterclockwise around the origin of each of its four rotations)
+        and four points (the origin of each rotation). The links and the primal points (origins of rotations 0 and
+        2) are stored together, since a walk step reads both for each edge it visits. The dual points (origins of
+        rotations 1 and 3) are only set for the Voronoi diagram, so they are kept in a separate array, out of the way.
+
+        Edge IDs are quad-edge index * 4 + rotation. A free quad-edge has next(qedge)[0] == Invalid, and the index of
+        the next free quad-edge in next(qedge)[1]. */
+        class QuadEdgeStorage {
+          public:
+            using Links = std::array<int, 4>;
+            using PointPair = std::array<VertexId, 2>;
+
+            explicit QuadEdgeStorage(MemoryResource* resource = nullptr) : primal_(resource), dual_(resource) {}
+
+            std::size_t size() const { return primal_.size(); }
+
+            void reserve(std::size_t n) {
+                primal_.reserve(n);
+                if (hasDual_) {
+                    dual_.reserve(n);
+                }
+            }
+
+            MemoryResource* resource() const { return primal_.resource(); }
+
+            /// Whether the dual points are stored: if not, org() of an odd rotation is always InvalidVertex. Only to be
+            /// changed while empty.
+            bool hasDual() const { return hasDual_; }
+            void setHasDual(bool hasDual) {
+                Subdiv2D_DbgAssert(primal_.empty());
+                hasDual_ = hasDual;
+            }
+
+            void clear() {
+                primal_.clear();
+                dual_.clear();
+            }
+
+            /// Grows or shrinks to n quad-edges. New ones have invalid links and points, so are free (but not yet
+            /// linked into any free list).
+            void resize(std::size_t n) {
+                primal_.resize(n, Primal{{{Invalid, Invalid, Invalid, Invalid}}, {{InvalidVertex, InvalidVertex}}});
+                if (hasDual_) {
+                    dual_.resize(n, PointPair{{InvalidVertex, InvalidVertex}});
+                }
+            }
 
             /// @todo Some values are EdgeId, some are QuadEdgeId. Thus, we lose type safety here. This is the tradeoff
-            /// of a primal-dual implementation like this. (I imagine it could probably be done differently with a
-            /// heterogeneous array, etc. but maybe not in C++, at least not easily...)
+            /// of a primal-dual implementation like this.
             ///
-            /// - next[0] corresponds to next around origin
-            /// - next[1] corresponds to next around right face?
-            /// - next[2] corresponds to next around dest
-            /// - next[3] corresponds to next around left face ?
-            int next[4];
-            VertexId pt[4];
-
-            VertexId origin() const { return pt[0]; }
-            VertexId& origin() { return pt[0]; }
-            VertexId dest() const { return pt[2]; }
-            VertexId& dest() { return pt[2]; }
+            /// - next(qedge)[0] corresponds to next around origin
+            /// - next(qedge)[1] corresponds to next around right face?
+            /// - next(qedge)[2] corresponds to next around dest
+            /// - next(qedge)[3] corresponds to next around left face ?
+            Links& next(std::size_t qedge) { return primal_[qedge].next; }
+            Links const& next(std::size_t qedge) const { return primal_[qedge].next; }
+            /// The link of one rotation of a quad-edge.
+            int& next(EdgeId edge) { return primal_[edge.get() >> 2].next[edge.get() & 3]; }
+            int next(EdgeId edge) const { return primal_[edge.get() >> 2].next[edge.get() & 3]; }
+
+            /// The origin of an edge: a primal point for even rotations, a dual (Voronoi) point for odd.
+            VertexId& org(EdgeId edge) {
+                Subdiv2D_DbgAssert(hasDual_ || !(edge.get() & 1));
+                auto& pair = (edge.get() & 1) ? dual_[edge.get() >> 2] : primal_[edge.get() >> 2].pt;
+                return pair[(edge.get() >> 1) & 1];
+            }
+            VertexId org(EdgeId edge) const {
+                if (!hasDual_ && (edge.get() & 1)) {
+                    return InvalidVertex;
+                }
+                auto const& pair = (edge.get() & 1) ? dual_[edge.get() >> 2] : primal_[edge.get() >> 2].pt;
+                return pair[(edge.get() >> 1) & 1];
+            }
+
+            /// The primal points: origin and destination of rotation 0.
+            PointPair const& primal(std::size_t qedge) const { return primal_[qedge].pt; }
+            /// The dual points: origin of rotation 1 (the right face's Voronoi vertex) and of rotation 3 (the left).
+            PointPair& dual(std::size_t qedge) { return dual_[qedge]; }
+
+            bool isfree(std::size_t qedge) const { return primal_[qedge].next[0] <= Invalid; }
+
+            /// Makes a quad-edge an isolated edge with no points (MakeEdge, in Guibas and Stolfi).
+            void makeEdge(std::size_t qedge) {
+                const int edge = static_cast<int>(qedge << 2);
+                primal_[qedge] = Primal{{{edge, edge + 3, edge + 2, edge + 1}}, {{InvalidVertex, InvalidVertex}}};
+                if (hasDual_) {
+                    dual_[qedge] = PointPair{{InvalidVertex, InvalidVertex}};
+                }
+            }
+
+            /// Marks a quad-edge free, linking it to the given next free quad-edge (or Invalid).
+            void setFree(std::size_t qedge, int nextFree) {
+                primal_[qedge].next[0] = Invalid;
+                primal_[qedge].next[1] = nextFree;
+            }
+            /// The next free quad-edge after a free one.
+            int nextFree(std::size_t qedge) const { return primal_[qedge].next[1]; }
+
+            /// Resets the dual points of every quad-edge.
+            void clearDual() { std::fill(dual_.begin(), dual_.end(), PointPair{{InvalidVertex, InvalidVertex}}); }
+
+          private:
+            /// Everything a walk needs: 24 bytes, rather than 32 with the dual points.
+            struct Primal {
+                Links next;
+                PointPair pt;
+            };
+            detail::MappableArray<Primal> primal_;
+            detail::MappableArray<PointPair> dual_;
+            bool hasDual_ = true;
+
+            friend class Subdiv2D;
         };
 
-        QuadEdge& getQuadEdge(EdgeId edge);
-        QuadEdge const& getQuadEdge(EdgeId edge) const;
-        QuadEdge& getQuadEdge(QuadEdgeId qedge);
-        QuadEdge const& getQuadEdge(QuadEdgeId qedge) const;
         Vertex& getVertexInternal(VertexId vertex);
 
         Vertex const& getVertexInternal(VertexId vertex) const;
 
+        /** @brief Empties the vertex and edge arrays, and has them get their memory from resource from now on. */
+        void setMemoryResource(MemoryResource* resource);
+
+        struct Face {
+            //! The edge out of the first vertex, with the face on its left.
+            EdgeId edge;
+            VertexArray vertices;
+            std::array<FaceId, 3> neighbors;
+        };
+
         //! All of the vertices
-        std::vector<Vertex> vtx;
+        detail::MappableArray<Vertex> vtx;
         //! All of the edges
-        std::vector<QuadEdge> qedges;
+        QuadEdgeStorage qedges;
         QuadEdgeId freeQEdge = InvalidQuadEdge;
         VertexId freePoint = InvalidVertex;
         bool validGeometry = false;
+        //! The face table: see calcFaces().
+        std::vector<Face> faces;
+        //! The face to the left of each primal edge, indexed by edge ID / 2.
+        std::vector<FaceId> edgeFaces;
+        bool validFaces = false;
+        //! Whether points outside the bounds grow them: see setGrowableBounds().
+        bool growableBounds = false;
+        //! The most steps moveBoundingVertex() takes before giving up: only changed by the tests, to force a rebuild.
+        int maxBoundingVertexSteps = 64;
 
         EdgeId recentEdge = InvalidEdge;
         //! Top left corner of the bounding rect
         Point2f topLeft;
         //! Bottom right corner of the bounding rect
         Point2f bottomRight;
+        //! Where changes are recorded, if anywhere.
+        detail::JournalHandle journal;
 
-        friend class detail::EdgeIterationHelper;
+        friend class detail::FaceIterationHelper;
+        friend class detail::DelaunayBuilder;
+        friend class detail::SubdivTestAccess;
+        friend class SubdivContainerBase;
     };
 
+    inline Point2f const& Subdiv2D::VertexView::position() const { return subdiv_->vtx[id.get()].pt; }
+
+    template <> Subdiv2D::VertexView Subdiv2D::ElementIterator<Subdiv2D::VertexView>::operator*() const;
+    template <> bool Subdiv2D::ElementIterator<Subdiv2D::VertexView>::skip() const;
+    template <> Subdiv2D::EdgeView Subdiv2D::ElementIterator<Subdiv2D::EdgeView>::operator*() const;
+    template <> bool Subdiv2D::ElementIterator<Subdiv2D::EdgeView>::skip() const;
+    template <> Subdiv2D::TriangleView Subdiv2D::ElementIterator<Subdiv2D::TriangleView>::operator*() const;
+    template <> bool Subdiv2D::ElementIterator<Subdiv2D::TriangleView>::skip() const;
+
 } // namespace subdiv2d
 } // namespace sensics
 
@@ -25,6 +25,7 @@
 
 // Standard includes
 #include <cstddef>
+#include <utility>
 
 namespace sensics {
 namespace detail {
@@ -88,13 +89,10 @@ namespace detail {
         TypeSafeIndex() = default;
         /// explicit construction with a value of the right type.
         explicit TypeSafeIndex(value_type val) : val_(val) {}
-        /// copy construct
-        TypeSafeIndex(type const& other) : val_(other.val_) {}
+        /// copy construct: defaulted, so IDs (and structs of them) are trivially copyable.
+        TypeSafeIndex(type const& other) = default;
         /// assign
-        TypeSafeIndex& operator=(type const& other) {
-            val_ = other.val_;
-            return *this;
-        }
+        TypeSafeIndex& operator=(type const& other) = default;
         /// swap
         void swap(type& other) { std::swap(val_, other.val_); }
 
@@ -115,7 +113,7 @@ namespace detail {
 
     /// free function for swap.
     template <typename Tag> static inline void swap(TypeSafeIndex<Tag>& lhs, TypeSafeIndex<Tag>& rhs) {
-        lhs.swap(rhs) :
+        lhs.swap(rhs);
     }
 
     // Implementation of general equality.
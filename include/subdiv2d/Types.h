@@ -161,15 +161,83 @@ namespace subdiv2d {
         return ((double)b.x - a.x) * ((double)c.y - a.y) - ((double)b.y - a.y) * ((double)c.x - a.x);
     }
 
+    namespace detail {
+        /// Half of machine epsilon for double: the largest relative error of one rounded operation.
+        static const double PredicateRoundoff = std::numeric_limits<double>::epsilon() * 0.5;
+        /// Bounds on the error of the floating-point evaluations in triangleOrientation() and isPtInCircle3(),
+        /// relative to the sum of the magnitudes of their terms. (From J. R. Shewchuk, "Adaptive Precision
+        /// Floating-Point Arithmetic and Fast Robust Geometric Predicates", 1997.)
+        static const double OrientationErrorBound = (3.0 + 16.0 * PredicateRoundoff) * PredicateRoundoff;
+        static const double InCircleErrorBound = (10.0 + 96.0 * PredicateRoundoff) * PredicateRoundoff;
+
+        /// The exact arithmetic behind triangleOrientation() and isPtInCircle3(), for the rare inputs where the
+        /// floating-point result is too close to zero to trust. Defined in Predicates.cpp.
+        int triangleOrientationExact(Point2f a, Point2f b, Point2f c);
+        int isPtInCircle3Exact(Point2f pt, Point2f a, Point2f b, Point2f c);
+    } // namespace detail
+
+    /** @brief The sign of doubleTriangleArea(a, b, c), computed exactly.
+
+    The area is first evaluated in floating point, and only if it is too close to zero for its sign to be certain is
+    it recomputed with exact arithmetic.
+
+    @returns 1 if a, b, c are counter-clockwise, -1 if clockwise, and 0 if collinear */
+    static inline int triangleOrientation(Point2f a, Point2f b, Point2f c) {
+        const double detLeft = ((double)b.x - a.x) * ((double)c.y - a.y);
+        const double detRight = ((double)b.y - a.y) * ((double)c.x - a.x);
+        const double det = detLeft - detRight;
+        const double errorBound = detail::OrientationErrorBound * (std::abs(detLeft) + std::abs(detRight));
+        if (det >= errorBound || -det >= errorBound) {
+            return (det > 0) - (det < 0);
+        }
+        return detail::triangleOrientationExact(a, b, c);
+    }
+
     /** @brief Is pt to the right of the line from a to b (facing toward b)?
-    Note that no epsilon is used: so "very nearly collinear" will return non-zero typically...
+    Note that no epsilon is used, and the result is exact: so "very nearly collinear" will return non-zero...
 
     @returns 1 if to the right, -1 if to the left, and 0 if collinear */
     static inline int isRightOf(Point2f pt, Point2f a, Point2f b) {
-        auto cw_area = doubleTriangleArea(pt, b, a);
-
-        // returns 1 if cw_area > 0, -1 if cw_area < 0, and 0 if cw_area == 0.
-        return (cw_area > 0) - (cw_area < 0);
+        // clockwise is "right of"
+        return triangleOrientation(pt, b, a);
+    }
+
+    /** @brief Is pt inside the circle through a, b, and c?
+
+    Like triangleOrientation(), this is evaluated in floating point, falling back to exact arithmetic only when that
+    can't be trusted, so the result is always exact.
+
+    @returns 1 if inside and -1 if outside when a, b, c are counter-clockwise (signs reversed when clockwise), and 0 if
+    exactly on the circle. */
+    static inline int isPtInCircle3(Point2f pt, Point2f a, Point2f b, Point2f c) {
+        const double adx = (double)a.x - pt.x;
+        const double ady = (double)a.y - pt.y;
+        const double bdx = (double)b.x - pt.x;
+        const double bdy = (double)b.y - pt.y;
+        const double cdx = (double)c.x - pt.x;
+        const double cdy = (double)c.y - pt.y;
+
+        const double bdxcdy = bdx * cdy;
+        const double cdxbdy = cdx * bdy;
+        const double alift = adx * adx + ady * ady;
+
+        const double cdxady = cdx * ady;
+        const double adxcdy = adx * cdy;
+        const double blift = bdx * bdx + bdy * bdy;
+
+        const double adxbdy = adx * bdy;
+        const double bdxady = bdx * ady;
+        const double clift = cdx * cdx + cdy * cdy;
+
+        const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+        const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift +
+                                 (std::abs(cdxady) + std::abs(adxcdy)) * blift +
+                                 (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+        const double errorBound = detail::InCircleErrorBound * permanent;
+        if (det >= errorBound || -det >= errorBound) {
+            return (det > 0) - (det < 0);
+        }
+        return detail::isPtInCircle3Exact(pt, a, b, c);
     }
 
     /** @brief Template class for specifying the size of an image or rectangle.
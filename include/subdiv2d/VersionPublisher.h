@@ -0,0 +1,215 @@
+/** @file
+    @brief Header providing read-copy-update publishing of immutable versions of a subdivision (or container), so that
+    query threads keep answering from one version while a writer builds the next.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_VersionPublisher_h_GUID_5B1E8F27_3A6C_4D90_B4E1_8C2F7A05D36B
+#define INCLUDED_VersionPublisher_h_GUID_5B1E8F27_3A6C_4D90_B4E1_8C2F7A05D36B
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /// A published version, of whatever type: see VersionPublisher.
+        struct VersionNode {
+            virtual ~VersionNode();
+            std::uint64_t number = 0;
+        };
+
+        /// Where a reader records the epoch it pinned a version in, or 0 if it has none pinned.
+        using ReaderSlot = std::atomic<std::uint64_t>;
+
+        /** The type-independent part of VersionPublisher: epoch-based reclamation of the versions replaced.
+
+        Each reader has a slot of its own. To pin, it stores the current epoch in its slot, then loads the current
+        version; to release, it stores 0. Publishing swaps in the new version, then advances the epoch, and the old
+        version is retired at the epoch it was replaced in: once no slot holds an epoch up to that one, no reader can
+        still be using it, so it is deleted. Pinning and releasing take no locks and write only the reader's own slot;
+        the mutex is only taken by writers, and by readers registering or unregistering. */
+        class PublisherBase {
+          public:
+            PublisherBase(PublisherBase const&) = delete;
+            PublisherBase& operator=(PublisherBase const&) = delete;
+
+            /// The number of the current version: 1 for the initial one, then counting up with each publish().
+            std::uint64_t currentVersion() const;
+
+            /// Deletes the retired versions no reader can still have pinned, returning the number still retired.
+            /// publish() does this itself, so this is only needed to free memory sooner after readers release.
+            std::size_t reclaim();
+
+            /// The number of versions replaced but not yet deleted.
+            std::size_t numRetired() const;
+
+          protected:
+            explicit PublisherBase(std::unique_ptr<VersionNode> initial);
+            /// All readers must have been destroyed first.
+            ~PublisherBase();
+
+            /// Makes node the current version, returning its number.
+            std::uint64_t publishNode(std::unique_ptr<VersionNode> node);
+            /// For writers: the current version, which stays valid as long as the returned lock is held.
+            std::pair<VersionNode const*, std::unique_lock<std::mutex> > lockCurrent() const;
+
+            ReaderSlot* registerReader();
+            void unregisterReader(ReaderSlot* slot);
+            /// Raises a runtime error if the reader already has a version pinned.
+            VersionNode const* pin(ReaderSlot& slot) const;
+            static void release(ReaderSlot& slot) { slot.store(0, std::memory_order_release); }
+
+          private:
+            /// Deletes what it can, with mutex_ held.
+            std::size_t reclaimLocked();
+
+            struct PaddedSlot {
+                ReaderSlot epoch{0};
+                /// Keeps each reader's slot on a cache line of its own, so pinning does not contend.
+                char padding[64 - sizeof(ReaderSlot)];
+                bool inUse = false;
+            };
+            struct Retired {
+                std::uint64_t epoch;
+                std::unique_ptr<VersionNode> node;
+            };
+
+            std::atomic<VersionNode*> current_;
+            /// current_->number, kept apart so that currentVersion() need not touch a version it has not pinned.
+            std::atomic<std::uint64_t> currentNumber_{1};
+            std::atomic<std::uint64_t> epoch_{1};
+            mutable std::mutex mutex_;
+            std::vector<std::unique_ptr<PaddedSlot> > slots_;
+            std::vector<Retired> retired_;
+        };
+    } // namespace detail
+
+    template <typename T> class VersionReader;
+    template <typename T> class PinnedVersion;
+
+    /** @brief Publishes immutable versions of a T (a Subdiv2D or a SubdivContainer) for concurrent readers.
+
+    A writer takes a copy of the current version (or builds a new one from scratch, such as with
+    Subdiv2D::buildDelaunay()), changes it at leisure, and publishes it: the swap is a single atomic store. Query
+    threads, each with a VersionReader, pin whichever version is current, query it, and release it. Readers never
+    wait for writers or for each other, so their latency stays flat while a rebuild runs; a pinned version is never
+    changed, and is deleted only after every reader has released it (by a later publish() or reclaim()).
+
+    Versions share nothing: copying the current version copies its vertex and edge arrays, as a flat copy of each.
+    */
+    template <typename T> class VersionPublisher : public detail::PublisherBase {
+      public:
+        using value_type = T;
+
+        explicit VersionPublisher(T initial) : PublisherBase(makeNode(std::move(initial))) {}
+
+        /// Returns a copy of the current version, to change and then publish. Safe to call from several writers.
+        T copyCurrent() const {
+            auto current = lockCurrent();
+            return static_cast<Node const*>(current.first)->value;
+        }
+
+        /// Makes value the current version, returning its number. Readers pinning from now on get this one, while
+        /// those already holding the previous one keep it until they release it.
+        std::uint64_t publish(T value) { return publishNode(makeNode(std::move(value))); }
+
+      private:
+        friend class VersionReader<T>;
+        friend class PinnedVersion<T>;
+        struct Node : detail::VersionNode {
+            explicit Node(T&& v) : value(std::move(v)) {}
+            T value;
+        };
+        static std::unique_ptr<detail::VersionNode> makeNode(T&& value) {
+            return std::unique_ptr<detail::VersionNode>(new Node(std::move(value)));
+        }
+    };
+
+    /** @brief A version pinned by a VersionReader: it stays valid, and unchanged, until released or destroyed. */
+    template <typename T> class PinnedVersion {
+      public:
+        PinnedVersion() = default;
+        PinnedVersion(PinnedVersion&& other) : slot_(other.slot_), node_(other.node_) { other.node_ = nullptr; }
+        PinnedVersion& operator=(PinnedVersion&& other) {
+            if (this != &other) {
+                release();
+                slot_ = other.slot_;
+                node_ = other.node_;
+                other.node_ = nullptr;
+            }
+            return *this;
+        }
+        PinnedVersion(PinnedVersion const&) = delete;
+        PinnedVersion& operator=(PinnedVersion const&) = delete;
+        ~PinnedVersion() { release(); }
+
+        explicit operator bool() const { return node_ != nullptr; }
+        T const& operator*() const { return node_->value; }
+        T const* operator->() const { return &node_->value; }
+        T const* get() const { return node_ ? &node_->value : nullptr; }
+        /// The number of the version, as returned by VersionPublisher::publish().
+        std::uint64_t version() const { return node_->number; }
+
+        /// Releases the version early, so the reader may pin again.
+        void release() {
+            if (node_) {
+                node_ = nullptr;
+                VersionPublisher<T>::release(*slot_);
+            }
+        }
+
+      private:
+        friend class VersionReader<T>;
+        using Node = typename VersionPublisher<T>::Node;
+        PinnedVersion(detail::ReaderSlot* slot, Node const* node) : slot_(slot), node_(node) {}
+        detail::ReaderSlot* slot_ = nullptr;
+        Node const* node_ = nullptr;
+    };
+
+    /** @brief A query thread's registration with a VersionPublisher, through which it pins versions.
+
+    Each thread reading needs its own, created once (registering takes the publisher's mutex) and kept for as long as
+    the thread reads; it must be destroyed before the publisher. A reader may have only one version pinned at a time.
+    */
+    template <typename T> class VersionReader {
+      public:
+        explicit VersionReader(VersionPublisher<T>& publisher)
+            : publisher_(&publisher), slot_(publisher.registerReader()) {}
+        VersionReader(VersionReader const&) = delete;
+        VersionReader& operator=(VersionReader const&) = delete;
+        ~VersionReader() { publisher_->unregisterReader(slot_); }
+
+        /// Pins the current version, without locking. Raises a runtime error if this reader already has one pinned.
+        PinnedVersion<T> pin() {
+            using Node = typename VersionPublisher<T>::Node;
+            return PinnedVersion<T>(slot_, static_cast<Node const*>(publisher_->pin(*slot_)));
+        }
+
+      private:
+        VersionPublisher<T>* publisher_;
+        detail::ReaderSlot* slot_;
+    };
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_VersionPublisher_h_GUID_5B1E8F27_3A6C_4D90_B4E1_8C2F7A05D36B
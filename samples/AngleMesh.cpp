@@ -191,12 +191,14 @@ int main(int argc, char* argv[]) {
     auto longitudeRange = longitudeExtrema.getMax() - longitudeExtrema.getMin();
     auto latitudeRange = latitudeExtrema.getMax() - latitudeExtrema.getMin();
     auto step = std::min(longitudeRange / STEPS, latitudeRange / STEPS);
+    // Successive grid points are adjacent, so start each location walk where the last one ended.
+    LocateCursor cursor;
     for (std::size_t xStep = 0; xStep * step + longitudeExtrema.getMin() <= longitudeExtrema.getMax(); ++xStep) {
         auto xLong = xStep * step + longitudeExtrema.getMin();
         for (std::size_t yStep = 0; yStep * step + latitudeExtrema.getMin() <= latitudeExtrema.getMax(); ++yStep) {
             auto yLat = yStep * step + latitudeExtrema.getMin();
             const auto pt = Point2f(xLong, yLat);
-            auto neighborhood = triangulationData.findNeighborhood(pt);
+            auto neighborhood = triangulationData.findNeighborhood(pt, &cursor);
             auto canInterpolate = computeWeights(neighborhood, pt);
             if (canInterpolate) {
                 auto interpolated = interpolate(neighborhood);
@@ -0,0 +1,352 @@
+/** @file
+    @brief Implementation of the divide-and-conquer construction of a Delaunay subdivision.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "DelaunayBuilder.h"
+#include "SpatialSort.h"
+#include "subdiv2d/AssertAndError.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <tuple>
+
+namespace sensics {
+namespace subdiv2d {
+    static inline bool lexicographicLess(Point2f const& a, Point2f const& b) {
+        return std::tie(a.x, a.y) < std::tie(b.x, b.y);
+    }
+
+    Subdiv2D Subdiv2D::buildDelaunay(Rect rect, std::vector<Point2f> const& ptvec, std::vector<VertexId>* outIds,
+                                     SubdivMode mode, MemoryResource* resource) {
+        return buildDelaunay(rect, ptvec, 1, outIds, mode, resource);
+    }
+
+    Subdiv2D Subdiv2D::buildDelaunay(Rect rect, std::vector<Point2f> const& ptvec, unsigned int numThreads,
+                                     std::vector<VertexId>* outIds, SubdivMode mode, MemoryResource* resource) {
+        if (numThreads == 0) {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        Subdiv2D ret;
+        ret.setMemoryResource(resource);
+        ret.qedges.setHasDual(mode == SubdivMode::DelaunayAndVoronoi);
+        // Both arrays then grow to their final size without reallocating.
+        ret.reserve(ptvec.size());
+        ret.initBoundingVertices(rect);
+        detail::DelaunayBuilder builder(ret);
+        auto ids = builder.addVertices(ptvec);
+        builder.triangulate(numThreads);
+        if (outIds) {
+            *outIds = std::move(ids);
+        }
+        return ret;
+    }
+
+    namespace detail {
+        DelaunayBuilder::DelaunayBuilder(Subdiv2D& subdiv) : subdiv_(subdiv) {}
+
+        std::vector<VertexId> DelaunayBuilder::addVertices(std::vector<Point2f> const& ptvec) {
+            const auto n = ptvec.size();
+            for (auto& pt : ptvec) {
+                if (!subdiv_.isInBounds(pt)) {
+                    Subdiv2D_Error(Error::StsOutOfRange, "");
+                }
+            }
+            // Find the first occurrence of each distinct point: stable sorting keeps equal points in input order.
+            std::vector<std::size_t> order(n);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return lexicographicLess(ptvec[a], ptvec[b]);
+            });
+            std::vector<std::size_t> firstOccurrence(n);
+            for (std::size_t k = 0; k < n; ++k) {
+                const auto i = order[k];
+                const bool duplicate = k > 0 && ptvec[i] == ptvec[order[k - 1]];
+                firstOccurrence[i] = duplicate ? firstOccurrence[order[k - 1]] : i;
+            }
+
+            // IDs are assigned along a Hilbert curve, so vertices close in the plane (and so in the recursion) are
+            // close in memory. Equal points share a Hilbert key and are ordered by index within it, so each first
+            // occurrence is reached before its duplicates.
+            std::vector<VertexId> ids(n);
+            for (auto i : hilbertOrder(ptvec.data(), n, subdiv_.topLeft, subdiv_.bottomRight)) {
+                ids[i] = (firstOccurrence[i] == i) ? subdiv_.newPoint(ptvec[i], false) : ids[firstOccurrence[i]];
+            }
+            return ids;
+        }
+
+        /// Sub-triangulations smaller than this are not worth handing to another thread.
+        static const std::size_t MinParallelBuildSize = 4096;
+
+        void DelaunayBuilder::triangulate(unsigned int numThreads) {
+            vertices_.clear();
+            const auto numVertices = subdiv_.vtx.size();
+            for (std::size_t i = 1; i < numVertices; ++i) {
+                if (!subdiv_.vtx[i].isfree()) {
+                    vertices_.push_back(VertexId(static_cast<int>(i)));
+                }
+            }
+            Subdiv2D_Assert(vertices_.size() >= 3);
+
+            // Set aside all of the quad-edges up front: the arrays must not reallocate while other threads use them.
+            edgeBase_ = subdiv_.qedges.size();
+            subdiv_.qedges.resize(edgeBase_ + 3 * vertices_.size());
+
+            EdgePool pool;
+            auto hull = build(0, vertices_.size(), Axis::X, pool, numThreads);
+
+            // Hand the leftover quad-edges to the subdivision.
+            if (pool.head) {
+                subdiv_.qedges.setFree(pool.tail, subdiv_.freeQEdge.get());
+                subdiv_.freeQEdge = QuadEdgeId(pool.head);
+            }
+
+            // Edge deletion during the merges may have left some vertices referring to an edge that no longer exists.
+            const auto numQEdges = subdiv_.qedges.size();
+            for (std::size_t i = 1; i < numQEdges; ++i) {
+                if (subdiv_.qedges.isfree(i)) {
+                    continue;
+                }
+                auto const& primal = subdiv_.qedges.primal(i);
+                auto edge = EdgeId(static_cast<int>(i * 4));
+                subdiv_.vtx[primal[0].get()].firstEdge = edge;
+                subdiv_.vtx[primal[1].get()].firstEdge = subdiv_.symEdge(edge);
+            }
+
+            subdiv_.recentEdge = hull.first;
+            subdiv_.validGeometry = false;
+        }
+
+        void DelaunayBuilder::initPool(EdgePool& pool, std::size_t begin, std::size_t end) {
+            const auto first = static_cast<int>(edgeBase_ + 3 * begin);
+            const auto last = static_cast<int>(edgeBase_ + 3 * end);
+            for (int i = first; i < last; ++i) {
+                subdiv_.qedges.setFree(i, (i + 1 < last) ? i + 1 : Subdiv2D::Invalid);
+            }
+            pool.head = first;
+            pool.tail = last - 1;
+        }
+
+        void DelaunayBuilder::joinPools(EdgePool& pool, EdgePool const& other) {
+            if (!other.head) {
+                return;
+            }
+            if (pool.head) {
+                subdiv_.qedges.setFree(pool.tail, other.head);
+            } else {
+                pool.head = other.head;
+            }
+            pool.tail = other.tail;
+        }
+
+        bool DelaunayBuilder::axisLess(Axis axis, VertexId a, VertexId b) const {
+            auto const& pa = point(a);
+            auto const& pb = point(b);
+            if (axis == Axis::X) {
+                return pa.x < pb.x || (pa.x == pb.x && pa.y < pb.y);
+            }
+            return pa.y < pb.y || (pa.y == pb.y && pa.x > pb.x);
+        }
+
+        DelaunayBuilder::HullEdges DelaunayBuilder::hullEdgesAlong(Axis axis, HullEdges const& hull) const {
+            Subdiv2D const& s = subdiv_;
+            // Walk the counter-clockwise hull edges, visiting each with the edge coming into its origin. The clockwise
+            // hull edge out of a vertex is the reverse of the counter-clockwise one into it.
+            const auto first = hull.first;
+            auto lowest = first;
+            auto highestIn = EdgeId();
+            auto highest = VertexId();
+            auto in = first;
+            do {
+                auto out = s.getEdge(in, Subdiv2D::PREV_AROUND_RIGHT);
+                auto org = s.edgeOrg(out);
+                if (axisLess(axis, org, s.edgeOrg(lowest))) {
+                    lowest = out;
+                }
+                if (!highest.valid() || axisLess(axis, highest, org)) {
+                    highest = org;
+                    highestIn = in;
+                }
+                in = out;
+            } while (in != first);
+            return HullEdges(lowest, s.symEdge(highestIn));
+        }
+
+        DelaunayBuilder::HullEdges DelaunayBuilder::build(std::size_t begin, std::size_t end, Axis axis,
+                                                          EdgePool& pool, unsigned int numThreads) {
+            const auto n = end - begin;
+            Subdiv2D& s = subdiv_;
+            auto less = [&](VertexId a, VertexId b) { return axisLess(axis, a, b); };
+            if (n <= 3) {
+                initPool(pool, begin, end);
+                std::sort(vertices_.begin() + begin, vertices_.begin() + end, less);
+            }
+            if (n == 2) {
+                auto a = makeEdge(vertices_[begin], vertices_[begin + 1], pool);
+                return HullEdges(a, s.symEdge(a));
+            }
+            if (n == 3) {
+                const auto s1 = vertices_[begin];
+                const auto s2 = vertices_[begin + 1];
+                const auto s3 = vertices_[begin + 2];
+                auto a = makeEdge(s1, s2, pool);
+                auto b = makeEdge(s2, s3, pool);
+                s.splice(s.symEdge(a), b);
+                // Close the triangle, unless the points are collinear.
+                if (ccw(s1, s2, s3)) {
+                    connect(b, a, pool);
+                    return HullEdges(a, s.symEdge(b));
+                }
+                if (ccw(s1, s3, s2)) {
+                    auto c = connect(b, a, pool);
+                    return HullEdges(s.symEdge(c), c);
+                }
+                return HullEdges(a, s.symEdge(b));
+            }
+
+            // Split at the median along this axis, then triangulate each half split along the other. The halves
+            // share no vertices or quad-edges, so they may be built concurrently.
+            const auto mid = begin + n / 2;
+            std::nth_element(vertices_.begin() + begin, vertices_.begin() + mid, vertices_.begin() + end, less);
+            HullEdges leftHull, rightHull;
+            EdgePool rightPool;
+            if (numThreads > 1 && n >= MinParallelBuildSize) {
+                const auto leftThreads = numThreads / 2;
+                auto left = std::async(std::launch::async, [&] {
+                    return build(begin, mid, otherAxis(axis), pool, leftThreads);
+                });
+                rightHull = build(mid, end, otherAxis(axis), rightPool, numThreads - leftThreads);
+                leftHull = left.get();
+            } else {
+                leftHull = build(begin, mid, otherAxis(axis), pool, 1);
+                rightHull = build(mid, end, otherAxis(axis), rightPool, 1);
+            }
+            joinPools(pool, rightPool);
+
+            EdgeId ldo, ldi, rdi, rdo;
+            std::tie(ldo, ldi) = hullEdgesAlong(axis, leftHull);
+            std::tie(rdi, rdo) = hullEdgesAlong(axis, rightHull);
+
+            // Find the lower common tangent of the two halves.
+            for (;;) {
+                if (leftOf(s.edgeOrg(rdi), ldi)) {
+                    ldi = s.getEdge(ldi, Subdiv2D::NEXT_AROUND_LEFT);
+                } else if (rightOf(s.edgeOrg(ldi), rdi)) {
+                    rdi = s.getEdge(rdi, Subdiv2D::PREV_AROUND_RIGHT);
+                } else {
+                    break;
+                }
+            }
+
+            auto basel = connect(s.symEdge(rdi), ldi, pool);
+            if (s.edgeOrg(ldi) == s.edgeOrg(ldo)) {
+                ldo = s.symEdge(basel);
+            }
+            if (s.edgeOrg(rdi) == s.edgeOrg(rdo)) {
+                rdo = basel;
+            }
+
+            // Zip the halves together from the bottom up, deleting edges that fail the empty circle test.
+            auto valid = [&](EdgeId edge) { return rightOf(s.edgeDst(edge), basel); };
+            for (;;) {
+                auto lcand = s.nextEdge(s.symEdge(basel));
+                if (valid(lcand)) {
+                    while (inCircle(s.edgeDst(basel), s.edgeOrg(basel), s.edgeDst(lcand),
+                                    s.edgeDst(s.nextEdge(lcand)))) {
+                        auto next = s.nextEdge(lcand);
+                        deleteEdge(lcand, pool);
+                        lcand = next;
+                    }
+                }
+                auto rcand = s.getEdge(basel, Subdiv2D::PREV_AROUND_ORG);
+                if (valid(rcand)) {
+                    while (inCircle(s.edgeDst(basel), s.edgeOrg(basel), s.edgeDst(rcand),
+                                    s.edgeDst(s.getEdge(rcand, Subdiv2D::PREV_AROUND_ORG)))) {
+                        auto next = s.getEdge(rcand, Subdiv2D::PREV_AROUND_ORG);
+                        deleteEdge(rcand, pool);
+                        rcand = next;
+                    }
+                }
+                const bool lvalid = valid(lcand);
+                const bool rvalid = valid(rcand);
+                if (!lvalid && !rvalid) {
+                    // basel is now the upper common tangent.
+                    break;
+                }
+                if (!lvalid ||
+                    (rvalid && inCircle(s.edgeDst(lcand), s.edgeOrg(lcand), s.edgeOrg(rcand), s.edgeDst(rcand)))) {
+                    basel = connect(rcand, s.symEdge(basel), pool);
+                } else {
+                    basel = connect(s.symEdge(basel), s.symEdge(lcand), pool);
+                }
+            }
+            return HullEdges(ldo, rdo);
+        }
+
+        EdgeId DelaunayBuilder::makeEdge(VertexId org, VertexId dst, EdgePool& pool) {
+            Subdiv2D_Assert(pool.head);
+            auto qedge = pool.head;
+            pool.head = subdiv_.qedges.nextFree(qedge);
+            auto edge = EdgeId(qedge * 4);
+            subdiv_.qedges.makeEdge(qedge);
+            subdiv_.setEdgePoints(edge, org, dst);
+            return edge;
+        }
+
+        EdgeId DelaunayBuilder::connect(EdgeId edgeA, EdgeId edgeB, EdgePool& pool) {
+            Subdiv2D& s = subdiv_;
+            auto edge = makeEdge(s.edgeDst(edgeA), s.edgeOrg(edgeB), pool);
+            s.splice(edge, s.getEdge(edgeA, Subdiv2D::NEXT_AROUND_LEFT));
+            s.splice(s.symEdge(edge), edgeB);
+            return edge;
+        }
+
+        void DelaunayBuilder::deleteEdge(EdgeId edge, EdgePool& pool) {
+            Subdiv2D& s = subdiv_;
+            s.splice(edge, s.getEdge(edge, Subdiv2D::PREV_AROUND_ORG));
+            auto sedge = s.symEdge(edge);
+            s.splice(sedge, s.getEdge(sedge, Subdiv2D::PREV_AROUND_ORG));
+
+            auto qedge = edge.get() >> 2;
+            subdiv_.qedges.setFree(qedge, pool.head);
+            if (!pool.head) {
+                pool.tail = qedge;
+            }
+            pool.head = qedge;
+        }
+
+        Point2f const& DelaunayBuilder::point(VertexId vertex) const { return subdiv_.vtx[vertex.get()].pt; }
+
+        bool DelaunayBuilder::ccw(VertexId a, VertexId b, VertexId c) const {
+            return triangleOrientation(point(a), point(b), point(c)) > 0;
+        }
+
+        bool DelaunayBuilder::rightOf(VertexId vertex, EdgeId edge) const {
+            return ccw(vertex, subdiv_.edgeDst(edge), subdiv_.edgeOrg(edge));
+        }
+
+        bool DelaunayBuilder::leftOf(VertexId vertex, EdgeId edge) const {
+            return ccw(vertex, subdiv_.edgeOrg(edge), subdiv_.edgeDst(edge));
+        }
+
+        bool DelaunayBuilder::inCircle(VertexId a, VertexId b, VertexId c, VertexId d) const {
+            return isPtInCircle3(point(d), point(a), point(b), point(c)) > 0;
+        }
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
@@ -0,0 +1,101 @@
+/** @file
+    @brief Header for the divide-and-conquer construction of a Delaunay subdivision.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_DelaunayBuilder_h_GUID_4E7A2C9B_1D36_4F80_B5C2_7A9E3D10F648
+#define INCLUDED_DelaunayBuilder_h_GUID_4E7A2C9B_1D36_4F80_B5C2_7A9E3D10F648
+
+// Internal Includes
+#include "subdiv2d/Subdivision2D.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <utility>
+#include <vector>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /** Builds the Delaunay triangulation of all vertices of a subdivision that has vertices but no edges, using
+        the divide-and-conquer algorithm of Guibas and Stolfi, "Primitives for the manipulation of general subdivisions
+        and the computation of Voronoi diagrams" (1985), as presented in the CS348a handout referenced in
+        Subdivision2D.cpp. */
+        class DelaunayBuilder {
+          public:
+            explicit DelaunayBuilder(Subdiv2D& subdiv);
+
+            /// Adds the points as vertices, merging exactly-equal points, and returns their IDs in input order.
+            std::vector<VertexId> addVertices(std::vector<Point2f> const& ptvec);
+
+            /// Connects all (non-free) vertices of the subdivision into a Delaunay triangulation, using up to
+            /// numThreads threads.
+            void triangulate(unsigned int numThreads = 1);
+
+          private:
+            /// The recursion alternates between splitting along x and along y ("alternating cuts", as in Dwyer, "A
+            /// faster divide-and-conquer algorithm for constructing Delaunay triangulations" (1987)), which avoids the
+            /// long, thin intermediate triangles (and so many of the deleted edges) of splitting along x alone.
+            /// Splitting along y is splitting along x in coordinates rotated by 90 degrees, which preserves the
+            /// orientation and in-circle predicates, so only the ordering of vertices needs to know about the axis.
+            enum class Axis { X, Y };
+            static Axis otherAxis(Axis axis) { return axis == Axis::X ? Axis::Y : Axis::X; }
+            /// Strict total order of vertices along an axis: by the coordinate along the axis, then by the other
+            /// (negated for Y, to match the rotation).
+            bool axisLess(Axis axis, VertexId a, VertexId b) const;
+
+            /// The counter-clockwise convex hull edge out of the leftmost vertex, and the clockwise convex hull edge
+            /// out of the rightmost vertex, of a sub-triangulation, where "left" and "right" are along some axis.
+            using HullEdges = std::pair<EdgeId, EdgeId>;
+
+            /** Quad-edges available to one sub-triangulation: a list threaded through next[1] like the subdivision's
+            own free list. Each sub-triangulation of k vertices starts with its own 3k quad-edges (enough, since a
+            planar graph on k vertices has fewer than 3k edges) and the merge of two takes both lists, so concurrent
+            sub-triangulations never share allocator state, and the edges used do not depend on the thread count.
+            */
+            struct EdgePool {
+                int head = 0;
+                int tail = 0;
+            };
+            void initPool(EdgePool& pool, std::size_t begin, std::size_t end);
+            void joinPools(EdgePool& pool, EdgePool const& other);
+
+            /// Triangulates the vertices in vertices_[begin, end), returning hull edges with respect to the given axis.
+            /// Uses up to numThreads threads, and leaves the unused quad-edges of the range in pool.
+            HullEdges build(std::size_t begin, std::size_t end, Axis axis, EdgePool& pool, unsigned int numThreads);
+            /// Given the hull edges of a sub-triangulation with respect to one axis, find them with respect to another.
+            HullEdges hullEdgesAlong(Axis axis, HullEdges const& hull) const;
+
+            /// Counterparts of Subdiv2D::newEdge() (with setting its points), connectEdges() and deleteEdge(),
+            /// allocating from a pool.
+            EdgeId makeEdge(VertexId org, VertexId dst, EdgePool& pool);
+            EdgeId connect(EdgeId edgeA, EdgeId edgeB, EdgePool& pool);
+            void deleteEdge(EdgeId edge, EdgePool& pool);
+            Point2f const& point(VertexId vertex) const;
+            bool ccw(VertexId a, VertexId b, VertexId c) const;
+            bool rightOf(VertexId vertex, EdgeId edge) const;
+            bool leftOf(VertexId vertex, EdgeId edge) const;
+            /// Is d inside the circle through a, b, c (which are counter-clockwise)?
+            bool inCircle(VertexId a, VertexId b, VertexId c, VertexId d) const;
+
+            Subdiv2D& subdiv_;
+            /// Vertices being triangulated, partitioned in place as the recursion proceeds.
+            std::vector<VertexId> vertices_;
+            /// Index of the first of the quad-edges set aside for the triangulation: vertices_[i] is allotted the three
+            /// starting at edgeBase_ + 3 * i.
+            std::size_t edgeBase_ = 0;
+        };
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_DelaunayBuilder_h_GUID_4E7A2C9B_1D36_4F80_B5C2_7A9E3D10F648
@@ -0,0 +1,263 @@
+/** @file
+    @brief Implementation of the append-only journals of changes to a subdivision or container.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "Journal.h"
+#include "Snapshot.h"
+#include "subdiv2d/AssertAndError.h"
+#include "subdiv2d/Subdivision2D.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        static_assert(sizeof(JournalRecord) == 24, "Journal records are stored as raw bytes");
+
+        namespace {
+            const char Magic[8] = {'S', 'U', 'B', 'D', 'J', 'R', 'N', 'L'};
+            /// As for snapshots: written in the byte order of the machine writing the file.
+            const std::uint32_t ByteOrderTag = 0x01020304;
+            const std::uint32_t Version = 1;
+
+            struct JournalHeader {
+                char magic[8];
+                std::uint32_t byteOrder;
+                std::uint32_t version;
+                std::uint32_t valueSize;
+                std::uint32_t reserved;
+                /// Sequence number of the first record.
+                std::uint64_t sequence;
+            };
+        } // namespace
+
+        Journal::Journal(std::string const& snapshotPath, std::string const& journalPath, std::size_t valueSize,
+                         std::size_t checkpointInterval, std::uint64_t sequence)
+            : snapshotPath_(snapshotPath), journalPath_(journalPath), valueSize_(valueSize),
+              checkpointInterval_(checkpointInterval), sequence_(sequence),
+              buffer_(sizeof(JournalRecord) + valueSize) {}
+
+        void Journal::restart() {
+            if (os_.is_open()) {
+                os_.close();
+            }
+            os_.clear();
+            JournalHeader header;
+            std::memcpy(header.magic, Magic, sizeof(Magic));
+            header.byteOrder = ByteOrderTag;
+            header.version = Version;
+            header.valueSize = static_cast<std::uint32_t>(valueSize_);
+            header.reserved = 0;
+            header.sequence = sequence_;
+            const auto tempPath = journalPath_ + ".tmp";
+            {
+                std::ofstream os(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+                os.write(reinterpret_cast<char const*>(&header), sizeof(header));
+                os.close();
+                if (!os) {
+                    std::remove(tempPath.c_str());
+                    Subdiv2D_Error(Error::StsError, "Could not write the journal file");
+                }
+            }
+            if (std::rename(tempPath.c_str(), journalPath_.c_str()) != 0) {
+                std::remove(tempPath.c_str());
+                Subdiv2D_Error(Error::StsError, "Could not replace the journal file");
+            }
+            os_.open(journalPath_.c_str(), std::ios::binary | std::ios::app);
+            if (!os_) {
+                Subdiv2D_Error(Error::StsError, "Could not open the journal file for writing");
+            }
+            sinceCheckpoint_ = 0;
+        }
+
+        bool Journal::append(JournalRecord const& record, void const* value) {
+            // One write per record, so a crash can only cut short the last one.
+            std::memcpy(buffer_.data(), &record, sizeof(record));
+            if (value) {
+                std::memcpy(buffer_.data() + sizeof(record), value, valueSize_);
+            } else {
+                std::fill(buffer_.begin() + sizeof(record), buffer_.end(), char(0));
+            }
+            os_.write(buffer_.data(), buffer_.size());
+            os_.flush();
+            if (!os_) {
+                Subdiv2D_Error(Error::StsError, "Could not write the journal file");
+            }
+            ++sequence_;
+            ++sinceCheckpoint_;
+            return checkpointInterval_ && sinceCheckpoint_ >= checkpointInterval_;
+        }
+
+        void Journal::checkpoint(std::function<void(SnapshotWriter&)> const& write) {
+            SnapshotWriter writer;
+            write(writer);
+            const std::uint64_t sequence = sequence_;
+            writer.addCopy(SnapshotSection::JournalSequence, &sequence, sizeof(sequence), 1);
+            writer.write(snapshotPath_);
+            restart();
+        }
+
+        std::uint64_t Journal::getSnapshotSequence(SnapshotReader const& reader) {
+            if (!reader.has(SnapshotSection::JournalSequence)) {
+                return 0;
+            }
+            std::size_t count = 0;
+            std::uint64_t sequence;
+            std::memcpy(&sequence, reader.get(SnapshotSection::JournalSequence, sizeof(sequence), count),
+                        sizeof(sequence));
+            return sequence;
+        }
+
+        std::uint64_t Journal::replay(std::string const& journalPath, std::size_t valueSize, std::uint64_t sequence,
+                                      std::function<void(JournalRecord const&, void const*)> const& apply) {
+            std::ifstream is(journalPath.c_str(), std::ios::binary);
+            if (!is) {
+                Subdiv2D_Error(Error::StsError, "Could not open the journal file");
+            }
+            JournalHeader header;
+            if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                // Cut short while being started over: the snapshot already holds everything.
+                return sequence;
+            }
+            if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.byteOrder != ByteOrderTag) {
+                Subdiv2D_Error(Error::StsParseError, "Not a journal file");
+            }
+            if (header.version != Version || header.valueSize != valueSize) {
+                Subdiv2D_Error(Error::StsUnsupportedFormat, "Journal is of an unsupported version or value type");
+            }
+            if (header.sequence > sequence) {
+                Subdiv2D_Error(Error::StsParseError, "Journal starts after the snapshot: records are missing");
+            }
+            std::vector<char> buffer(sizeof(JournalRecord) + valueSize);
+            auto current = header.sequence;
+            JournalRecord record;
+            while (is.read(buffer.data(), buffer.size())) {
+                if (current++ < sequence) {
+                    // Already in the snapshot: the process stopped between saving it and starting the journal over.
+                    continue;
+                }
+                std::memcpy(&record, buffer.data(), sizeof(record));
+                apply(record, buffer.data() + sizeof(record));
+            }
+            return std::max(current, sequence);
+        }
+
+        JournalHandle::JournalHandle() = default;
+        JournalHandle::JournalHandle(JournalHandle const&) {}
+        JournalHandle::JournalHandle(JournalHandle&& other) = default;
+        JournalHandle& JournalHandle::operator=(JournalHandle const&) {
+            journal_.reset();
+            return *this;
+        }
+        JournalHandle& JournalHandle::operator=(JournalHandle&& other) = default;
+        JournalHandle::~JournalHandle() = default;
+        void JournalHandle::reset(Journal* journal) { journal_.reset(journal); }
+    } // namespace detail
+
+    void Subdiv2D::startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                                std::size_t checkpointInterval) {
+        startJournal(snapshotPath, journalPath, checkpointInterval, 0);
+    }
+
+    void Subdiv2D::startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                                std::size_t checkpointInterval, std::uint64_t sequence) {
+        journal.reset(new detail::Journal(snapshotPath, journalPath, 0, checkpointInterval, sequence));
+        checkpoint();
+    }
+
+    void Subdiv2D::stopJournal() { journal.reset(); }
+
+    bool Subdiv2D::isJournaling() const { return static_cast<bool>(journal); }
+
+    void Subdiv2D::checkpoint() {
+        if (!journal) {
+            Subdiv2D_Error(Error::StsError, "Not journaling: call startJournal() first");
+        }
+        journal->checkpoint([&](detail::SnapshotWriter& writer) { writeSnapshot(writer); });
+    }
+
+    void Subdiv2D::journalChange(detail::JournalOp op, VertexId vertex, Point2f pt, Point2f pt2) {
+        const detail::JournalRecord record = {op, vertex.get(), {pt.x, pt.y, pt2.x, pt2.y}};
+        if (journal->append(record)) {
+            checkpoint();
+        }
+    }
+
+    void Subdiv2D::journalRect(detail::JournalOp op, Rect rect) {
+        // The rect is stored bit for bit, rather than converted to float.
+        detail::JournalRecord record = {op, 0, {}};
+        const int coords[4] = {rect.x, rect.y, rect.width, rect.height};
+        std::memcpy(record.coords, coords, sizeof(coords));
+        if (journal->append(record)) {
+            checkpoint();
+        }
+    }
+
+    Subdiv2D Subdiv2D::recover(std::string const& snapshotPath, std::string const& journalPath,
+                               std::size_t checkpointInterval, MemoryResource* resource) {
+        Subdiv2D ret;
+        ret.setMemoryResource(resource);
+        const detail::SnapshotReader reader(snapshotPath);
+        ret.readSnapshot(reader);
+        const auto sequence = detail::Journal::replay(
+            journalPath, 0, detail::Journal::getSnapshotSequence(reader),
+            [&](detail::JournalRecord const& record, void const*) { ret.applyJournalRecord(record); });
+        ret.startJournal(snapshotPath, journalPath, checkpointInterval, sequence);
+        return ret;
+    }
+
+    void Subdiv2D::applyJournalRecord(detail::JournalRecord const& record) {
+        const Point2f pt(record.coords[0], record.coords[1]);
+        switch (record.op) {
+        case detail::JournalOp::InitDelaunay: {
+            int rect[4];
+            std::memcpy(rect, record.coords, sizeof(rect));
+            initDelaunay(Rect(rect[0], rect[1], rect[2], rect[3]));
+            break;
+        }
+        case detail::JournalOp::Insert:
+            insert(pt);
+            break;
+        case detail::JournalOp::Remove:
+            remove(VertexId(record.vertex));
+            break;
+        case detail::JournalOp::Move:
+            move(VertexId(record.vertex), pt);
+            break;
+        case detail::JournalOp::CalcVoronoi:
+            calcVoronoi();
+            break;
+        case detail::JournalOp::Compact:
+            compact();
+            break;
+        case detail::JournalOp::GrowBounds: {
+            int rect[4];
+            std::memcpy(rect, record.coords, sizeof(rect));
+            growBounds(Rect(rect[0], rect[1], rect[2], rect[3]));
+            break;
+        }
+        case detail::JournalOp::GrowableBounds:
+            setGrowableBounds(record.vertex != 0);
+            break;
+        default:
+            Subdiv2D_Error(Error::StsParseError, "Journal record is not of a subdivision");
+        }
+    }
+} // namespace subdiv2d
+} // namespace sensics
@@ -0,0 +1,120 @@
+/** @file
+    @brief Header for the append-only journals of changes to a subdivision or container, between snapshot checkpoints.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_Journal_h_GUID_6A2E9D41_C7B3_4F08_9E5D_1B8F3C26A7E0
+#define INCLUDED_Journal_h_GUID_6A2E9D41_C7B3_4F08_9E5D_1B8F3C26A7E0
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        class SnapshotReader;
+        class SnapshotWriter;
+
+        /// The changes a journal records.
+        enum class JournalOp : std::uint32_t {
+            /// Subdiv2D::initDelaunay(): coords is the rect.
+            InitDelaunay = 1,
+            /// Subdiv2D::insert(): coords[0, 2) is the point.
+            Insert = 2,
+            /// Subdiv2D::remove(): vertex is the vertex.
+            Remove = 3,
+            /// Subdiv2D::move(): vertex is the vertex, coords[0, 2) the new position.
+            Move = 4,
+            /// Subdiv2D::calcVoronoi(), when it computed the diagram.
+            CalcVoronoi = 5,
+            /// SubdivContainer::insert(): coords[0, 2) is the point, and the value follows the record.
+            InsertValue = 6,
+            /// SubdivContainer::erase(): coords[0, 2) is the point.
+            Erase = 7,
+            /// SubdivContainer::move(): coords[0, 2) is the point, coords[2, 4) where it moved to.
+            MovePoint = 8,
+            /// Subdiv2D::compact() or SubdivContainer::compact().
+            Compact = 9,
+            /// Subdiv2D::growBounds() or SubdivContainer::growBounds(): coords is the rect.
+            GrowBounds = 10,
+            /// Subdiv2D::setGrowableBounds() or SubdivContainer::setGrowableBounds(): vertex is 1 for growable, else 0.
+            GrowableBounds = 11
+        };
+
+        /// A change, as stored in a journal file: fixed size, followed by the value for a container.
+        struct JournalRecord {
+            JournalOp op;
+            std::int32_t vertex;
+            float coords[4];
+        };
+
+        /** Appends records of changes to a journal file, and keeps track of when a checkpoint is due.
+
+        Every record has a sequence number, counting from the start of journaling. A checkpoint saves a snapshot,
+        including the sequence number of the next record, then starts the journal over, from that number: if the
+        process stops between the two, recovery skips the records the snapshot already includes. */
+        class Journal {
+          public:
+            /// Sets up a journal of records from sequence on. The journal file is only started over (replacing any
+            /// existing one) by the first checkpoint(), once the snapshot it follows has been saved.
+            Journal(std::string const& snapshotPath, std::string const& journalPath, std::size_t valueSize,
+                    std::size_t checkpointInterval, std::uint64_t sequence);
+
+            /// Appends a record (and value, if this is a container's journal: zeros if value is nullptr), flushed to
+            /// the operating system so it survives the process. Returns true if a checkpoint is due.
+            bool append(JournalRecord const& record, void const* value = nullptr);
+
+            /// Writes a snapshot as a checkpoint: write should add the sections of the snapshot to the writer. The
+            /// snapshot is written beside snapshotPath then renamed over it, so a crash never leaves it half-written,
+            /// and a subdivision mapped from the old one keeps its pages.
+            void checkpoint(std::function<void(SnapshotWriter&)> const& write);
+
+            /// The sequence number of the next record.
+            std::uint64_t sequence() const { return sequence_; }
+
+            /// Reads the sequence number saved by checkpoint(), or 0 for a snapshot saved otherwise.
+            static std::uint64_t getSnapshotSequence(SnapshotReader const& reader);
+
+            /// Calls apply for each record in a journal file from sequence on, stopping at a record cut short by a
+            /// crash. Returns the sequence number after the last record. A file cut short within its header (as a crash
+            /// can leave it, where the rename in restart() reaches the disk before the data) holds no records. Raises a
+            /// runtime error if the file is not a journal with values of valueSize, or starts after sequence.
+            static std::uint64_t replay(std::string const& journalPath, std::size_t valueSize, std::uint64_t sequence,
+                                        std::function<void(JournalRecord const&, void const*)> const& apply);
+
+          private:
+            /// Starts the journal file over, with no records: the header is written beside it then renamed over it, so
+            /// a crash leaves either the old journal or the new one.
+            void restart();
+            std::string snapshotPath_;
+            std::string journalPath_;
+            std::size_t valueSize_;
+            std::size_t checkpointInterval_;
+            std::uint64_t sequence_;
+            std::uint64_t sinceCheckpoint_ = 0;
+            std::ofstream os_;
+            std::vector<char> buffer_;
+        };
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_Journal_h_GUID_6A2E9D41_C7B3_4F08_9E5D_1B8F3C26A7E0
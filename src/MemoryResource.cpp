@@ -0,0 +1,129 @@
+/** @file
+    @brief Implementation of the memory resources.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "subdiv2d/MemoryResource.h"
+#include "subdiv2d/AssertAndError.h"
+
+// Library/third-party includes
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Standard includes
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace sensics {
+namespace subdiv2d {
+    MemoryResource::~MemoryResource() {}
+
+    namespace {
+        class NewDeleteResource : public MemoryResource {
+          public:
+            void* allocate(std::size_t bytes, std::size_t alignment) override {
+                // Without C++17 aligned new, this is all operator new promises.
+                Subdiv2D_Assert(alignment <= alignof(std::max_align_t));
+                return ::operator new(bytes);
+            }
+            void deallocate(void* p, std::size_t, std::size_t) override { ::operator delete(p); }
+        };
+    } // namespace
+
+    MemoryResource* getDefaultMemoryResource() {
+        static NewDeleteResource resource;
+        return &resource;
+    }
+
+    const std::size_t ArenaMemoryResource::DefaultChunkSize;
+
+    ArenaMemoryResource::ArenaMemoryResource(std::size_t chunkSize, MemoryResource* upstream)
+        : chunkSize_(std::max(chunkSize, std::size_t(1))),
+          upstream_(upstream ? upstream : getDefaultMemoryResource()) {}
+
+    ArenaMemoryResource::~ArenaMemoryResource() { release(); }
+
+    static inline char* alignUp(char* p, std::size_t alignment) {
+        const auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return p + ((alignment - addr % alignment) % alignment);
+    }
+
+    void* ArenaMemoryResource::allocate(std::size_t bytes, std::size_t alignment) {
+        char* p = alignUp(cur_, alignment);
+        if (!cur_ || p + bytes > end_) {
+            const auto size = std::max(chunkSize_, bytes + alignment);
+            Chunk chunk{upstream_->allocate(size, alignof(std::max_align_t)), size};
+            chunks_.push_back(chunk);
+            bytesHeld_ += size;
+            cur_ = static_cast<char*>(chunk.data);
+            end_ = cur_ + size;
+            p = alignUp(cur_, alignment);
+        }
+        cur_ = p + bytes;
+        return p;
+    }
+
+    void ArenaMemoryResource::deallocate(void*, std::size_t, std::size_t) {}
+
+    void ArenaMemoryResource::release() {
+        for (auto& chunk : chunks_) {
+            upstream_->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+        }
+        chunks_.clear();
+        cur_ = end_ = nullptr;
+        bytesHeld_ = 0;
+    }
+
+    const std::size_t HugePageMemoryResource::HugePageSize;
+
+#if defined(__linux__)
+    static inline std::size_t roundUpToHugePage(std::size_t bytes) {
+        return (bytes + HugePageMemoryResource::HugePageSize - 1) / HugePageMemoryResource::HugePageSize *
+               HugePageMemoryResource::HugePageSize;
+    }
+
+    void* HugePageMemoryResource::allocate(std::size_t bytes, std::size_t alignment) {
+        if (bytes < HugePageSize) {
+            return getDefaultMemoryResource()->allocate(bytes, alignment);
+        }
+        // mmap returns page-aligned memory, which satisfies any alignment a container will ask for.
+        void* p = mmap(nullptr, roundUpToHugePage(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        // Only advice: without transparent huge pages, this is just an mmap.
+        madvise(p, roundUpToHugePage(bytes), MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+
+    void HugePageMemoryResource::deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        if (bytes < HugePageSize) {
+            getDefaultMemoryResource()->deallocate(p, bytes, alignment);
+            return;
+        }
+        munmap(p, roundUpToHugePage(bytes));
+    }
+#else
+    void* HugePageMemoryResource::allocate(std::size_t bytes, std::size_t alignment) {
+        return getDefaultMemoryResource()->allocate(bytes, alignment);
+    }
+
+    void HugePageMemoryResource::deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        getDefaultMemoryResource()->deallocate(p, bytes, alignment);
+    }
+#endif
+} // namespace subdiv2d
+} // namespace sensics
@@ -0,0 +1,55 @@
+/** @file
+    @brief Header declaring the instruction-set-specific kernels behind the batch predicates.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_PredicateKernels_h_GUID_A8F3164E_2C7B_4D09_9E5A_61B0D7C42E3F
+#define INCLUDED_PredicateKernels_h_GUID_A8F3164E_2C7B_4D09_9E5A_61B0D7C42E3F
+
+// Internal Includes
+#include "Subdiv2DConfig.h"
+#include "subdiv2d/Types.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /// Each kernel handles as many whole blocks of its width as fit in n, and returns how many points it handled:
+        /// the remainder is left to the scalar code. Each lives in its own translation unit, built with the compiler
+        /// flags for its instruction set, and must only be called when the processor supports it.
+        ///
+        /// The sign kernels apply the floating-point filters of triangleOrientation() and isPtInCircle3(), and write
+        /// this for each result the filter cannot settle, to be redone with exact arithmetic.
+        static const int UndecidedSign = 2;
+
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+        std::size_t doubleTriangleAreaSSE2(Point2f const* a, Point2f const* b, Point2f const* c, double* out,
+                                           std::size_t n);
+        std::size_t triangleOrientationSSE2(Point2f const* a, Point2f const* b, Point2f const* c, int* out,
+                                            std::size_t n);
+        std::size_t isPtInCircle3SSE2(Point2f const* pt, Point2f const* a, Point2f const* b, Point2f const* c,
+                                      int* out, std::size_t n);
+        std::size_t doubleTriangleAreaAVX2(Point2f const* a, Point2f const* b, Point2f const* c, double* out,
+                                           std::size_t n);
+        std::size_t triangleOrientationAVX2(Point2f const* a, Point2f const* b, Point2f const* c, int* out,
+                                            std::size_t n);
+        std::size_t isPtInCircle3AVX2(Point2f const* pt, Point2f const* a, Point2f const* b, Point2f const* c,
+                                      int* out, std::size_t n);
+#endif
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_PredicateKernels_h_GUID_A8F3164E_2C7B_4D09_9E5A_61B0D7C42E3F
@@ -0,0 +1,296 @@
+/** @file
+    @brief Implementation of the exact arithmetic behind the predicates, and of the batch predicates: runtime
+    selection of the kernels, and the scalar code.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "subdiv2d/Predicates.h"
+#include "PredicateKernels.h"
+
+// Library/third-party includes
+#if defined(SUBDIV2D_HAVE_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace {
+        /* Exact arithmetic on "expansions": sums of doubles, stored smallest magnitude first, whose nonzero terms do
+           not overlap bitwise, so the sign of the sum is the sign of the last term. These are the routines of
+           Shewchuk's paper (see Types.h), with zero terms eliminated as they go. */
+
+        /// x + y == a + b exactly, with x the rounded sum.
+        inline void twoSum(double a, double b, double& x, double& y) {
+            x = a + b;
+            const double bVirtual = x - a;
+            const double aVirtual = x - bVirtual;
+            y = (a - aVirtual) + (b - bVirtual);
+        }
+
+        /// twoSum(), when |a| >= |b|.
+        inline void fastTwoSum(double a, double b, double& x, double& y) {
+            x = a + b;
+            y = b - (x - a);
+        }
+
+        /// x + y == a * b exactly, with x the rounded product.
+        inline void twoProduct(double a, double b, double& x, double& y) {
+            x = a * b;
+            y = std::fma(a, b, -x);
+        }
+
+        /// h = e + b, returning the length of h. h may be e.
+        int growExpansion(int eLen, double const* e, double b, double* h) {
+            int hLen = 0;
+            double q = b;
+            for (int i = 0; i < eLen; ++i) {
+                double sum, err;
+                twoSum(q, e[i], sum, err);
+                q = sum;
+                if (err != 0) {
+                    h[hLen++] = err;
+                }
+            }
+            if (q != 0 || hLen == 0) {
+                h[hLen++] = q;
+            }
+            return hLen;
+        }
+
+        /// h = e + f, returning the length of h. h may be e.
+        int sumExpansions(int eLen, double const* e, int fLen, double const* f, double* h) {
+            if (h != e) {
+                std::copy(e, e + eLen, h);
+            }
+            int hLen = eLen;
+            for (int i = 0; i < fLen; ++i) {
+                hLen = growExpansion(hLen, h, f[i], h);
+            }
+            return hLen;
+        }
+
+        /// h = e * b, returning the length of h, at most twice that of e.
+        int scaleExpansion(int eLen, double const* e, double b, double* h) {
+            int hLen = 0;
+            double q, err;
+            twoProduct(e[0], b, q, err);
+            if (err != 0) {
+                h[hLen++] = err;
+            }
+            for (int i = 1; i < eLen; ++i) {
+                double product, productErr, sum;
+                twoProduct(e[i], b, product, productErr);
+                twoSum(q, productErr, sum, err);
+                if (err != 0) {
+                    h[hLen++] = err;
+                }
+                fastTwoSum(product, sum, q, err);
+                if (err != 0) {
+                    h[hLen++] = err;
+                }
+            }
+            if (q != 0 || hLen == 0) {
+                h[hLen++] = q;
+            }
+            return hLen;
+        }
+
+        inline int expansionSign(int eLen, double const* e) { return (e[eLen - 1] > 0) - (e[eLen - 1] < 0); }
+
+        /// The orientation determinant of a, b, c as an expansion of at most 6 terms, returning its length. The
+        /// coordinates are floats, so each product of two is exact in double.
+        int orientationExpansion(Point2f a, Point2f b, Point2f c, double* h) {
+            const double terms[] = {(double)a.x * b.y, -(double)a.y * b.x, (double)b.x * c.y,
+                                    -(double)b.y * c.x, (double)c.x * a.y, -(double)c.y * a.x};
+            h[0] = terms[0];
+            int hLen = 1;
+            for (int i = 1; i < 6; ++i) {
+                hLen = growExpansion(hLen, h, terms[i], h);
+            }
+            return hLen;
+        }
+
+        /// sign * (x^2 + y^2 of p) * orientation(a, b, c) as an expansion of at most 24 terms, returning its length.
+        int liftedOrientationExpansion(Point2f p, Point2f a, Point2f b, Point2f c, double sign, double* h) {
+            double orientation[6];
+            const int orientationLen = orientationExpansion(a, b, c, orientation);
+            double lift[2];
+            twoSum(sign * p.x * p.x, sign * p.y * p.y, lift[1], lift[0]);
+            double high[12];
+            const int highLen = scaleExpansion(orientationLen, orientation, lift[1], high);
+            double low[12];
+            const int lowLen = scaleExpansion(orientationLen, orientation, lift[0], low);
+            return sumExpansions(lowLen, low, highLen, high, h);
+        }
+
+        std::atomic<std::uint64_t> orientationExactCount(0);
+        std::atomic<std::uint64_t> inCircleExactCount(0);
+    } // namespace
+
+    namespace detail {
+        int triangleOrientationExact(Point2f a, Point2f b, Point2f c) {
+            orientationExactCount.fetch_add(1, std::memory_order_relaxed);
+            double det[6];
+            return expansionSign(orientationExpansion(a, b, c, det), det);
+        }
+
+        int isPtInCircle3Exact(Point2f pt, Point2f a, Point2f b, Point2f c) {
+            inCircleExactCount.fetch_add(1, std::memory_order_relaxed);
+            // The 4x4 determinant with rows (x, y, x^2 + y^2, 1), expanded along the lifted column.
+            double det[96];
+            double term[24];
+            int detLen = liftedOrientationExpansion(a, b, c, pt, 1., det);
+            int termLen = liftedOrientationExpansion(b, a, c, pt, -1., term);
+            detLen = sumExpansions(detLen, det, termLen, term, det);
+            termLen = liftedOrientationExpansion(c, a, b, pt, 1., term);
+            detLen = sumExpansions(detLen, det, termLen, term, det);
+            termLen = liftedOrientationExpansion(pt, a, b, c, -1., term);
+            detLen = sumExpansions(detLen, det, termLen, term, det);
+            return expansionSign(detLen, det);
+        }
+    } // namespace detail
+
+    PredicateStats getPredicateStats() {
+        PredicateStats ret;
+        ret.orientationExact = orientationExactCount.load(std::memory_order_relaxed);
+        ret.inCircleExact = inCircleExactCount.load(std::memory_order_relaxed);
+        return ret;
+    }
+
+    void resetPredicateStats() {
+        orientationExactCount.store(0, std::memory_order_relaxed);
+        inCircleExactCount.store(0, std::memory_order_relaxed);
+    }
+
+    static SimdLevel detectSimdLevel() {
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuidex(info, 7, 0);
+            const bool avx2 = (info[1] & (1 << 5)) != 0;
+            __cpuid(info, 1);
+            // AVX2 also needs the OS to save the upper halves of the registers (OSXSAVE, and XCR0 bits 1 and 2).
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            if (avx2 && osxsave && (_xgetbv(0) & 6) == 6) {
+                return SimdLevel::AVX2;
+            }
+        }
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+#endif
+        // SSE2 is part of x86-64.
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    SimdLevel getSupportedSimdLevel() {
+        static const SimdLevel supported = detectSimdLevel();
+        return supported;
+    }
+
+    /// The selected level, or -1 if not yet selected (meaning the best supported).
+    static std::atomic<int> selectedSimdLevel(-1);
+
+    SimdLevel getSimdLevel() {
+        const int level = selectedSimdLevel.load(std::memory_order_relaxed);
+        return level < 0 ? getSupportedSimdLevel() : static_cast<SimdLevel>(level);
+    }
+
+    void setSimdLevel(SimdLevel level) {
+        level = std::min(level, getSupportedSimdLevel());
+        selectedSimdLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    void doubleTriangleAreaBatch(Point2f const* a, Point2f const* b, Point2f const* c, double* out, std::size_t n) {
+        std::size_t done = 0;
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+        switch (getSimdLevel()) {
+        case SimdLevel::AVX2:
+            done = detail::doubleTriangleAreaAVX2(a, b, c, out, n);
+            break;
+        case SimdLevel::SSE2:
+            done = detail::doubleTriangleAreaSSE2(a, b, c, out, n);
+            break;
+        case SimdLevel::Scalar:
+            break;
+        }
+#endif
+        for (std::size_t i = done; i < n; ++i) {
+            out[i] = doubleTriangleArea(a[i], b[i], c[i]);
+        }
+    }
+
+    /// Replaces the results the kernels left undecided with those of the exact arithmetic.
+    template <typename F> static void resolveUndecided(int* out, std::size_t n, F&& exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (out[i] == detail::UndecidedSign) {
+                out[i] = exact(i);
+            }
+        }
+    }
+
+    void isRightOfBatch(Point2f const* pt, Point2f const* a, Point2f const* b, int* out, std::size_t n) {
+        // As in isRightOf(): the orientation of pt, b, a.
+        std::size_t done = 0;
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+        switch (getSimdLevel()) {
+        case SimdLevel::AVX2:
+            done = detail::triangleOrientationAVX2(pt, b, a, out, n);
+            break;
+        case SimdLevel::SSE2:
+            done = detail::triangleOrientationSSE2(pt, b, a, out, n);
+            break;
+        case SimdLevel::Scalar:
+            break;
+        }
+#endif
+        resolveUndecided(out, done, [&](std::size_t i) { return detail::triangleOrientationExact(pt[i], b[i], a[i]); });
+        for (std::size_t i = done; i < n; ++i) {
+            out[i] = isRightOf(pt[i], a[i], b[i]);
+        }
+    }
+
+    void isPtInCircle3Batch(Point2f const* pt, Point2f const* a, Point2f const* b, Point2f const* c, int* out,
+                            std::size_t n) {
+        std::size_t done = 0;
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+        switch (getSimdLevel()) {
+        case SimdLevel::AVX2:
+            done = detail::isPtInCircle3AVX2(pt, a, b, c, out, n);
+            break;
+        case SimdLevel::SSE2:
+            done = detail::isPtInCircle3SSE2(pt, a, b, c, out, n);
+            break;
+        case SimdLevel::Scalar:
+            break;
+        }
+#endif
+        resolveUndecided(out, done, [&](std::size_t i) { return detail::isPtInCircle3Exact(pt[i], a[i], b[i], c[i]); });
+        for (std::size_t i = done; i < n; ++i) {
+            out[i] = isPtInCircle3(pt[i], a[i], b[i], c[i]);
+        }
+    }
+} // namespace subdiv2d
+} // namespace sensics
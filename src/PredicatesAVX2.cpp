@@ -0,0 +1,136 @@
+/** @file
+    @brief Implementation of the AVX2 batch predicate kernels. This file is built with AVX2 code generation enabled,
+    so nothing in it may run unless the processor has been checked for support.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "PredicateKernels.h"
+
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+
+// Library/third-party includes
+#include <immintrin.h>
+
+// Standard includes
+// - none
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        namespace {
+            /// Four points, converted to double and split into x and y.
+            struct Points4 {
+                __m256d x;
+                __m256d y;
+            };
+
+            inline Points4 load4(Point2f const* pts) {
+                const __m128 first = _mm_loadu_ps(&pts[0].x);
+                const __m128 second = _mm_loadu_ps(&pts[2].x);
+                return Points4{_mm256_cvtps_pd(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0))),
+                               _mm256_cvtps_pd(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)))};
+            }
+
+            /// Same operations, in the same order, as doubleTriangleArea(). (This file is built without floating-point
+            /// contraction, so these are not fused into FMA instructions that would round differently.)
+            inline __m256d area4(Points4 const& a, Points4 const& b, Points4 const& c) {
+                const __m256d lhs = _mm256_mul_pd(_mm256_sub_pd(b.x, a.x), _mm256_sub_pd(c.y, a.y));
+                const __m256d rhs = _mm256_mul_pd(_mm256_sub_pd(b.y, a.y), _mm256_sub_pd(c.x, a.x));
+                return _mm256_sub_pd(lhs, rhs);
+            }
+
+            inline __m256d abs4(__m256d v) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), v); }
+
+            /// Writes the sign of det for each lane, or UndecidedSign where |det| is below the error bound.
+            inline void storeSigns4(__m256d det, __m256d errorBound, int* out) {
+                const int decided = _mm256_movemask_pd(_mm256_cmp_pd(abs4(det), errorBound, _CMP_GE_OQ));
+                const int positive = _mm256_movemask_pd(_mm256_cmp_pd(det, _mm256_setzero_pd(), _CMP_GT_OQ));
+                const int negative = _mm256_movemask_pd(_mm256_cmp_pd(det, _mm256_setzero_pd(), _CMP_LT_OQ));
+                for (int lane = 0; lane < 4; ++lane) {
+                    out[lane] = ((decided >> lane) & 1) ? ((positive >> lane) & 1) - ((negative >> lane) & 1)
+                                                        : UndecidedSign;
+                }
+            }
+        } // namespace
+
+        std::size_t doubleTriangleAreaAVX2(Point2f const* a, Point2f const* b, Point2f const* c, double* out,
+                                           std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                _mm256_storeu_pd(out + i, area4(load4(a + i), load4(b + i), load4(c + i)));
+            }
+            return i;
+        }
+
+        std::size_t triangleOrientationAVX2(Point2f const* a, Point2f const* b, Point2f const* c, int* out,
+                                            std::size_t n) {
+            const __m256d errorBoundFactor = _mm256_set1_pd(OrientationErrorBound);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const auto a4 = load4(a + i);
+                const auto b4 = load4(b + i);
+                const auto c4 = load4(c + i);
+                // As in triangleOrientation().
+                const __m256d detLeft = _mm256_mul_pd(_mm256_sub_pd(b4.x, a4.x), _mm256_sub_pd(c4.y, a4.y));
+                const __m256d detRight = _mm256_mul_pd(_mm256_sub_pd(b4.y, a4.y), _mm256_sub_pd(c4.x, a4.x));
+                const __m256d det = _mm256_sub_pd(detLeft, detRight);
+                const __m256d errorBound =
+                    _mm256_mul_pd(errorBoundFactor, _mm256_add_pd(abs4(detLeft), abs4(detRight)));
+                storeSigns4(det, errorBound, out + i);
+            }
+            return i;
+        }
+
+        std::size_t isPtInCircle3AVX2(Point2f const* pt, Point2f const* a, Point2f const* b, Point2f const* c,
+                                      int* out, std::size_t n) {
+            const __m256d errorBoundFactor = _mm256_set1_pd(InCircleErrorBound);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                // As in isPtInCircle3().
+                const auto p4 = load4(pt + i);
+                const auto a4 = load4(a + i);
+                const auto b4 = load4(b + i);
+                const auto c4 = load4(c + i);
+                const __m256d adx = _mm256_sub_pd(a4.x, p4.x);
+                const __m256d ady = _mm256_sub_pd(a4.y, p4.y);
+                const __m256d bdx = _mm256_sub_pd(b4.x, p4.x);
+                const __m256d bdy = _mm256_sub_pd(b4.y, p4.y);
+                const __m256d cdx = _mm256_sub_pd(c4.x, p4.x);
+                const __m256d cdy = _mm256_sub_pd(c4.y, p4.y);
+
+                const __m256d bdxcdy = _mm256_mul_pd(bdx, cdy);
+                const __m256d cdxbdy = _mm256_mul_pd(cdx, bdy);
+                const __m256d alift = _mm256_add_pd(_mm256_mul_pd(adx, adx), _mm256_mul_pd(ady, ady));
+
+                const __m256d cdxady = _mm256_mul_pd(cdx, ady);
+                const __m256d adxcdy = _mm256_mul_pd(adx, cdy);
+                const __m256d blift = _mm256_add_pd(_mm256_mul_pd(bdx, bdx), _mm256_mul_pd(bdy, bdy));
+
+                const __m256d adxbdy = _mm256_mul_pd(adx, bdy);
+                const __m256d bdxady = _mm256_mul_pd(bdx, ady);
+                const __m256d clift = _mm256_add_pd(_mm256_mul_pd(cdx, cdx), _mm256_mul_pd(cdy, cdy));
+
+                __m256d det = _mm256_mul_pd(alift, _mm256_sub_pd(bdxcdy, cdxbdy));
+                det = _mm256_add_pd(det, _mm256_mul_pd(blift, _mm256_sub_pd(cdxady, adxcdy)));
+                det = _mm256_add_pd(det, _mm256_mul_pd(clift, _mm256_sub_pd(adxbdy, bdxady)));
+                __m256d permanent = _mm256_mul_pd(_mm256_add_pd(abs4(bdxcdy), abs4(cdxbdy)), alift);
+                permanent = _mm256_add_pd(permanent, _mm256_mul_pd(_mm256_add_pd(abs4(cdxady), abs4(adxcdy)), blift));
+                permanent = _mm256_add_pd(permanent, _mm256_mul_pd(_mm256_add_pd(abs4(adxbdy), abs4(bdxady)), clift));
+                storeSigns4(det, _mm256_mul_pd(errorBoundFactor, permanent), out + i);
+            }
+            return i;
+        }
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+
+#endif // SUBDIV2D_HAVE_X86_SIMD
@@ -0,0 +1,135 @@
+/** @file
+    @brief Implementation of the SSE2 batch predicate kernels.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "PredicateKernels.h"
+
+#ifdef SUBDIV2D_HAVE_X86_SIMD
+
+// Library/third-party includes
+#include <emmintrin.h>
+
+// Standard includes
+// - none
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        namespace {
+            static_assert(sizeof(Point2f) == 2 * sizeof(float), "Point2f must be two packed floats");
+
+            /// Two points, converted to double and split into x and y.
+            struct Points2 {
+                __m128d x;
+                __m128d y;
+            };
+
+            inline Points2 load2(Point2f const* pts) {
+                const __m128 xy = _mm_loadu_ps(&pts->x);
+                const __m128d first = _mm_cvtps_pd(xy);
+                const __m128d second = _mm_cvtps_pd(_mm_movehl_ps(xy, xy));
+                return Points2{_mm_unpacklo_pd(first, second), _mm_unpackhi_pd(first, second)};
+            }
+
+            /// Same operations, in the same order, as doubleTriangleArea().
+            inline __m128d area2(Points2 const& a, Points2 const& b, Points2 const& c) {
+                const __m128d lhs = _mm_mul_pd(_mm_sub_pd(b.x, a.x), _mm_sub_pd(c.y, a.y));
+                const __m128d rhs = _mm_mul_pd(_mm_sub_pd(b.y, a.y), _mm_sub_pd(c.x, a.x));
+                return _mm_sub_pd(lhs, rhs);
+            }
+
+            inline __m128d abs2(__m128d v) { return _mm_andnot_pd(_mm_set1_pd(-0.), v); }
+
+            /// Writes the sign of det for each lane, or UndecidedSign where |det| is below the error bound.
+            inline void storeSigns2(__m128d det, __m128d errorBound, int* out) {
+                const int decided = _mm_movemask_pd(_mm_cmpge_pd(abs2(det), errorBound));
+                const int positive = _mm_movemask_pd(_mm_cmpgt_pd(det, _mm_setzero_pd()));
+                const int negative = _mm_movemask_pd(_mm_cmplt_pd(det, _mm_setzero_pd()));
+                for (int lane = 0; lane < 2; ++lane) {
+                    out[lane] = ((decided >> lane) & 1) ? ((positive >> lane) & 1) - ((negative >> lane) & 1)
+                                                        : UndecidedSign;
+                }
+            }
+        } // namespace
+
+        std::size_t doubleTriangleAreaSSE2(Point2f const* a, Point2f const* b, Point2f const* c, double* out,
+                                           std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                _mm_storeu_pd(out + i, area2(load2(a + i), load2(b + i), load2(c + i)));
+            }
+            return i;
+        }
+
+        std::size_t triangleOrientationSSE2(Point2f const* a, Point2f const* b, Point2f const* c, int* out,
+                                            std::size_t n) {
+            const __m128d errorBoundFactor = _mm_set1_pd(OrientationErrorBound);
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const auto a2 = load2(a + i);
+                const auto b2 = load2(b + i);
+                const auto c2 = load2(c + i);
+                // As in triangleOrientation().
+                const __m128d detLeft = _mm_mul_pd(_mm_sub_pd(b2.x, a2.x), _mm_sub_pd(c2.y, a2.y));
+                const __m128d detRight = _mm_mul_pd(_mm_sub_pd(b2.y, a2.y), _mm_sub_pd(c2.x, a2.x));
+                const __m128d det = _mm_sub_pd(detLeft, detRight);
+                const __m128d errorBound = _mm_mul_pd(errorBoundFactor, _mm_add_pd(abs2(detLeft), abs2(detRight)));
+                storeSigns2(det, errorBound, out + i);
+            }
+            return i;
+        }
+
+        std::size_t isPtInCircle3SSE2(Point2f const* pt, Point2f const* a, Point2f const* b, Point2f const* c,
+                                      int* out, std::size_t n) {
+            const __m128d errorBoundFactor = _mm_set1_pd(InCircleErrorBound);
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                // As in isPtInCircle3().
+                const auto p2 = load2(pt + i);
+                const auto a2 = load2(a + i);
+                const auto b2 = load2(b + i);
+                const auto c2 = load2(c + i);
+                const __m128d adx = _mm_sub_pd(a2.x, p2.x);
+                const __m128d ady = _mm_sub_pd(a2.y, p2.y);
+                const __m128d bdx = _mm_sub_pd(b2.x, p2.x);
+                const __m128d bdy = _mm_sub_pd(b2.y, p2.y);
+                const __m128d cdx = _mm_sub_pd(c2.x, p2.x);
+                const __m128d cdy = _mm_sub_pd(c2.y, p2.y);
+
+                const __m128d bdxcdy = _mm_mul_pd(bdx, cdy);
+                const __m128d cdxbdy = _mm_mul_pd(cdx, bdy);
+                const __m128d alift = _mm_add_pd(_mm_mul_pd(adx, adx), _mm_mul_pd(ady, ady));
+
+                const __m128d cdxady = _mm_mul_pd(cdx, ady);
+                const __m128d adxcdy = _mm_mul_pd(adx, cdy);
+                const __m128d blift = _mm_add_pd(_mm_mul_pd(bdx, bdx), _mm_mul_pd(bdy, bdy));
+
+                const __m128d adxbdy = _mm_mul_pd(adx, bdy);
+                const __m128d bdxady = _mm_mul_pd(bdx, ady);
+                const __m128d clift = _mm_add_pd(_mm_mul_pd(cdx, cdx), _mm_mul_pd(cdy, cdy));
+
+                __m128d det = _mm_mul_pd(alift, _mm_sub_pd(bdxcdy, cdxbdy));
+                det = _mm_add_pd(det, _mm_mul_pd(blift, _mm_sub_pd(cdxady, adxcdy)));
+                det = _mm_add_pd(det, _mm_mul_pd(clift, _mm_sub_pd(adxbdy, bdxady)));
+                __m128d permanent = _mm_mul_pd(_mm_add_pd(abs2(bdxcdy), abs2(cdxbdy)), alift);
+                permanent = _mm_add_pd(permanent, _mm_mul_pd(_mm_add_pd(abs2(cdxady), abs2(adxcdy)), blift));
+                permanent = _mm_add_pd(permanent, _mm_mul_pd(_mm_add_pd(abs2(adxbdy), abs2(bdxady)), clift));
+                storeSigns2(det, _mm_mul_pd(errorBoundFactor, permanent), out + i);
+            }
+            return i;
+        }
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+
+#endif // SUBDIV2D_HAVE_X86_SIMD
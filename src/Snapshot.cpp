@@ -0,0 +1,337 @@
+/** @file
+    @brief Implementation of the binary snapshot files of Subdiv2D::save() and Subdiv2D::load().
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "Snapshot.h"
+#include "subdiv2d/AssertAndError.h"
+#include "subdiv2d/Subdivision2D.h"
+
+// Library/third-party includes
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Standard includes
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        namespace {
+            const char Magic[8] = {'S', 'U', 'B', 'D', 'I', 'V', '2', 'D'};
+            /// Written in the byte order of the machine writing the file, so the reader can tell if it differs.
+            const std::uint32_t ByteOrderTag = 0x01020304;
+            const std::uint32_t ByteOrderTagSwapped = 0x04030201;
+            const std::uint32_t Version = 1;
+            /// Sections start on a cache line, which is more than any element needs.
+            const std::size_t SectionAlignment = 64;
+
+            struct FileHeader {
+                char magic[8];
+                std::uint32_t byteOrder;
+                std::uint32_t version;
+                std::uint32_t numSections;
+                std::uint32_t reserved;
+            };
+
+            inline std::size_t alignSection(std::size_t offset) {
+                return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+            }
+        } // namespace
+
+        void SnapshotWriter::add(SnapshotSection section, void const* data, std::size_t elementSize,
+                                 std::size_t count) {
+            sections_.push_back(Section{section, data, elementSize, count});
+        }
+
+        void SnapshotWriter::addCopy(SnapshotSection section, void const* data, std::size_t elementSize,
+                                     std::size_t count) {
+            auto bytes = static_cast<char const*>(data);
+            copies_.emplace_back(bytes, bytes + elementSize * count);
+            add(section, copies_.back().data(), elementSize, count);
+        }
+
+        void SnapshotWriter::write(std::string const& path) const {
+            using Entry = SnapshotReader::Entry;
+            FileHeader header;
+            std::memcpy(header.magic, Magic, sizeof(Magic));
+            header.byteOrder = ByteOrderTag;
+            header.version = Version;
+            header.numSections = static_cast<std::uint32_t>(sections_.size());
+            header.reserved = 0;
+
+            std::vector<Entry> entries;
+            std::size_t offset = sizeof(FileHeader) + sections_.size() * sizeof(Entry);
+            for (auto& section : sections_) {
+                offset = alignSection(offset);
+                entries.push_back(Entry{static_cast<std::uint32_t>(section.section),
+                                        static_cast<std::uint32_t>(section.elementSize), offset, section.count});
+                offset += section.elementSize * section.count;
+            }
+
+            const auto tempPath = path + ".tmp";
+            std::ofstream os(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+            if (!os) {
+                Subdiv2D_Error(Error::StsError, "Could not open the snapshot file for writing");
+            }
+            os.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            os.write(reinterpret_cast<char const*>(entries.data()), entries.size() * sizeof(Entry));
+            const char padding[SectionAlignment] = {};
+            std::size_t written = sizeof(FileHeader) + entries.size() * sizeof(Entry);
+            for (std::size_t i = 0; i < sections_.size(); ++i) {
+                os.write(padding, entries[i].offset - written);
+                const auto bytes = sections_[i].elementSize * sections_[i].count;
+                os.write(static_cast<char const*>(sections_[i].data), bytes);
+                written = entries[i].offset + bytes;
+            }
+            os.close();
+            if (!os) {
+                std::remove(tempPath.c_str());
+                Subdiv2D_Error(Error::StsError, "Could not write the snapshot file");
+            }
+            if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+                std::remove(tempPath.c_str());
+                Subdiv2D_Error(Error::StsError, "Could not replace the snapshot file");
+            }
+        }
+
+#if defined(__linux__)
+        static std::shared_ptr<void> mapFile(std::string const& path, std::size_t& size) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                Subdiv2D_Error(Error::StsError, "Could not open the snapshot file");
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                close(fd);
+                Subdiv2D_Error(Error::StsParseError, "Snapshot file is empty or unreadable");
+            }
+            size = static_cast<std::size_t>(st.st_size);
+            // Private and writable: pages are shared with the page cache until a subdivision modifies them.
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) {
+                Subdiv2D_Error(Error::StsError, "Could not map the snapshot file");
+            }
+            const auto mappedSize = size;
+            return std::shared_ptr<void>(p, [mappedSize](void* p) { munmap(p, mappedSize); });
+        }
+#else
+        static std::shared_ptr<void> mapFile(std::string const& path, std::size_t& size) {
+            std::ifstream is(path.c_str(), std::ios::binary | std::ios::ate);
+            if (!is) {
+                Subdiv2D_Error(Error::StsError, "Could not open the snapshot file");
+            }
+            size = static_cast<std::size_t>(is.tellg());
+            if (size == 0) {
+                Subdiv2D_Error(Error::StsParseError, "Snapshot file is empty or unreadable");
+            }
+            std::shared_ptr<void> buffer(::operator new(size), [](void* p) { ::operator delete(p); });
+            is.seekg(0);
+            if (!is.read(static_cast<char*>(buffer.get()), size)) {
+                Subdiv2D_Error(Error::StsError, "Could not read the snapshot file");
+            }
+            return buffer;
+        }
+#endif
+
+        SnapshotReader::SnapshotReader(std::string const& path) : region_(mapFile(path, size_)) {
+            auto base = static_cast<char const*>(region_.get());
+            FileHeader header;
+            if (size_ < sizeof(header)) {
+                Subdiv2D_Error(Error::StsParseError, "Not a snapshot file");
+            }
+            std::memcpy(&header, base, sizeof(header));
+            if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+                Subdiv2D_Error(Error::StsParseError, "Not a snapshot file");
+            }
+            if (header.byteOrder == ByteOrderTagSwapped) {
+                Subdiv2D_Error(Error::StsUnsupportedFormat, "Snapshot was written with the other byte order");
+            }
+            if (header.byteOrder != ByteOrderTag) {
+                Subdiv2D_Error(Error::StsParseError, "Not a snapshot file");
+            }
+            if (header.version != Version) {
+                Subdiv2D_Error(Error::StsUnsupportedFormat, "Snapshot is of an unsupported version");
+            }
+            const auto tableEnd = sizeof(header) + std::size_t(header.numSections) * sizeof(Entry);
+            if (header.numSections > size_ / sizeof(Entry) || tableEnd > size_) {
+                Subdiv2D_Error(Error::StsParseError, "Snapshot file is truncated");
+            }
+            entries_.resize(header.numSections);
+            std::memcpy(entries_.data(), base + sizeof(header), entries_.size() * sizeof(Entry));
+            for (auto& entry : entries_) {
+                const auto available = entry.offset < size_ ? size_ - entry.offset : 0;
+                if (entry.offset < tableEnd || entry.offset % SectionAlignment != 0 ||
+                    (entry.elementSize && entry.count > available / entry.elementSize)) {
+                    Subdiv2D_Error(Error::StsParseError, "Snapshot file is truncated");
+                }
+            }
+        }
+
+        SnapshotReader::Entry const* SnapshotReader::find(SnapshotSection section) const {
+            for (auto& entry : entries_) {
+                if (entry.section == static_cast<std::uint32_t>(section)) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        bool SnapshotReader::has(SnapshotSection section) const { return find(section) != nullptr; }
+
+        void* SnapshotReader::get(SnapshotSection section, std::size_t elementSize, std::size_t& count) const {
+            auto entry = find(section);
+            if (!entry) {
+                Subdiv2D_Error(Error::StsParseError, "Snapshot is missing a section");
+            }
+            if (entry->elementSize != elementSize) {
+                Subdiv2D_Error(Error::StsUnsupportedFormat, "Snapshot was written with a different data layout");
+            }
+            count = static_cast<std::size_t>(entry->count);
+            return static_cast<char*>(region_.get()) + entry->offset;
+        }
+    } // namespace detail
+
+    namespace {
+        /// The Subdiv section.
+        struct SubdivState {
+            enum Flags : std::uint32_t { HasDual = 1, ValidGeometry = 2, GrowableBounds = 4 };
+            std::uint32_t flags;
+            std::int32_t freeQEdge;
+            std::int32_t freePoint;
+            std::int32_t recentEdge;
+            float bounds[4];
+        };
+    } // namespace
+
+    void Subdiv2D::save(std::string const& path) const {
+        detail::SnapshotWriter writer;
+        writeSnapshot(writer);
+        writer.write(path);
+    }
+
+    Subdiv2D Subdiv2D::load(std::string const& path, MemoryResource* resource) {
+        Subdiv2D ret;
+        ret.setMemoryResource(resource);
+        ret.readSnapshot(detail::SnapshotReader(path));
+        return ret;
+    }
+
+    void Subdiv2D::writeSnapshot(detail::SnapshotWriter& writer) const {
+        SubdivState state;
+        state.flags = 0;
+        if (qedges.hasDual()) {
+            state.flags |= SubdivState::HasDual;
+        }
+        if (validGeometry) {
+            state.flags |= SubdivState::ValidGeometry;
+        }
+        if (growableBounds) {
+            state.flags |= SubdivState::GrowableBounds;
+        }
+        state.freeQEdge = freeQEdge.get();
+        state.freePoint = freePoint.get();
+        state.recentEdge = recentEdge.get();
+        state.bounds[0] = topLeft.x;
+        state.bounds[1] = topLeft.y;
+        state.bounds[2] = bottomRight.x;
+        state.bounds[3] = bottomRight.y;
+        writer.addCopy(detail::SnapshotSection::Subdiv, &state, sizeof(state), 1);
+        writer.add(detail::SnapshotSection::Vertices, vtx.data(), sizeof(Vertex), vtx.size());
+        writer.add(detail::SnapshotSection::PrimalEdges, qedges.primal_.data(), sizeof(QuadEdgeStorage::Primal),
+                   qedges.primal_.size());
+        if (qedges.hasDual()) {
+            writer.add(detail::SnapshotSection::DualEdges, qedges.dual_.data(), sizeof(QuadEdgeStorage::PointPair),
+                       qedges.dual_.size());
+        }
+    }
+
+    void Subdiv2D::readSnapshot(detail::SnapshotReader const& reader) {
+        std::size_t count = 0;
+        SubdivState state;
+        std::memcpy(&state, reader.get(detail::SnapshotSection::Subdiv, sizeof(state), count), sizeof(state));
+        if (count != 1) {
+            Subdiv2D_Error(Error::StsParseError, "Snapshot is corrupt");
+        }
+
+        // Leaves the subdivision empty, with its memory resource: the arrays then borrow the snapshot's contents.
+        setMemoryResource(getMemoryResource());
+        const bool hasDual = (state.flags & SubdivState::HasDual) != 0;
+        qedges.setHasDual(hasDual);
+        auto const& keepAlive = reader.keepAlive();
+        auto vertices = static_cast<Vertex*>(reader.get(detail::SnapshotSection::Vertices, sizeof(Vertex), count));
+        vtx.borrow(vertices, count, keepAlive);
+        auto primal = static_cast<QuadEdgeStorage::Primal*>(
+            reader.get(detail::SnapshotSection::PrimalEdges, sizeof(QuadEdgeStorage::Primal), count));
+        qedges.primal_.borrow(primal, count, keepAlive);
+        if (hasDual) {
+            auto dual = static_cast<QuadEdgeStorage::PointPair*>(
+                reader.get(detail::SnapshotSection::DualEdges, sizeof(QuadEdgeStorage::PointPair), count));
+            qedges.dual_.borrow(dual, count, keepAlive);
+        }
+
+        // Every index that walks and the free lists follow, so that a corrupt or mismatched file cannot send them out
+        // of bounds. (Whether the edges make a triangulation is not checked: that is checkSubdiv().)
+        const auto numVertices = vtx.size();
+        const auto numQEdges = qedges.size();
+        const auto numEdges = numQEdges * 4;
+        const auto inRange = [](int index, std::size_t size) {
+            return index >= 0 && static_cast<std::size_t>(index) < size;
+        };
+        bool valid = numVertices >= 4 && (!hasDual || qedges.dual_.size() == numQEdges) &&
+                     inRange(state.recentEdge, numEdges) && inRange(state.freeQEdge, numQEdges) &&
+                     inRange(state.freePoint, numVertices);
+        for (std::size_t i = 0; valid && i < numVertices; ++i) {
+            // A free vertex links to the next free one in place of its first edge.
+            valid = inRange(vtx[i].firstEdge.get(), vtx[i].isfree() ? numVertices : numEdges);
+        }
+        for (std::size_t i = 0; valid && i < numQEdges; ++i) {
+            if (qedges.isfree(i)) {
+                valid = inRange(qedges.nextFree(i), numQEdges);
+                continue;
+            }
+            for (auto next : qedges.next(i)) {
+                valid = valid && inRange(next, numEdges);
+            }
+            for (auto vertex : qedges.primal(i)) {
+                valid = valid && inRange(vertex.get(), numVertices);
+            }
+            if (hasDual) {
+                for (auto vertex : qedges.dual(i)) {
+                    valid = valid && inRange(vertex.get(), numVertices);
+                }
+            }
+        }
+        if (!valid) {
+            Subdiv2D_Error(Error::StsParseError, "Snapshot is corrupt");
+        }
+        freeQEdge = QuadEdgeId(state.freeQEdge);
+        freePoint = VertexId(state.freePoint);
+        recentEdge = EdgeId(state.recentEdge);
+        validGeometry = (state.flags & SubdivState::ValidGeometry) != 0;
+        growableBounds = (state.flags & SubdivState::GrowableBounds) != 0;
+        topLeft = Point2f(state.bounds[0], state.bounds[1]);
+        bottomRight = Point2f(state.bounds[2], state.bounds[3]);
+        faces.clear();
+        edgeFaces.clear();
+        validFaces = false;
+    }
+} // namespace subdiv2d
+} // namespace sensics
@@ -0,0 +1,108 @@
+/** @file
+    @brief Header for reading and writing the binary snapshot files of Subdiv2D::save() and Subdiv2D::load().
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_Snapshot_h_GUID_3F8C2A6D_9E14_4B57_8D0A_E6B1C47F5A29
+#define INCLUDED_Snapshot_h_GUID_3F8C2A6D_9E14_4B57_8D0A_E6B1C47F5A29
+
+// Internal Includes
+// - none
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /** The sections a snapshot may contain. A snapshot file is a header, a table of sections, and then the raw
+        contents of each section (an array of fixed-size elements), each aligned so it may be used in place once the
+        file is mapped into memory. */
+        enum class SnapshotSection : std::uint32_t {
+            /// Everything about a subdivision other than its arrays: a single element.
+            Subdiv = 1,
+            Vertices = 2,
+            /// The links and primal points of the quad-edges.
+            PrimalEdges = 3,
+            /// The dual (Voronoi) points of the quad-edges, if the subdivision keeps them.
+            DualEdges = 4,
+            /// SubdivContainer: whether each value is set, one byte each.
+            ValuesSet = 5,
+            /// SubdivContainer: the values.
+            Values = 6,
+            /// Of a checkpoint: the sequence number of the first change the journal has and the snapshot does not.
+            JournalSequence = 7
+        };
+
+        /// Collects sections, then writes them to a file: the data is not copied, so must stay valid until write().
+        class SnapshotWriter {
+          public:
+            void add(SnapshotSection section, void const* data, std::size_t elementSize, std::size_t count);
+            /// As add(), but copies the data: for small sections built on the fly.
+            void addCopy(SnapshotSection section, void const* data, std::size_t elementSize, std::size_t count);
+            /// Writes to a temporary file next to path, then renames it over path: so the old file stays whole until
+            /// the new one is, and sections borrowed from a mapping of the old file stay valid while they are written.
+            /// Raises a runtime error if the file cannot be written.
+            void write(std::string const& path) const;
+
+          private:
+            struct Section {
+                SnapshotSection section;
+                void const* data;
+                std::size_t elementSize;
+                std::size_t count;
+            };
+            std::vector<Section> sections_;
+            std::deque<std::vector<char> > copies_;
+        };
+
+        /// Opens a snapshot file, checking its header and table of sections, and makes its contents available in
+        /// memory: mapped (privately, so writes are copy-on-write) where supported, otherwise read in whole.
+        class SnapshotReader {
+          public:
+            /// Raises a runtime error if the file cannot be read or is not a snapshot from a compatible build.
+            explicit SnapshotReader(std::string const& path);
+
+            bool has(SnapshotSection section) const;
+            /// Returns the contents of a section, and sets count to its number of elements. Raises a runtime error if
+            /// the section is missing, or its elements are not of the expected size.
+            void* get(SnapshotSection section, std::size_t elementSize, std::size_t& count) const;
+
+            /// Keeps the contents alive: the pointers returned by get() remain valid as long as a copy of this is held.
+            std::shared_ptr<void> const& keepAlive() const { return region_; }
+
+          private:
+            struct Entry {
+                std::uint32_t section;
+                std::uint32_t elementSize;
+                std::uint64_t offset;
+                std::uint64_t count;
+            };
+            Entry const* find(SnapshotSection section) const;
+            /// Set by the initializer of region_, so declared first.
+            std::size_t size_ = 0;
+            std::shared_ptr<void> region_;
+            std::vector<Entry> entries_;
+
+            friend class SnapshotWriter;
+        };
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_Snapshot_h_GUID_3F8C2A6D_9E14_4B57_8D0A_E6B1C47F5A29
@@ -0,0 +1,130 @@
+/** @file
+    @brief Implementation of space-filling-curve orderings of point sets.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "SpatialSort.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        static const std::uint32_t HilbertGridSize = 1u << 16;
+
+        std::uint32_t hilbertIndex(std::uint32_t x, std::uint32_t y) {
+            std::uint32_t d = 0;
+            for (std::uint32_t s = HilbertGridSize / 2; s > 0; s /= 2) {
+                const std::uint32_t rx = (x & s) > 0;
+                const std::uint32_t ry = (y & s) > 0;
+                d += s * s * ((3 * rx) ^ ry);
+                // rotate the quadrant so the sub-curve is in canonical orientation
+                if (ry == 0) {
+                    if (rx == 1) {
+                        x = HilbertGridSize - 1 - x;
+                        y = HilbertGridSize - 1 - y;
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return d;
+        }
+
+        HilbertKeyMaker::HilbertKeyMaker(Point2f topLeft, Point2f bottomRight) : origin_(topLeft) {
+            const double width = (double)bottomRight.x - topLeft.x;
+            const double height = (double)bottomRight.y - topLeft.y;
+            scaleX_ = width > 0 ? (HilbertGridSize - 1) / width : 0.;
+            scaleY_ = height > 0 ? (HilbertGridSize - 1) / height : 0.;
+        }
+
+        static inline std::uint32_t toGridCoord(double val) {
+            if (!(val > 0.)) {
+                return 0;
+            }
+            if (val >= HilbertGridSize - 1) {
+                return HilbertGridSize - 1;
+            }
+            return static_cast<std::uint32_t>(val);
+        }
+
+        std::uint32_t HilbertKeyMaker::operator()(Point2f const& pt) const {
+            return hilbertIndex(toGridCoord(((double)pt.x - origin_.x) * scaleX_),
+                                toGridCoord(((double)pt.y - origin_.y) * scaleY_));
+        }
+
+        /// Sorts the index range [first, last) by Hilbert key, packing key and index into one integer so the sort
+        /// moves plain 64-bit values.
+        static void sortRangeByHilbertKey(std::size_t* first, std::size_t* last, Point2f const* pts,
+                                          HilbertKeyMaker const& keyMaker, std::vector<std::uint64_t>& scratch) {
+            scratch.clear();
+            for (auto it = first; it != last; ++it) {
+                scratch.push_back((std::uint64_t(keyMaker(pts[*it])) << 32) | std::uint64_t(*it));
+            }
+            std::sort(scratch.begin(), scratch.end());
+            for (auto packed : scratch) {
+                *first = static_cast<std::size_t>(packed & 0xffffffffu);
+                ++first;
+            }
+        }
+
+        std::vector<std::size_t> hilbertOrder(Point2f const* pts, std::size_t n, Point2f topLeft,
+                                              Point2f bottomRight) {
+            Subdiv2D_Assert(n <= 0xffffffffu);
+            std::vector<std::size_t> order(n);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            if (n < 2) {
+                return order;
+            }
+            std::vector<std::uint64_t> scratch;
+            scratch.reserve(n);
+            sortRangeByHilbertKey(order.data(), order.data() + n, pts, HilbertKeyMaker(topLeft, bottomRight),
+                                  scratch);
+            return order;
+        }
+
+        /// Rounds smaller than this are not split further.
+        static const std::size_t MinBrioRoundSize = 64;
+
+        std::vector<std::size_t> brioOrder(Point2f const* pts, std::size_t n, Point2f topLeft, Point2f bottomRight) {
+            Subdiv2D_Assert(n <= 0xffffffffu);
+            std::vector<std::size_t> order(n);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            if (n < 2) {
+                return order;
+            }
+            // Fixed seed: the insertion order (and so the result in the presence of cocircular ties) is reproducible.
+            std::mt19937 rng(0x5eed);
+            std::shuffle(order.begin(), order.end(), rng);
+
+            HilbertKeyMaker keyMaker(topLeft, bottomRight);
+            std::vector<std::uint64_t> scratch;
+            scratch.reserve(n);
+            // Each round is the second half of what remains, so the rounds double in size toward the end.
+            std::size_t end = n;
+            while (end > MinBrioRoundSize) {
+                const std::size_t begin = end / 2;
+                sortRangeByHilbertKey(order.data() + begin, order.data() + end, pts, keyMaker, scratch);
+                end = begin;
+            }
+            sortRangeByHilbertKey(order.data(), order.data() + end, pts, keyMaker, scratch);
+            return order;
+        }
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
@@ -0,0 +1,58 @@
+/** @file
+    @brief Header providing space-filling-curve orderings of point sets, used to keep successive point location walks
+    short.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+#ifndef INCLUDED_SpatialSort_h_GUID_8C1D5E2A_6F4B_4E0C_9A37_2B5D0E41C7F3
+#define INCLUDED_SpatialSort_h_GUID_8C1D5E2A_6F4B_4E0C_9A37_2B5D0E41C7F3
+
+// Internal Includes
+#include "subdiv2d/Types.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /// Computes the distance along a Hilbert curve of the cell (x, y) in a 2^16 by 2^16 grid.
+        std::uint32_t hilbertIndex(std::uint32_t x, std::uint32_t y);
+
+        /// Maps points within a bounding rect to Hilbert curve keys. Points outside the rect are clamped to its edge.
+        class HilbertKeyMaker {
+          public:
+            HilbertKeyMaker(Point2f topLeft, Point2f bottomRight);
+            std::uint32_t operator()(Point2f const& pt) const;
+
+          private:
+            Point2f origin_;
+            double scaleX_;
+            double scaleY_;
+        };
+
+        /// Returns the indices [0, n) ordered along a Hilbert curve over the given rect.
+        std::vector<std::size_t> hilbertOrder(Point2f const* pts, std::size_t n, Point2f topLeft,
+                                              Point2f bottomRight);
+
+        /// Returns the indices [0, n) in "biased randomized insertion order": a deterministic shuffle split into rounds
+        /// of doubling size, with each round ordered along a Hilbert curve. This keeps both the expected number of
+        /// flips (from the randomization) and the length of each locate walk (from the curve) small.
+        std::vector<std::size_t> brioOrder(Point2f const* pts, std::size_t n, Point2f topLeft, Point2f bottomRight);
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+#endif // INCLUDED_SpatialSort_h_GUID_8C1D5E2A_6F4B_4E0C_9A37_2B5D0E41C7F3
@@ -13,18 +13,22 @@
 
 // Internal Includes
 #include <subdiv2d/SubdivContainer.h>
+#include "Journal.h"
+#include "Snapshot.h"
+#include "subdiv2d/AssertAndError.h"
 
 // Library/third-party includes
 // - none
 
 // Standard includes
-// - none
+#include <cstdint>
+#include <cstring>
 
 namespace sensics {
 namespace subdiv2d {
     SubdivContainerBase::SubdivContainerBase(Rect bounds) : subdiv_(bounds) {}
 
-    VertexStatus SubdivContainerBase::categorizeVertex(VertexId id) {
+    VertexStatus SubdivContainerBase::categorizeVertex(VertexId id) const {
         if (!id.valid()) {
             return VertexStatus::Unpopulated;
         }
@@ -34,7 +38,7 @@ namespace subdiv2d {
         return VertexStatus::AdditionalVertex;
     }
 
-    VertexValueId SubdivContainerBase::getValueId(VertexId id) {
+    VertexValueId SubdivContainerBase::getValueId(VertexId id) const {
         if (!id.valid() || id.get() < NumDummyVertices) {
             return InvalidVertexValueId;
         }
@@ -58,16 +62,15 @@ namespace subdiv2d {
         return ret;
     }
 
-    SubdivContainerBase::BaseVector SubdivContainerBase::locateNeighborhood(Point2f const& pt) {
+    SubdivContainerBase::BaseVector SubdivContainerBase::locateNeighborhood(Point2f const& pt,
+                                                                            LocateCursor* cursor) const {
         BaseVector ret;
 #if 0
-        auto vertexIds = subdiv_.locateVertexIdsArray(pt);
+        auto vertexIds = subdiv_.locateVertexIdsArray(pt, cursor);
 #else
-        auto vertexIds = subdiv_.locateVertexIdsForInterpolationArray(pt);
+        auto vertexIds = subdiv_.locateVertexIdsForInterpolationArray(pt, cursor);
 #endif
-        std::cout << "Vertices ";
         for (auto v : vertexIds) {
-            std::cout << " " << v;
             if (!v) {
                 /// invalid vertex id
                 continue;
@@ -75,11 +78,10 @@ namespace subdiv2d {
             ret.push_back(ContainerVertexBase());
             populate(v, ret.back());
         }
-        std::cout << std::endl;
         return ret;
     }
 
-    void SubdivContainerBase::populate(VertexId id, ContainerVertexBase& data) {
+    void SubdivContainerBase::populate(VertexId id, ContainerVertexBase& data) const {
         data.status = categorizeVertex(id);
         data.id = id;
         if (data.status != VertexStatus::Unpopulated) {
@@ -91,19 +93,27 @@ namespace subdiv2d {
         }
     }
 
-    VertexValueId SubdivContainerBase::lookup(Point2f const& pt) {
+    VertexValueId SubdivContainerBase::lookup(Point2f const& pt, LocateCursor* cursor) const {
         if (subdiv_.empty()) {
             return InvalidVertexValueId;
         }
         auto edge = InvalidEdge;
         auto vertex = InvalidVertex;
-        const auto status = subdiv_.locate(pt, edge, vertex);
+        const auto status = subdiv_.locate(pt, edge, vertex, cursor);
         if (status == PtLoc::PTLOC_VERTEX) {
             return getValueId(vertex);
         }
         return InvalidVertexValueId;
     }
 
+    void SubdivContainerBase::setGrowableBounds(bool growable) { subdiv_.setGrowableBounds(growable); }
+
+    bool SubdivContainerBase::hasGrowableBounds() const { return subdiv_.hasGrowableBounds(); }
+
+    Rect SubdivContainerBase::getBounds() const { return subdiv_.getBounds(); }
+
+    void SubdivContainerBase::growBounds(Rect rect) { subdiv_.growBounds(rect); }
+
     std::pair<VertexValueId, std::size_t> SubdivContainerBase::insert(Point2f const& pt) {
         std::size_t outSize = NoResizingNeededSentinel;
         auto ptId = subdiv_.insert(pt);
@@ -119,5 +129,166 @@ namespace subdiv2d {
         return std::make_pair(valueId, outSize);
     }
 
+    VertexValueId SubdivContainerBase::erase(Point2f const& pt) {
+        auto valueId = lookup(pt, nullptr);
+        if (!valueId) {
+            return valueId;
+        }
+        subdiv_.remove(VertexId(static_cast<int>(valueId.get()) + NumDummyVertices));
+        if (valueId.get() < valuesSet_.size()) {
+            valuesSet_[valueId.get()] = false;
+        }
+        return valueId;
+    }
+
+    bool SubdivContainerBase::move(Point2f const& from, Point2f const& to) {
+        auto valueId = lookup(from, nullptr);
+        if (!valueId) {
+            return false;
+        }
+        // Subdiv2D::move() keeps the VertexId, so the value stays in its slot.
+        subdiv_.move(VertexId(static_cast<int>(valueId.get()) + NumDummyVertices), to);
+        return true;
+    }
+
+    std::vector<VertexId> SubdivContainerBase::compact() {
+        auto vertexMap = subdiv_.compact();
+        std::vector<bool> valuesSet;
+        for (std::size_t i = NumDummyVertices; i < vertexMap.size(); ++i) {
+            auto to = getValueId(vertexMap[i]);
+            if (!to) {
+                continue;
+            }
+            if (to.get() >= valuesSet.size()) {
+                valuesSet.resize(to.get() + 1, false);
+            }
+            valuesSet[to.get()] = hasValue(getValueId(VertexId(static_cast<int>(i))));
+        }
+        valuesSet_.swap(valuesSet);
+        return vertexMap;
+    }
+
+    void SubdivContainerBase::saveSnapshot(std::string const& path, void const* values, std::size_t valueSize,
+                                           std::size_t numValues) const {
+        Subdiv2D_Assert(numValues == valuesSet_.size());
+        detail::SnapshotWriter writer;
+        subdiv_.writeSnapshot(writer);
+        const std::vector<std::uint8_t> valuesSet(valuesSet_.begin(), valuesSet_.end());
+        writer.add(detail::SnapshotSection::ValuesSet, valuesSet.data(), 1, valuesSet.size());
+        writer.add(detail::SnapshotSection::Values, values, valueSize, numValues);
+        writer.write(path);
+    }
+
+    void const* SubdivContainerBase::loadSnapshot(std::string const& path, std::size_t valueSize,
+                                                  std::size_t& numValues, std::uint64_t* journalSequence) {
+        const detail::SnapshotReader reader(path);
+        subdiv_.readSnapshot(reader);
+        std::size_t numSet = 0;
+        auto valuesSet = static_cast<std::uint8_t const*>(reader.get(detail::SnapshotSection::ValuesSet, 1, numSet));
+        auto values = reader.get(detail::SnapshotSection::Values, valueSize, numValues);
+        if (numValues != numSet) {
+            Subdiv2D_Error(Error::StsParseError, "Snapshot is corrupt");
+        }
+        valuesSet_.assign(valuesSet, valuesSet + numSet);
+        if (journalSequence) {
+            *journalSequence = detail::Journal::getSnapshotSequence(reader);
+        }
+        // The subdivision holds on to the snapshot, so the values stay valid after the reader is gone.
+        return values;
+    }
+
+    void SubdivContainerBase::startJournal(std::string const& snapshotPath, std::string const& journalPath,
+                                           std::size_t checkpointInterval, std::uint64_t sequence,
+                                           void const* values, std::size_t valueSize, std::size_t numValues) {
+        journal_.reset(new detail::Journal(snapshotPath, journalPath, valueSize, checkpointInterval, sequence));
+        checkpoint(values, valueSize, numValues);
+    }
+
+    void SubdivContainerBase::stopJournal() { journal_.reset(); }
+
+    bool SubdivContainerBase::isJournaling() const { return static_cast<bool>(journal_); }
+
+    void SubdivContainerBase::checkpoint(void const* values, std::size_t valueSize, std::size_t numValues) {
+        if (!journal_) {
+            Subdiv2D_Error(Error::StsError, "Not journaling: call startJournal() first");
+        }
+        Subdiv2D_Assert(numValues == valuesSet_.size());
+        const std::vector<std::uint8_t> valuesSet(valuesSet_.begin(), valuesSet_.end());
+        journal_->checkpoint([&](detail::SnapshotWriter& writer) {
+            subdiv_.writeSnapshot(writer);
+            writer.add(detail::SnapshotSection::ValuesSet, valuesSet.data(), 1, valuesSet.size());
+            writer.add(detail::SnapshotSection::Values, values, valueSize, numValues);
+        });
+    }
+
+    bool SubdivContainerBase::journalInsert(Point2f const& pt, void const* value) {
+        const detail::JournalRecord record = {detail::JournalOp::InsertValue, 0, {pt.x, pt.y, 0, 0}};
+        return journal_->append(record, value);
+    }
+
+    bool SubdivContainerBase::journalErase(Point2f const& pt) {
+        const detail::JournalRecord record = {detail::JournalOp::Erase, 0, {pt.x, pt.y, 0, 0}};
+        return journal_->append(record);
+    }
+
+    bool SubdivContainerBase::journalMove(Point2f const& from, Point2f const& to) {
+        const detail::JournalRecord record = {detail::JournalOp::MovePoint, 0, {from.x, from.y, to.x, to.y}};
+        return journal_->append(record);
+    }
+
+    bool SubdivContainerBase::journalCompact() {
+        const detail::JournalRecord record = {detail::JournalOp::Compact, 0, {}};
+        return journal_->append(record);
+    }
+
+    bool SubdivContainerBase::journalGrowBounds(Rect rect) {
+        // As for Subdiv2D: the rect is stored bit for bit.
+        detail::JournalRecord record = {detail::JournalOp::GrowBounds, 0, {}};
+        const int coords[4] = {rect.x, rect.y, rect.width, rect.height};
+        std::memcpy(record.coords, coords, sizeof(coords));
+        return journal_->append(record);
+    }
+
+    bool SubdivContainerBase::journalGrowableBounds(bool growable) {
+        const detail::JournalRecord record = {detail::JournalOp::GrowableBounds, growable ? 1 : 0, {}};
+        return journal_->append(record);
+    }
+
+    std::uint64_t
+    SubdivContainerBase::replayJournal(std::string const& journalPath, std::size_t valueSize, std::uint64_t sequence,
+                                       std::function<void(Point2f const&, void const*)> const& insertValue,
+                                       std::function<void(Point2f const&)> const& eraseValue,
+                                       std::function<void()> const& compactValues) {
+        return detail::Journal::replay(
+            journalPath, valueSize, sequence, [&](detail::JournalRecord const& record, void const* value) {
+                const Point2f pt(record.coords[0], record.coords[1]);
+                switch (record.op) {
+                case detail::JournalOp::InsertValue:
+                    insertValue(pt, value);
+                    break;
+                case detail::JournalOp::Erase:
+                    eraseValue(pt);
+                    break;
+                case detail::JournalOp::MovePoint:
+                    move(pt, Point2f(record.coords[2], record.coords[3]));
+                    break;
+                case detail::JournalOp::Compact:
+                    compactValues();
+                    break;
+                case detail::JournalOp::GrowBounds: {
+                    int rect[4];
+                    std::memcpy(rect, record.coords, sizeof(rect));
+                    growBounds(Rect(rect[0], rect[1], rect[2], rect[3]));
+                    break;
+                }
+                case detail::JournalOp::GrowableBounds:
+                    setGrowableBounds(record.vertex != 0);
+                    break;
+                default:
+                    Subdiv2D_Error(Error::StsParseError, "Journal record is not of a container");
+                }
+            });
+    }
+
 } // namespace subdiv2d
 } // namespace sensics
@@ -64,6 +64,8 @@
 
 // Internal Includes
 #include "subdiv2d/Subdivision2D.h"
+#include "Journal.h"
+#include "SpatialSort.h"
 #include "Subdiv2DConfig.h"
 #include "subdiv2d/AssertAndError.h"
 
@@ -73,15 +75,22 @@
 #endif
 
 // Standard includes
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 
 namespace sensics {
 namespace subdiv2d {
 #ifdef SUBDIV2D_USE_BOOST_SMALL_VECTOR
     using SmallEdgeVector = boost::container::small_vector<EdgeId, 16>;
+    using SmallFaceVector = boost::container::small_vector<FaceId, 16>;
 #else
     using SmallEdgeVector = std::vector<EdgeId>;
+    using SmallFaceVector = std::vector<FaceId>;
 #endif
     namespace detail {
         EdgeId LocateSubResults::getEdge() const { return edge; }
@@ -121,60 +130,67 @@ namespace subdiv2d {
             return std::find(vertices.begin(), vertices.end(), vertex) != vertices.end();
         }
 
-        class EdgeIterationHelper {
+        /// Visits one edge of each face (including the outside of the bounding triangle), in increasing order: the
+        /// lowest-numbered of the face's three edges. Since that is decided from the face alone, no record of the faces
+        /// already visited is needed, so a traversal allocates nothing.
+        class FaceIterationHelper {
           public:
-            EdgeIterationHelper(std::vector<Subdiv2D::QuadEdge> const& qedges, std::size_t start = 4,
-                                std::size_t inc = 2);
+            explicit FaceIterationHelper(Subdiv2D const& subdiv);
             /// Returns true while get() is valid
             explicit operator bool() const;
-            /// Increments until a non-visted edge is reached or get would no longer be valid.
-            EdgeIterationHelper& advance();
-
-            /// Mark additional edge as visited.
-            void markVisited(EdgeId edge);
+            /// Increments until the next face's lowest edge is reached or get would no longer be valid.
+            FaceIterationHelper& advance();
 
             /// Get the current edge.
             EdgeId get() const;
 
           private:
+            /// Should the current edge be skipped, because it is on the free list or not the lowest of its face?
+            bool skip() const;
+            Subdiv2D const& subdiv_;
             std::size_t i_ = 4;
-            const std::size_t inc_;
             const std::size_t n_;
-            std::vector<bool> edgemask_;
         };
 
-        EdgeIterationHelper::EdgeIterationHelper(std::vector<Subdiv2D::QuadEdge> const& qedges, std::size_t start,
-                                                 std::size_t inc)
-            : i_(start), inc_(inc), n_(qedges.size() * 4), edgemask_(n_, false) {}
+        FaceIterationHelper::FaceIterationHelper(Subdiv2D const& subdiv)
+            : subdiv_(subdiv), n_(subdiv.qedges.size() * 4) {
+            while (*this && skip()) {
+                i_ += 2;
+            }
+        }
 
-        EdgeIterationHelper::operator bool() const { return i_ < n_; }
+        FaceIterationHelper::operator bool() const { return i_ < n_; }
 
-        EdgeIterationHelper& EdgeIterationHelper::advance() {
-            i_ += inc_;
-            while (*this) {
-                if (!edgemask_[i_]) {
-                    break;
-                }
-                i_ += inc_;
-            }
-            if (*this) {
-                markVisited(get());
-            }
-            return *this;
+        bool FaceIterationHelper::skip() const {
+            return subdiv_.qedges.isfree(i_ / 4) || !subdiv_.isLowestEdgeOfFace(get());
         }
 
-        void EdgeIterationHelper::markVisited(EdgeId edge) { edgemask_[edge.get()] = true; }
+        FaceIterationHelper& FaceIterationHelper::advance() {
+            do {
+                i_ += 2;
+            } while (*this && skip());
+            return *this;
+        }
 
-        EdgeId EdgeIterationHelper::get() const { return EdgeId(i_); }
+        EdgeId FaceIterationHelper::get() const { return EdgeId(static_cast<int>(i_)); }
     } // namespace detail
 
     static inline QuadEdgeId getQuadEdgeId(EdgeId edge) { return QuadEdgeId(edge.get() >> 2); }
 
+    static inline float simpleAbsPointDistance(Point2f const& a, Point2f const& b) {
+        // think this is the manhattan distance...
+        auto diff = a - b;
+        return std::abs(diff.x) + std::abs(diff.y);
+    }
+
+    /// Index of a primal edge (rotation 0 or 2) in the edge-to-face map.
+    static inline std::size_t faceSlot(EdgeId edge) { return static_cast<std::size_t>(edge.get()) >> 1; }
+
     static inline EdgeId makeEdgeId(QuadEdgeId qedge) { return EdgeId(qedge.get() << 2); }
 
     EdgeId Subdiv2D::nextEdge(EdgeId edge) const {
         dbgAssertEdgeInRange(edge);
-        return EdgeId(getQuadEdge(edge).next[edge.get() & 3]);
+        return EdgeId(qedges.next(edge));
     }
 
     EdgeId Subdiv2D::rotateEdge(EdgeId edge, int rotate) const {
@@ -185,13 +201,13 @@ namespace subdiv2d {
 
     EdgeId Subdiv2D::getEdge(EdgeId edge, int nextEdgeType) const {
         dbgAssertEdgeInRange(edge);
-        auto e = getQuadEdge(edge).next[(edge.get() + nextEdgeType) & 3];
+        auto e = qedges.next(rotateEdge(edge, nextEdgeType));
         return EdgeId((e & ~3) + ((e + (nextEdgeType >> 4)) & 3));
     }
 
     VertexId Subdiv2D::edgeOrg(EdgeId edge, Point2f* orgpt) const {
         dbgAssertEdgeInRange(edge);
-        VertexId vidx = getQuadEdge(edge).pt[edge.get() & 3];
+        VertexId vidx = qedges.org(edge);
         if (orgpt) {
             *orgpt = getVertex(vidx);
         }
@@ -200,7 +216,7 @@ namespace subdiv2d {
 
     VertexId Subdiv2D::edgeDst(EdgeId edge, Point2f* dstpt) const {
         dbgAssertEdgeInRange(edge);
-        VertexId vidx = getQuadEdge(edge).pt[(edge.get() + 2) & 3];
+        VertexId vidx = qedges.org(symEdge(edge));
         if (dstpt) {
             *dstpt = getVertex(vidx);
         }
@@ -217,25 +233,11 @@ namespace subdiv2d {
 
     Subdiv2D::Subdiv2D() {}
 
-    Subdiv2D::Subdiv2D(Rect rect) { initDelaunay(rect); }
-
-    Subdiv2D::QuadEdge::QuadEdge() {
-        next[0] = next[1] = next[2] = next[3] = Invalid;
-        pt[0] = pt[1] = pt[2] = pt[3] = InvalidVertex;
-    }
-
-    Subdiv2D::QuadEdge::QuadEdge(EdgeId edgeidx) {
-        Subdiv2D_DbgAssert((edgeidx.get() & 3) == 0);
-        next[0] = edgeidx.get();
-        next[1] = (edgeidx.get() + 3);
-        next[2] = (edgeidx.get() + 2);
-        next[3] = (edgeidx.get() + 1);
-
-        pt[0] = pt[1] = pt[2] = pt[3] = InvalidVertex;
+    Subdiv2D::Subdiv2D(Rect rect, SubdivMode mode, MemoryResource* resource) : vtx(resource), qedges(resource) {
+        qedges.setHasDual(mode == SubdivMode::DelaunayAndVoronoi);
+        initDelaunay(rect);
     }
 
-    bool Subdiv2D::QuadEdge::isfree() const { return next[0] <= Invalid; }
-
     Subdiv2D::Vertex::Vertex() {
         firstEdge = InvalidEdge;
         type = -1;
@@ -252,19 +254,17 @@ namespace subdiv2d {
     bool Subdiv2D::Vertex::isfree() const { return type < 0; }
 
     void Subdiv2D::splice(EdgeId edgeA, EdgeId edgeB) {
-        auto& a_next = getQuadEdge(edgeA).next[edgeA.get() & 3];
-        auto& b_next = getQuadEdge(edgeB).next[edgeB.get() & 3];
-        auto a_rot = rotateEdge(EdgeId(a_next), 1);
-        auto b_rot = rotateEdge(EdgeId(b_next), 1);
-        auto& a_rot_next = getQuadEdge(a_rot).next[a_rot.get() & 3];
-        auto& b_rot_next = getQuadEdge(b_rot).next[b_rot.get() & 3];
+        auto& a_next = qedges.next(edgeA);
+        auto& b_next = qedges.next(edgeB);
+        auto& a_rot_next = qedges.next(rotateEdge(EdgeId(a_next), 1));
+        auto& b_rot_next = qedges.next(rotateEdge(EdgeId(b_next), 1));
         std::swap(a_next, b_next);
         std::swap(a_rot_next, b_rot_next);
     }
 
     void Subdiv2D::setEdgePoints(EdgeId edge, VertexId orgPt, VertexId dstPt) {
-        getQuadEdge(edge).pt[edge.get() & 3] = orgPt;
-        getQuadEdge(edge).pt[(edge.get() + 2) & 3] = dstPt;
+        qedges.org(edge) = orgPt;
+        qedges.org(symEdge(edge)) = dstPt;
         vtx[orgPt.get()].firstEdge = edge;
         vtx[dstPt.get()].firstEdge = EdgeId(edge.get() ^ 2);
     }
@@ -284,6 +284,16 @@ namespace subdiv2d {
         auto a = getEdge(edge, PREV_AROUND_ORG);
         auto b = getEdge(sedge, PREV_AROUND_ORG);
 
+        // The old endpoints must not be left referring to this edge.
+        auto& orgVertex = vtx[edgeOrg(edge).get()];
+        if (orgVertex.firstEdge == edge) {
+            orgVertex.firstEdge = a;
+        }
+        auto& dstVertex = vtx[edgeOrg(sedge).get()];
+        if (dstVertex.firstEdge == sedge) {
+            dstVertex.firstEdge = b;
+        }
+
         splice(edge, a);
         splice(sedge, b);
 
@@ -297,19 +307,17 @@ namespace subdiv2d {
         Point2f org, dst;
         edgeOrg(edge, &org);
         edgeDst(edge, &dst);
-        double cw_area = doubleTriangleArea(pt, dst, org);
-
-        return (cw_area > 0) - (cw_area < 0);
+        return sensics::subdiv2d::isRightOf(pt, org, dst);
     }
 
-    VertexArray Subdiv2D::locateVertexIdsArray(Point2f const& pt) {
-        auto result = locateSub(pt);
+    VertexArray Subdiv2D::locateVertexIdsArray(Point2f const& pt, LocateCursor* cursor) const {
+        auto result = locateSub(pt, cursor);
         return result.getVertices();
     }
 
-    std::vector<VertexId> Subdiv2D::locateVertexIds(Point2f const& pt) {
+    std::vector<VertexId> Subdiv2D::locateVertexIds(Point2f const& pt, LocateCursor* cursor) const {
         std::vector<VertexId> ret;
-        for (auto id : locateVertexIdsArray(pt)) {
+        for (auto id : locateVertexIdsArray(pt, cursor)) {
             if (id != InvalidVertex) {
                 ret.push_back(id);
             }
@@ -317,8 +325,8 @@ namespace subdiv2d {
         return ret;
     }
 
-    VertexArray Subdiv2D::locateVertexIdsForInterpolationArray(Point2f const& pt) {
-        auto result = locateSub(pt);
+    VertexArray Subdiv2D::locateVertexIdsForInterpolationArray(Point2f const& pt, LocateCursor* cursor) const {
+        auto result = locateSub(pt, cursor);
         /// Only in vertices = 3 case might we have a bounding vertex
         if (result.numVertices() != 3) {
             return result.getVertices();
@@ -344,8 +352,8 @@ namespace subdiv2d {
 
         switch (numRealVertices) {
         case 3:
-#if 0
-            /// @todo make this sorted
+#if 0
+            /// @todo make this sorted
             return result.getVertices();
 #else
             return myVertices;
@@ -401,7 +409,6 @@ namespace subdiv2d {
             SmallEdgeVector possibleEdges;
             EdgeId currentEdge = getEdge(edgeWithGoodDest, NEXT_AROUND_LEFT);
             while (currentEdge && currentEdge != edgeWithGoodOrig) {
-                std::cout << "Possible: " << currentEdge << std::endl;
                 possibleEdges.push_back(currentEdge);
                 currentEdge = nextEdge(currentEdge);
             }
@@ -422,9 +429,9 @@ namespace subdiv2d {
         return VertexArray();
     }
 
-    void Subdiv2D::locateVertices(Point2f const& pt, std::vector<Point>& outVertices) {
+    void Subdiv2D::locateVertices(Point2f const& pt, std::vector<Point>& outVertices, LocateCursor* cursor) const {
         outVertices.clear();
-        auto ids = locateVertexIdsArray(pt);
+        auto ids = locateVertexIdsArray(pt, cursor);
         for (auto id : ids) {
             if (id != InvalidVertex) {
                 outVertices.push_back(getVertex(id));
@@ -432,9 +439,9 @@ namespace subdiv2d {
         }
     }
 
-    std::vector<Subdiv2D::Point> Subdiv2D::locateVertices(Point const& pt) {
+    std::vector<Subdiv2D::Point> Subdiv2D::locateVertices(Point const& pt, LocateCursor* cursor) const {
         std::vector<Point> ret;
-        locateVertices(pt, ret);
+        locateVertices(pt, ret, cursor);
         return ret;
     }
 
@@ -444,12 +451,12 @@ namespace subdiv2d {
 
     EdgeId Subdiv2D::newEdge() {
         if (!freeQEdge.valid()) {
-            qedges.push_back(QuadEdge());
+            qedges.resize(qedges.size() + 1);
             freeQEdge = QuadEdgeId(qedges.size() - 1);
         }
         EdgeId edge = makeEdgeId(freeQEdge);
-        freeQEdge = QuadEdgeId(getQuadEdge(edge).next[1]);
-        getQuadEdge(edge) = QuadEdge(edge);
+        freeQEdge = QuadEdgeId(qedges.nextFree(freeQEdge.get()));
+        qedges.makeEdge(getQuadEdgeId(edge).get());
         return edge;
     }
 
@@ -460,9 +467,11 @@ namespace subdiv2d {
         splice(sedge, getEdge(sedge, PREV_AROUND_ORG));
 
         auto qedge = getQuadEdgeId(edge);
-        qedges[qedge.get()].next[0] = Invalid;
-        qedges[qedge.get()].next[1] = freeQEdge.get();
+        qedges.setFree(qedge.get(), freeQEdge.get());
         freeQEdge = qedge;
+        if (validFaces && faceSlot(edge) < edgeFaces.size()) {
+            edgeFaces[faceSlot(edge)] = edgeFaces[faceSlot(sedge)] = InvalidFace;
+        }
     }
 
     VertexId Subdiv2D::newPoint(Point2f pt, bool isvirtual, EdgeId firstEdge) {
@@ -484,8 +493,8 @@ namespace subdiv2d {
         freePoint = vidx;
     }
 
-    PtLoc Subdiv2D::locate(Point2f pt, EdgeId& _edge, VertexId& _vertex) {
-        auto result = locateSub(pt);
+    PtLoc Subdiv2D::locate(Point2f pt, EdgeId& _edge, VertexId& _vertex, LocateCursor* cursor) const {
+        auto result = locateSub(pt, cursor);
 
         _edge = result.getEdge();
         if (result.numVertices() == 1) {
@@ -497,24 +506,46 @@ namespace subdiv2d {
         return result.locateStatus;
     }
 
-    std::tuple<PtLoc, EdgeId, VertexId> Subdiv2D::locate(Point2f pt) {
+    PtLoc Subdiv2D::locate(Point2f pt, EdgeId& _edge, VertexId& _vertex, FaceId& _face, LocateCursor* cursor) const {
+        if (!validFaces) {
+            Subdiv2D_Error(Error::StsError, "Face table is out of date: call calcFaces() first");
+        }
+        auto stat = locate(pt, _edge, _vertex, cursor);
+        _face = InvalidFace;
+        if (stat == PtLoc::PTLOC_VERTEX) {
+            // Any face around it: the bounding vertices also have the outside of the bounding triangle.
+            const auto first = getVertexInternal(_vertex).firstEdge;
+            auto edge = first;
+            do {
+                _face = edgeFaces[faceSlot(edge)];
+                edge = nextEdge(edge);
+            } while (!_face.valid() && edge != first);
+        } else if (stat == PtLoc::PTLOC_INSIDE || stat == PtLoc::PTLOC_ON_EDGE) {
+            // The point is on, or to the left of, the edge.
+            _face = edgeFaces[faceSlot(_edge)];
+        }
+        return stat;
+    }
+
+    std::tuple<PtLoc, EdgeId, VertexId> Subdiv2D::locate(Point2f pt, LocateCursor* cursor) const {
         EdgeId edge;
         VertexId vertex;
-        auto stat = locate(pt, edge, vertex);
+        auto stat = locate(pt, edge, vertex, cursor);
         return std::make_tuple(stat, edge, vertex);
     }
 
-    inline int isPtInCircle3(Point2f pt, Point2f a, Point2f b, Point2f c) {
-        const double eps = Subdiv2D::EPSILON() * 0.125;
-        double val = ((double)a.x * a.x + (double)a.y * a.y) * doubleTriangleArea(b, c, pt);
-        val -= ((double)b.x * b.x + (double)b.y * b.y) * doubleTriangleArea(a, c, pt);
-        val += ((double)c.x * c.x + (double)c.y * c.y) * doubleTriangleArea(a, b, pt);
-        val -= ((double)pt.x * pt.x + (double)pt.y * pt.y) * doubleTriangleArea(a, b, c);
-
-        return val > eps ? 1 : val < -eps ? -1 : 0;
+    VertexId Subdiv2D::insert(Point2f pt) {
+        if (growableBounds && !isInBounds(pt)) {
+            growBoundsToInclude(pt, pt);
+        }
+        const auto ret = insertSub(pt, InvalidVertex);
+        if (journal) {
+            journalChange(detail::JournalOp::Insert, InvalidVertex, pt);
+        }
+        return ret;
     }
 
-    VertexId Subdiv2D::insert(Point2f pt) {
+    VertexId Subdiv2D::insertSub(Point2f pt, VertexId vertex) {
 
         VertexId curr_point = InvalidVertex;
         EdgeId curr_edge = InvalidEdge;
@@ -537,16 +568,21 @@ namespace subdiv2d {
             recentEdge = curr_edge = getEdge(curr_edge, PREV_AROUND_ORG);
             deleteEdge(deleted_edge);
         } else if (location == PtLoc::PTLOC_INSIDE) {
-            // pass - this is fine
+            // Start the next walk here: consecutive insertions are often close together.
+            recentEdge = curr_edge;
         } else {
             Subdiv2D_Error_(Error::StsError,
                             ("Subdiv2D::locate returned invalid location = %d", static_cast<int>(location)));
         }
 
         assert(curr_edge != InvalidEdge);
-        validGeometry = false;
 
-        curr_point = newPoint(pt, false);
+        if (vertex.valid()) {
+            curr_point = vertex;
+            vtx[vertex.get()].pt = pt;
+        } else {
+            curr_point = newPoint(pt, false);
+        }
         auto base_edge = newEdge();
         auto first_point = edgeOrg(curr_edge);
         setEdgePoints(base_edge, first_point, curr_point);
@@ -579,70 +615,669 @@ namespace subdiv2d {
             }
         }
 
+        if (validGeometry) {
+            updateVoronoiAround(curr_point);
+        }
+        if (validFaces) {
+            updateFacesAround(curr_point);
+        }
+
         return curr_point;
     }
 
-    void Subdiv2D::insert(const std::vector<Point2f>& ptvec) {
-        for (auto& pt : ptvec) {
-            insert(pt);
+    std::vector<VertexId> Subdiv2D::insert(const std::vector<Point2f>& ptvec) {
+        if (growableBounds && !ptvec.empty()) {
+            // Grow once for them all, rather than again and again as they are inserted.
+            auto lo = ptvec.front();
+            auto hi = lo;
+            for (auto const& pt : ptvec) {
+                lo = Point2f(std::min(lo.x, pt.x), std::min(lo.y, pt.y));
+                hi = Point2f(std::max(hi.x, pt.x), std::max(hi.y, pt.y));
+            }
+            if (!isInBounds(lo) || !isInBounds(hi)) {
+                const auto before = getBounds();
+                growBoundsToInclude(lo, hi);
+                if (journal && !(getBounds() == before)) {
+                    journalRect(detail::JournalOp::GrowBounds, getBounds());
+                }
+            }
+        }
+        std::vector<VertexId> ret(ptvec.size());
+        for (auto i : detail::brioOrder(ptvec.data(), ptvec.size(), topLeft, bottomRight)) {
+            ret[i] = insert(ptvec[i]);
+        }
+        return ret;
+    }
+
+    void Subdiv2D::checkUserVertex(VertexId vertex) const {
+        if (!vertex.valid() || static_cast<std::size_t>(vertex.get()) >= vtx.size() || isVertexBoundary(vertex)) {
+            Subdiv2D_Error(Error::StsBadArg, "Not an inserted vertex");
+        }
+        auto const& v = getVertexInternal(vertex);
+        if (v.isfree() || v.isvirtual() || !v.firstEdge.valid()) {
+            Subdiv2D_Error(Error::StsBadArg, "Not a vertex of the triangulation");
+        }
+    }
+
+    void Subdiv2D::remove(VertexId vertex) {
+        checkUserVertex(vertex);
+        detachVertex(vertex);
+        deletePoint(vertex);
+        if (journal) {
+            journalChange(detail::JournalOp::Remove, vertex);
+        }
+    }
+
+    /// The power of pt with respect to the circumcircle of the counterclockwise triangle abc: the in-circle determinant
+    /// of the four points is minus that power times the triangle's doubled area.
+    static double powerToCircumcircle(Point2f const& pt, Point2f const& a, Point2f const& b, Point2f const& c) {
+        const double adx = (double)a.x - pt.x, ady = (double)a.y - pt.y;
+        const double bdx = (double)b.x - pt.x, bdy = (double)b.y - pt.y;
+        const double cdx = (double)c.x - pt.x, cdy = (double)c.y - pt.y;
+        const double det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) +
+                           (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+                           (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+        return -det / doubleTriangleArea(a, b, c);
+    }
+
+    void Subdiv2D::detachVertex(VertexId vertex) {
+        auto& v = getVertexInternal(vertex);
+        if (validGeometry) {
+            clearVoronoiAround(vertex);
+        }
+        // Removal leaves holes in the dense face numbering: rebuild on the next calcFaces().
+        validFaces = false;
+
+        // The edges around the hole the star leaves, counterclockwise, each with the hole on its left.
+        SmallEdgeVector spokes;
+        SmallEdgeVector hole;
+        const auto first = v.firstEdge;
+        auto edge = first;
+        do {
+            spokes.push_back(edge);
+            hole.push_back(getEdge(edge, NEXT_AROUND_LEFT));
+            edge = nextEdge(edge);
+        } while (edge != first);
+
+        for (auto spoke : spokes) {
+            deleteEdge(spoke);
+        }
+        for (auto boundary : hole) {
+            // Its first edge may have been a spoke.
+            vtx[edgeOrg(boundary).get()].firstEdge = boundary;
+        }
+        recentEdge = hole.front();
+        v.firstEdge = InvalidEdge;
+
+        // Fill the hole, one Delaunay ear at a time: it is star-shaped (around the removed vertex), so the Delaunay
+        // triangulation of the vertices around it fits inside it. Of the ears (counterclockwise corners), the one
+        // whose circumcircle the removed point has the greatest power with respect to is Delaunay (O. Devillers, "On
+        // deletion in Delaunay triangulations"): raising the point off the paraboloid, that ear's plane is the first
+        // it passes. Cutting an ear only changes the two next to it, so with the ears in a heap this takes O(d log d)
+        // time for d edges around the vertex.
+        const auto pt = v.pt;
+        const auto n = hole.size();
+        // The hole as a circular list: ear i is made of edge i and the one after it. Its stamp is bumped whenever the
+        // ear changes, to tell which heap entries are out of date.
+        struct Corner {
+            std::size_t next;
+            std::size_t prev;
+            std::uint32_t stamp;
+        };
+        struct Ear {
+            double power;
+            std::size_t first;
+            std::uint32_t stamp;
+            bool operator<(Ear const& other) const { return power < other.power; }
+        };
+        // Each cut pushes at most two ears: only large holes need the heap to allocate.
+        static const std::size_t LocalHoleSize = 32;
+        Corner localCorners[LocalHoleSize];
+        Ear localEars[3 * LocalHoleSize];
+        std::vector<Corner> allocatedCorners;
+        std::vector<Ear> allocatedEars;
+        Corner* corners = localCorners;
+        Ear* ears = localEars;
+        if (n > LocalHoleSize) {
+            allocatedCorners.resize(n);
+            allocatedEars.resize(3 * n);
+            corners = allocatedCorners.data();
+            ears = allocatedEars.data();
+        }
+        std::size_t numEars = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            corners[i] = Corner{(i + 1) % n, (i + n - 1) % n, 0};
+        }
+        auto pushEar = [&](std::size_t i) {
+            auto& corner = corners[i];
+            ++corner.stamp;
+            auto a = getVertex(edgeOrg(hole[i]));
+            auto b = getVertex(edgeOrg(hole[corner.next]));
+            auto c = getVertex(edgeDst(hole[corner.next]));
+            if (triangleOrientation(a, b, c) > 0) {
+                ears[numEars++] = Ear{powerToCircumcircle(pt, a, b, c), i, corner.stamp};
+                std::push_heap(ears, ears + numEars);
+            }
+        };
+        for (std::size_t i = 0; i < n; ++i) {
+            pushEar(i);
+        }
+
+        SmallEdgeVector newFaces;
+        auto remaining = n;
+        auto last = std::size_t(0);
+        while (remaining > 3) {
+            Subdiv2D_Assert(numEars > 0);
+            std::pop_heap(ears, ears + numEars);
+            const auto ear = ears[--numEars];
+            if (ear.stamp != corners[ear.first].stamp) {
+                continue;
+            }
+            // The new edge runs from c to a, with the ear on its left and the rest of the hole on its right.
+            const auto i = ear.first;
+            const auto cut = corners[i].next;
+            auto diagonal = connectEdges(hole[cut], hole[i]);
+            newFaces.push_back(diagonal);
+            hole[i] = symEdge(diagonal);
+            corners[i].next = corners[cut].next;
+            corners[corners[cut].next].prev = i;
+            ++corners[cut].stamp;
+            --remaining;
+            pushEar(corners[i].prev);
+            pushEar(i);
+            last = i;
+        }
+        newFaces.push_back(hole[last]);
+
+        if (validGeometry) {
+            for (auto face : newFaces) {
+                calcVoronoiFace(face);
+            }
+        }
+    }
+
+    void Subdiv2D::move(VertexId vertex, Point2f pt) {
+        checkUserVertex(vertex);
+        if (!isInBounds(pt)) {
+            if (!growableBounds) {
+                Subdiv2D_Error(Error::StsOutOfRange, "");
+            }
+            // No other vertex is out there, so nothing below refuses the move: growing never needs undoing.
+            growBoundsToInclude(pt, pt);
+        } else {
+            // Insertion would merge the vertex with any other this close: refuse before changing anything.
+            std::array<VertexId, 2> nearest;
+            const auto numNearest = findKNearest(pt, nearest.size(), nearest.data());
+            for (std::size_t i = 0; i < numNearest; ++i) {
+                if (nearest[i] != vertex && simpleAbsPointDistance(getVertex(nearest[i]), pt) < EPSILON()) {
+                    Subdiv2D_Error(Error::StsBadArg, "Another vertex is already there");
+                }
+            }
+        }
+
+        // Staying within the kernel of the star keeps the triangles around it counterclockwise, so only their Delaunay
+        // property needs restoring.
+        if (isInKernel(vertex, pt)) {
+            relocateInKernel(vertex, pt);
+        } else {
+            detachVertex(vertex);
+            insertSub(pt, vertex);
+        }
+        if (journal) {
+            journalChange(detail::JournalOp::Move, vertex, pt);
+        }
+    }
+
+    bool Subdiv2D::isInKernel(VertexId vertex, Point2f pt) const {
+        const auto first = getVertexInternal(vertex).firstEdge;
+        auto edge = first;
+        do {
+            auto link = getEdge(edge, NEXT_AROUND_LEFT);
+            const VertexArray face = {{vertex, edgeOrg(link), edgeDst(link)}};
+            if (!isOuterFace(face) && triangleOrientation(getVertex(face[1]), getVertex(face[2]), pt) <= 0) {
+                return false;
+            }
+            edge = nextEdge(edge);
+        } while (edge != first);
+        return true;
+    }
+
+    void Subdiv2D::relocateInKernel(VertexId vertex, Point2f pt) {
+        if (validGeometry) {
+            clearVoronoiAround(vertex);
+        }
+        getVertexInternal(vertex).pt = pt;
+
+        // Lawson's flips, starting from the edges of the triangles around the vertex.
+        const auto first = getVertexInternal(vertex).firstEdge;
+        SmallEdgeVector toCheck;
+        SmallEdgeVector flipped;
+        auto edge = first;
+        do {
+            toCheck.push_back(edge);
+            toCheck.push_back(getEdge(edge, NEXT_AROUND_LEFT));
+            edge = nextEdge(edge);
+        } while (edge != first);
+        while (!toCheck.empty()) {
+            edge = toCheck.back();
+            toCheck.pop_back();
+            const auto a = edgeOrg(edge);
+            const auto b = edgeDst(edge);
+            if (isVertexBoundary(a) && isVertexBoundary(b)) {
+                // The bounding triangle: the outside is not a triangle.
+                continue;
+            }
+            const auto c = edgeDst(getEdge(edge, NEXT_AROUND_LEFT));
+            const auto d = edgeDst(getEdge(symEdge(edge), NEXT_AROUND_LEFT));
+            if (isPtInCircle3(getVertex(d), getVertex(a), getVertex(b), getVertex(c)) <= 0) {
+                continue;
+            }
+            if (validGeometry) {
+                clearVoronoiFace(edge);
+                clearVoronoiFace(symEdge(edge));
+            }
+            auto leftFace = InvalidFace;
+            auto rightFace = InvalidFace;
+            if (validFaces) {
+                leftFace = edgeFaces[faceSlot(edge)];
+                rightFace = edgeFaces[faceSlot(symEdge(edge))];
+            }
+            swapEdges(edge);
+            if (validFaces) {
+                updateFacesAfterSwap(edge, leftFace, rightFace);
+            }
+            flipped.push_back(edge);
+            for (auto side : {edge, symEdge(edge)}) {
+                auto next = getEdge(side, NEXT_AROUND_LEFT);
+                toCheck.push_back(next);
+                toCheck.push_back(getEdge(next, NEXT_AROUND_LEFT));
+            }
+        }
+
+        if (validGeometry) {
+            // The faces whose Voronoi vertices were cleared are now either around the vertex, or beside an edge that
+            // was flipped. As in computeVoronoi(), faces of just bounding vertices (inside or out) get none.
+            auto recalc = [&](EdgeId faceEdge) {
+                const auto third = edgeDst(getEdge(faceEdge, NEXT_AROUND_LEFT));
+                if (isVertexBoundary(edgeOrg(faceEdge)) && isVertexBoundary(edgeDst(faceEdge)) &&
+                    isVertexBoundary(third)) {
+                    return;
+                }
+                if (!qedges.org(rotateEdge(faceEdge, 3)).valid()) {
+                    calcVoronoiFace(faceEdge);
+                }
+            };
+            const auto newFirst = getVertexInternal(vertex).firstEdge;
+            edge = newFirst;
+            do {
+                recalc(edge);
+                edge = nextEdge(edge);
+            } while (edge != newFirst);
+            for (auto e : flipped) {
+                recalc(e);
+                recalc(symEdge(e));
+            }
+        }
+    }
+
+    std::vector<VertexId> Subdiv2D::compact() {
+        std::vector<VertexId> vertexMap(vtx.size(), InvalidVertex);
+        if (vtx.empty()) {
+            return vertexMap;
+        }
+        const bool hadVoronoi = validGeometry;
+        const bool hadFaces = validFaces;
+        // The Voronoi vertices are recomputed afterward, from the new IDs, so they stay the same (to the bit) as
+        // getVoronoiFacet() would compute.
+        clearVoronoi();
+
+        // Vertices: the placeholder and bounding vertices first, then the rest along the curve.
+        std::vector<VertexId> order;
+        std::vector<Point2f> pts;
+        for (std::size_t i = 4; i < vtx.size(); ++i) {
+            if (!vtx[i].isfree()) {
+                order.push_back(VertexId(static_cast<int>(i)));
+                pts.push_back(vtx[i].pt);
+            }
+        }
+        const auto curve = detail::hilbertOrder(pts.data(), pts.size(), topLeft, bottomRight);
+        std::vector<VertexId> oldIds = {VertexId(0), VertexId(1), VertexId(2), VertexId(3)};
+        oldIds.reserve(4 + curve.size());
+        for (auto i : curve) {
+            oldIds.push_back(order[i]);
+        }
+        for (std::size_t i = 0; i < oldIds.size(); ++i) {
+            vertexMap[oldIds[i].get()] = VertexId(static_cast<int>(i));
+        }
+
+        // Quad-edges: those around each vertex in turn, so the ones a walk reads together are stored together.
+        std::vector<int> qedgeMap(qedges.size(), int(Invalid));
+        std::vector<std::size_t> oldQEdges(1, 0);
+        auto take = [&](std::size_t qedge) {
+            if (qedgeMap[qedge] == Invalid) {
+                qedgeMap[qedge] = static_cast<int>(oldQEdges.size());
+                oldQEdges.push_back(qedge);
+            }
+        };
+        for (auto vertex : oldIds) {
+            const auto first = vtx[vertex.get()].firstEdge;
+            if (!vertex.valid() || !first.valid()) {
+                continue;
+            }
+            auto edge = first;
+            do {
+                take(getQuadEdgeId(edge).get());
+                edge = nextEdge(edge);
+            } while (edge != first);
+        }
+        // Every edge is reached through its origin, but in case of edges that never got one:
+        for (std::size_t i = 1; i < qedges.size(); ++i) {
+            if (!qedges.isfree(i)) {
+                take(i);
+            }
+        }
+        auto mapEdge = [&](EdgeId edge) {
+            return edge.valid() ? EdgeId((qedgeMap[edge.get() >> 2] << 2) | (edge.get() & 3)) : edge;
+        };
+        auto mapVertex = [&](VertexId vertex) { return vertex.valid() ? vertexMap[vertex.get()] : vertex; };
+
+        decltype(vtx) newVtx(vtx.resource());
+        newVtx.reserve(oldIds.size());
+        for (auto vertex : oldIds) {
+            auto v = vtx[vertex.get()];
+            v.firstEdge = mapEdge(v.firstEdge);
+            newVtx.push_back(v);
+        }
+        QuadEdgeStorage newQEdges(qedges.resource());
+        newQEdges.setHasDual(qedges.hasDual());
+        newQEdges.reserve(oldQEdges.size());
+        newQEdges.resize(oldQEdges.size());
+        for (std::size_t i = 1; i < oldQEdges.size(); ++i) {
+            auto const& from = qedges.primal_[oldQEdges[i]];
+            auto& to = newQEdges.primal_[i];
+            for (std::size_t j = 0; j < 4; ++j) {
+                to.next[j] = mapEdge(EdgeId(from.next[j])).get();
+            }
+            to.pt = QuadEdgeStorage::PointPair{{mapVertex(from.pt[0]), mapVertex(from.pt[1])}};
+        }
+        vtx = std::move(newVtx);
+        qedges = std::move(newQEdges);
+        freeQEdge = InvalidQuadEdge;
+        freePoint = InvalidVertex;
+        recentEdge = mapEdge(recentEdge);
+
+        validFaces = false;
+        faces.clear();
+        edgeFaces.clear();
+        if (hadVoronoi) {
+            computeVoronoi();
+        }
+        if (hadFaces) {
+            calcFaces();
         }
+        if (journal) {
+            journalChange(detail::JournalOp::Compact);
+        }
+        return vertexMap;
     }
 
     void Subdiv2D::initDelaunay(Rect rect) {
+        initBoundingVertices(rect);
+        initBoundingEdges();
+        if (journal) {
+            journalRect(detail::JournalOp::InitDelaunay, rect);
+        }
+    }
+
+    void Subdiv2D::initBoundingEdges() {
+        const auto pA = VertexId(1);
+        const auto pB = VertexId(2);
+        const auto pC = VertexId(3);
+
+        auto edge_AB = newEdge();
+        auto edge_BC = newEdge();
+        auto edge_CA = newEdge();
 
+        setEdgePoints(edge_AB, pA, pB);
+        setEdgePoints(edge_BC, pB, pC);
+        setEdgePoints(edge_CA, pC, pA);
+
+        splice(edge_AB, symEdge(edge_CA));
+        splice(edge_BC, symEdge(edge_AB));
+        splice(edge_CA, symEdge(edge_BC));
+
+        recentEdge = edge_AB;
+    }
+
+    /// How far the bounds may grow: within this, their corners are exact as floats.
+    static const int MaxBoundsCoord = 1 << 24;
+
+    /// Where the bounding vertices go for a rect.
+    static std::array<Point2f, 3> getBoundingVertexPositions(Rect rect) {
         float big_coord = 3.f * std::max(rect.width, rect.height);
         float rx = (float)rect.x;
         float ry = (float)rect.y;
+        return {{Point2f(rx + big_coord, ry), Point2f(rx, ry + big_coord), Point2f(rx - big_coord, ry - big_coord)}};
+    }
+
+    void Subdiv2D::initBoundingVertices(Rect rect) {
+
+        float rx = (float)rect.x;
+        float ry = (float)rect.y;
 
         vtx.clear();
         qedges.clear();
 
         recentEdge = InvalidEdge;
         validGeometry = false;
+        validFaces = false;
 
         topLeft = Point2f(rx, ry);
         bottomRight = Point2f(rx + rect.width, ry + rect.height);
 
-        Point2f ppA(rx + big_coord, ry);
-        Point2f ppB(rx, ry + big_coord);
-        Point2f ppC(rx - big_coord, ry - big_coord);
+        const auto pts = getBoundingVertexPositions(rect);
+        Point2f ppA = pts[0];
+        Point2f ppB = pts[1];
+        Point2f ppC = pts[2];
 
         // Vertex 0: null/dummy - 0 is an invalid vertex ID
         vtx.push_back(Vertex());
-        qedges.push_back(QuadEdge());
+        qedges.resize(1);
 
         freeQEdge = InvalidQuadEdge;
         freePoint = InvalidVertex;
 
         // Vertex 1: top, way past the right edge.
-        auto pA = newPoint(ppA, false);
+        newPoint(ppA, false);
         // Vertex 2: left, way past the bottom edge.
-        auto pB = newPoint(ppB, false);
+        newPoint(ppB, false);
         // Vertex 3: Way past the top-left corner
-        auto pC = newPoint(ppC, false);
+        newPoint(ppC, false);
+    }
 
-        auto edge_AB = newEdge();
-        auto edge_BC = newEdge();
-        auto edge_CA = newEdge();
+    Rect Subdiv2D::getBounds() const {
+        return Rect(static_cast<int>(topLeft.x), static_cast<int>(topLeft.y),
+                    static_cast<int>(bottomRight.x - topLeft.x), static_cast<int>(bottomRight.y - topLeft.y));
+    }
 
-        setEdgePoints(edge_AB, pA, pB);
-        setEdgePoints(edge_BC, pB, pC);
-        setEdgePoints(edge_CA, pC, pA);
+    void Subdiv2D::growBounds(Rect rect) {
+        growBoundsSub(rect);
+        if (journal) {
+            journalRect(detail::JournalOp::GrowBounds, rect);
+        }
+    }
 
-        splice(edge_AB, symEdge(edge_CA));
-        splice(edge_BC, symEdge(edge_AB));
-        splice(edge_CA, symEdge(edge_BC));
+    void Subdiv2D::growBoundsSub(Rect rect) {
+        if (qedges.size() < 4) {
+            Subdiv2D_Error(Error::StsError, "Subdivision is empty");
+        }
+        if (rect.x < -MaxBoundsCoord || rect.y < -MaxBoundsCoord || rect.width < 0 || rect.height < 0 ||
+            rect.width > MaxBoundsCoord - rect.x || rect.height > MaxBoundsCoord - rect.y) {
+            Subdiv2D_Error(Error::StsOutOfRange, "Bounds may only grow to +/- 2^24");
+        }
+        // Not with Rect's operator|, which tells an empty rect by its area: as an int, that overflows past 46341 on a
+        // side.
+        const auto bounds = getBounds();
+        if (rect.width == 0 || rect.height == 0) {
+            return;
+        }
+        const int left = std::min(bounds.x, rect.x);
+        const int top = std::min(bounds.y, rect.y);
+        const int right = std::max(bounds.x + bounds.width, rect.x + rect.width);
+        const int bottom = std::max(bounds.y + bounds.height, rect.y + rect.height);
+        const Rect grown(left, top, right - left, bottom - top);
+        if (grown == bounds) {
+            return;
+        }
+        topLeft = Point2f(static_cast<float>(grown.x), static_cast<float>(grown.y));
+        bottomRight = Point2f(static_cast<float>(grown.x + grown.width), static_cast<float>(grown.y + grown.height));
+
+        // Only the triangles around the bounding vertices change shape, so once they have moved, the flips there
+        // (and wherever those lead) make the triangulation Delaunay again.
+        const auto pts = getBoundingVertexPositions(grown);
+        bool moved = true;
+        for (int i = 0; i < 3 && moved; ++i) {
+            moved = moveBoundingVertex(VertexId(i + 1), pts[i]);
+        }
+        if (!moved) {
+            for (int i = 0; i < 3; ++i) {
+                vtx[i + 1].pt = pts[i];
+            }
+            retriangulate();
+        }
+    }
 
-        recentEdge = edge_AB;
+    bool Subdiv2D::moveBoundingVertex(VertexId vertex, Point2f pt) {
+        // Going straight there could turn triangles around the vertex inside out, where an edge of the hull points
+        // at it. Going as far as the kernel allows, then flipping, usually turns such edges aside.
+        const int MaxSteps = maxBoundingVertexSteps;
+        const float MinStep = 1.f / 1024;
+        for (int step = 0; step < MaxSteps; ++step) {
+            const auto from = getVertex(vertex);
+            auto to = pt;
+            for (float t = 1; !isInKernel(vertex, to);) {
+                t *= 0.5f;
+                if (t < MinStep) {
+                    return false;
+                }
+                to = from + (pt - from) * t;
+            }
+            relocateInKernel(vertex, to);
+            if (to == pt) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    void Subdiv2D::clearVoronoi() {
+    void Subdiv2D::growBoundsToInclude(Point2f lo, Point2f hi) {
+        const auto bounds = getBounds();
+        int left = bounds.x;
+        int top = bounds.y;
+        int right = bounds.x + bounds.width;
+        int bottom = bounds.y + bounds.height;
+        // Also keeps NaN and infinity from being converted to int.
+        const auto maxCoord = static_cast<float>(MaxBoundsCoord);
+        if (!(lo.x > -maxCoord && lo.y > -maxCoord && hi.x < maxCoord && hi.y < maxCoord)) {
+            Subdiv2D_Error(Error::StsOutOfRange, "Bounds may only grow to +/- 2^24");
+        }
+        // By half the size (or more) on each side that needs it: geometric growth, as for a vector.
+        const int growX = std::max(bounds.width / 2, 1);
+        const int growY = std::max(bounds.height / 2, 1);
+        if (lo.x < left) {
+            left = std::min(left - growX, static_cast<int>(std::floor(lo.x)));
+        }
+        if (lo.y < top) {
+            top = std::min(top - growY, static_cast<int>(std::floor(lo.y)));
+        }
+        if (hi.x >= right) {
+            right = std::max(right + growX, static_cast<int>(std::floor(hi.x)) + 1);
+        }
+        if (hi.y >= bottom) {
+            bottom = std::max(bottom + growY, static_cast<int>(std::floor(hi.y)) + 1);
+        }
+        left = std::max(left, -MaxBoundsCoord);
+        top = std::max(top, -MaxBoundsCoord);
+        right = std::min(right, MaxBoundsCoord);
+        bottom = std::min(bottom, MaxBoundsCoord);
+        growBoundsSub(Rect(left, top, right - left, bottom - top));
+    }
+
+    void Subdiv2D::retriangulate() {
+        const bool hadVoronoi = validGeometry;
+        const bool hadFaces = validFaces;
+        clearVoronoi();
+        validFaces = false;
+        faces.clear();
+        edgeFaces.clear();
+
+        std::vector<VertexId> ids;
+        std::vector<Point2f> pts;
+        for (std::size_t i = 1; i < vtx.size(); ++i) {
+            if (vtx[i].isfree()) {
+                continue;
+            }
+            vtx[i].firstEdge = InvalidEdge;
+            if (i >= 4) {
+                ids.push_back(VertexId(static_cast<int>(i)));
+                pts.push_back(vtx[i].pt);
+            }
+        }
+        qedges.clear();
+        qedges.resize(1);
+        freeQEdge = InvalidQuadEdge;
+        initBoundingEdges();
+        for (auto i : detail::brioOrder(pts.data(), pts.size(), topLeft, bottomRight)) {
+            insertSub(pts[i], ids[i]);
+        }
+
+        if (hadVoronoi) {
+            computeVoronoi();
+        }
+        if (hadFaces) {
+            calcFaces();
+        }
+    }
+
+    void Subdiv2D::setGrowableBounds(bool growable) {
+        growableBounds = growable;
+        if (journal) {
+            journalChange(detail::JournalOp::GrowableBounds, VertexId(growable ? 1 : 0));
+        }
+    }
+
+    bool Subdiv2D::hasGrowableBounds() const { return growableBounds; }
+
+    SubdivMode Subdiv2D::getMode() const {
+        return qedges.hasDual() ? SubdivMode::DelaunayAndVoronoi : SubdivMode::DelaunayOnly;
+    }
+
+    MemoryResource* Subdiv2D::getMemoryResource() const { return qedges.resource(); }
+
+    void Subdiv2D::reserve(std::size_t numPoints) {
+        vtx.reserve(numPoints + 4);
+        qedges.reserve(3 * numPoints + 10);
+    }
+
+    void Subdiv2D::setMemoryResource(MemoryResource* resource) {
+        const auto hasDual = qedges.hasDual();
+        vtx = decltype(vtx)(resource);
+        qedges = QuadEdgeStorage(resource);
+        qedges.setHasDual(hasDual);
+    }
+
+    bool Subdiv2D::isInBounds(Point2f const& pt) const {
+        return !(pt.x < topLeft.x || pt.y < topLeft.y || pt.x >= bottomRight.x || pt.y >= bottomRight.y);
+    }
 
-        for (auto& qedge : qedges) {
-            qedge.pt[1] = InvalidVertex;
-            qedge.pt[3] = InvalidVertex;
+    void Subdiv2D::clearVoronoi() {
+        if (!qedges.hasDual()) {
+            // No Voronoi points could have been added.
+            return;
         }
 
+        qedges.clearDual();
+
         const auto total = vtx.size();
         for (std::size_t i = 0; i < total; ++i) {
             if (vtx[i].isvirtual())
@@ -671,141 +1306,560 @@ namespace subdiv2d {
         return Point2f(Subdiv2D::MAX_VAL(), Subdiv2D::MAX_VAL());
     }
 
+    Point2f Subdiv2D::faceCircumcenter(EdgeId edge) const {
+        EdgeId edges[3];
+        edges[0] = edge;
+        edges[1] = getEdge(edges[0], NEXT_AROUND_LEFT);
+        edges[2] = getEdge(edges[1], NEXT_AROUND_LEFT);
+
+        // Start from the lowest vertex ID, so the point is the same (to the bit) whichever edge the face is reached by.
+        std::size_t first = 0;
+        for (std::size_t j = 1; j < 3; ++j) {
+            if (edgeOrg(edges[j]).get() < edgeOrg(edges[first]).get()) {
+                first = j;
+            }
+        }
+        Point2f org0, dst0, org1, dst1;
+        edgeOrg(edges[first], &org0);
+        edgeDst(edges[first], &dst0);
+        edgeOrg(edges[(first + 1) % 3], &org1);
+        edgeDst(edges[(first + 1) % 3], &dst1);
+
+        return computeVoronoiPoint(org0, dst0, org1, dst1);
+    }
+
+    static inline bool isRepresentable(Point2f const& virt_point) {
+        return std::abs(virt_point.x) < Subdiv2D::MAX_VAL() * 0.5 && std::abs(virt_point.y) < Subdiv2D::MAX_VAL() * 0.5;
+    }
+
+    void Subdiv2D::calcVoronoiFace(EdgeId edge) {
+        Point2f virt_point = faceCircumcenter(edge);
+
+        if (isRepresentable(virt_point)) {
+            auto edge1 = getEdge(edge, NEXT_AROUND_LEFT);
+            auto edge2 = getEdge(edge1, NEXT_AROUND_LEFT);
+            qedges.org(rotateEdge(edge, 3)) = qedges.org(rotateEdge(edge1, 3)) = qedges.org(rotateEdge(edge2, 3)) =
+                newPoint(virt_point, true);
+        }
+    }
+
     void Subdiv2D::calcVoronoi() {
         // check if it is already calculated
         if (validGeometry)
             return;
+        if (!qedges.hasDual()) {
+            Subdiv2D_Error(Error::StsError, "No Voronoi diagram in SubdivMode::DelaunayOnly");
+        }
 
         clearVoronoi();
-        // loop through all quad-edges, except for the first 3 (#1, #2, #3 - 0 is reserved for "NULL" pointer)
-        const auto total = qedges.size();
-        for (std::size_t i = 4; i < total; ++i) {
-            QuadEdge& quadedge = qedges[i];
+        computeVoronoi();
+        if (journal) {
+            journalChange(detail::JournalOp::CalcVoronoi);
+        }
+    }
 
-            if (quadedge.isfree()) {
+    void Subdiv2D::computeVoronoi() {
+        // loop through all quad-edges (0 is reserved for "NULL" pointer), except for those of the bounding triangle:
+        // the faces inside it are reached through their other edges, and the one outside it has no Voronoi vertex.
+        // (After initDelaunay() those are #1, #2, #3, but not after buildDelaunay().)
+        const auto total = qedges.size();
+        for (std::size_t i = 1; i < total; ++i) {
+            if (qedges.isfree(i)) {
+                continue;
+            }
+            auto const& primal = qedges.primal(i);
+            if (isVertexBoundary(primal[0]) && isVertexBoundary(primal[1])) {
                 continue;
             }
 
             auto edge0 = static_cast<EdgeId>(i * 4);
-            Point2f org0, dst0, org1, dst1;
+            auto const& dual = qedges.dual(i);
 
-            if (quadedge.pt[3] == InvalidVertex) {
-                auto edge1 = getEdge(edge0, NEXT_AROUND_LEFT);
-                auto edge2 = getEdge(edge1, NEXT_AROUND_LEFT);
+            // Left face, then right face.
+            if (!dual[1].valid()) {
+                calcVoronoiFace(edge0);
+            }
+            if (!dual[0].valid()) {
+                calcVoronoiFace(symEdge(edge0));
+            }
+        }
 
-                edgeOrg(edge0, &org0);
-                edgeDst(edge0, &dst0);
-                edgeOrg(edge1, &org1);
-                edgeDst(edge1, &dst1);
+        validGeometry = true;
+    }
 
-                Point2f virt_point = computeVoronoiPoint(org0, dst0, org1, dst1);
+    void Subdiv2D::updateVoronoiAround(VertexId vertex) {
+        // The faces around the vertex are exactly the ones the insertion created. Their edges' dual points are either
+        // unset (new edges) or refer to the Voronoi vertices of the faces the insertion destroyed: the other edges of
+        // those faces were deleted, or have become edges of this star.
+        clearVoronoiAround(vertex);
+        const auto first = getVertexInternal(vertex).firstEdge;
+        auto edge = first;
+        do {
+            calcVoronoiFace(edge);
+            edge = nextEdge(edge);
+        } while (edge != first);
+    }
 
-                if (std::abs(virt_point.x) < MAX_VAL() * 0.5 && std::abs(virt_point.y) < MAX_VAL() * 0.5) {
-                    quadedge.pt[3] = getQuadEdge(edge1).pt[3 - (edge1.get() & 2)] =
-                        getQuadEdge(edge2).pt[3 - (edge2.get() & 2)] = newPoint(virt_point, true);
+    void Subdiv2D::clearVoronoiAround(VertexId vertex) {
+        const auto first = getVertexInternal(vertex).firstEdge;
+        auto edge = first;
+        do {
+            VertexId* slots[] = {&qedges.org(rotateEdge(edge, 3)), &qedges.org(rotateEdge(edge, 1)),
+                                 &qedges.org(rotateEdge(getEdge(edge, NEXT_AROUND_LEFT), 3))};
+            for (auto slot : slots) {
+                // The same stale point is seen from several edges: only delete it the first time.
+                if (slot->valid() && !getVertexInternal(*slot).isfree()) {
+                    Subdiv2D_DbgAssert(getVertexInternal(*slot).isvirtual());
+                    deletePoint(*slot);
                 }
+                *slot = InvalidVertex;
             }
+            edge = nextEdge(edge);
+        } while (edge != first);
+    }
+
+    void Subdiv2D::clearVoronoiFace(EdgeId edge) {
+        auto vertex = qedges.org(rotateEdge(edge, 3));
+        if (vertex.valid() && !getVertexInternal(vertex).isfree()) {
+            Subdiv2D_DbgAssert(getVertexInternal(vertex).isvirtual());
+            deletePoint(vertex);
+        }
+        for (std::size_t i = 0; i < 3; ++i) {
+            qedges.org(rotateEdge(edge, 3)) = InvalidVertex;
+            edge = getEdge(edge, NEXT_AROUND_LEFT);
+        }
+    }
 
-            if (quadedge.pt[1].valid()) {
-                auto edge1 = getEdge(edge0, NEXT_AROUND_RIGHT);
-                auto edge2 = getEdge(edge1, NEXT_AROUND_RIGHT);
+    bool Subdiv2D::isLowestEdgeOfFace(EdgeId edge) const {
+        auto next = getEdge(edge, NEXT_AROUND_LEFT);
+        if (next.get() < edge.get()) {
+            return false;
+        }
+        next = getEdge(next, NEXT_AROUND_LEFT);
+        return next.get() > edge.get();
+    }
+
+    bool Subdiv2D::isOuterFace(VertexArray const& vertices) const {
+        // Only the outside of the bounding triangle is clockwise.
+        return isVertexBoundary(vertices[0]) && isVertexBoundary(vertices[1]) && isVertexBoundary(vertices[2]) &&
+               triangleOrientation(getVertex(vertices[0]), getVertex(vertices[1]), getVertex(vertices[2])) < 0;
+    }
+
+    void Subdiv2D::calcFaces() {
+        if (validFaces) {
+            return;
+        }
+        faces.clear();
+        edgeFaces.assign(qedges.size() * 2, InvalidFace);
+        for (detail::FaceIterationHelper helper(*this); helper; helper.advance()) {
+            Face face;
+            face.edge = helper.get();
+            auto edge = face.edge;
+            for (std::size_t i = 0; i < 3; ++i) {
+                face.vertices[i] = edgeOrg(edge);
+                edge = getEdge(edge, NEXT_AROUND_LEFT);
+            }
+            if (isOuterFace(face.vertices)) {
+                continue;
+            }
+            const auto id = FaceId(static_cast<std::uint32_t>(faces.size()));
+            for (std::size_t i = 0; i < 3; ++i) {
+                edgeFaces[faceSlot(edge)] = id;
+                edge = getEdge(edge, NEXT_AROUND_LEFT);
+            }
+            faces.push_back(face);
+        }
+        const auto n = faces.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            updateFaceNeighbors(FaceId(static_cast<std::uint32_t>(i)));
+        }
+        validFaces = true;
+    }
+
+    void Subdiv2D::updateFaceNeighbors(FaceId face) {
+        auto& f = faces[face.get()];
+        auto edge = f.edge;
+        for (std::size_t i = 0; i < 3; ++i) {
+            f.neighbors[i] = edgeFaces[faceSlot(symEdge(edge))];
+            edge = getEdge(edge, NEXT_AROUND_LEFT);
+        }
+    }
 
-                edgeOrg(edge0, &org0);
-                edgeDst(edge0, &dst0);
-                edgeOrg(edge1, &org1);
-                edgeDst(edge1, &dst1);
+    void Subdiv2D::updateFacesAround(VertexId vertex) {
+        // New quad-edges have no face yet; deleteEdge() cleared those of deleted ones.
+        edgeFaces.resize(qedges.size() * 2, InvalidFace);
+
+        // Every face the insertion replaced had an edge that is now either on the outside of the star around the
+        // vertex (those were not touched), or one of its spokes (swapped, so still mapping to the old faces).
+        SmallFaceVector replaced;
+        auto addReplaced = [&](EdgeId edge) {
+            auto face = edgeFaces[faceSlot(edge)];
+            if (face.valid() && std::find(replaced.begin(), replaced.end(), face) == replaced.end()) {
+                replaced.push_back(face);
+            }
+        };
+        const auto first = getVertexInternal(vertex).firstEdge;
+        auto edge = first;
+        do {
+            addReplaced(edge);
+            addReplaced(symEdge(edge));
+            addReplaced(getEdge(edge, NEXT_AROUND_LEFT));
+            edge = nextEdge(edge);
+        } while (edge != first);
+
+        // The star has two more faces than it replaced.
+        std::size_t numReused = 0;
+        do {
+            FaceId id;
+            if (numReused < replaced.size()) {
+                id = replaced[numReused++];
+            } else {
+                id = FaceId(static_cast<std::uint32_t>(faces.size()));
+                faces.emplace_back();
+            }
+            auto& f = faces[id.get()];
+            f.edge = edge;
+            auto faceEdge = edge;
+            for (std::size_t i = 0; i < 3; ++i) {
+                f.vertices[i] = edgeOrg(faceEdge);
+                edgeFaces[faceSlot(faceEdge)] = id;
+                faceEdge = getEdge(faceEdge, NEXT_AROUND_LEFT);
+            }
+            edge = nextEdge(edge);
+        } while (edge != first);
+        Subdiv2D_DbgAssert(numReused == replaced.size());
 
-                Point2f virt_point = computeVoronoiPoint(org0, dst0, org1, dst1);
+        // Then the neighbors, of the new faces and of those across the outside of the star.
+        do {
+            updateFaceNeighbors(edgeFaces[faceSlot(edge)]);
+            auto outside = edgeFaces[faceSlot(symEdge(getEdge(edge, NEXT_AROUND_LEFT)))];
+            if (outside.valid()) {
+                updateFaceNeighbors(outside);
+            }
+            edge = nextEdge(edge);
+        } while (edge != first);
+    }
 
-                if (std::abs(virt_point.x) < MAX_VAL() * 0.5 && std::abs(virt_point.y) < MAX_VAL() * 0.5) {
-                    quadedge.pt[1] = getQuadEdge(edge1).pt[1 + (edge1.get() & 2)] =
-                        getQuadEdge(edge2).pt[1 + (edge2.get() & 2)] = newPoint(virt_point, true);
+    void Subdiv2D::updateFacesAfterSwap(EdgeId edge, FaceId leftFace, FaceId rightFace) {
+        // The two faces keep their IDs, but not their vertices.
+        for (auto side : {std::make_pair(edge, leftFace), std::make_pair(symEdge(edge), rightFace)}) {
+            auto& f = faces[side.second.get()];
+            f.edge = side.first;
+            auto faceEdge = side.first;
+            for (std::size_t i = 0; i < 3; ++i) {
+                f.vertices[i] = edgeOrg(faceEdge);
+                edgeFaces[faceSlot(faceEdge)] = side.second;
+                faceEdge = getEdge(faceEdge, NEXT_AROUND_LEFT);
+            }
+        }
+        for (auto face : {leftFace, rightFace}) {
+            updateFaceNeighbors(face);
+            for (auto neighbor : faces[face.get()].neighbors) {
+                if (neighbor.valid()) {
+                    updateFaceNeighbors(neighbor);
                 }
             }
         }
+    }
 
-        validGeometry = true;
+    void Subdiv2D::checkFace(FaceId face) const {
+        if (!validFaces) {
+            Subdiv2D_Error(Error::StsError, "Face table is out of date: call calcFaces() first");
+        }
+        if (!face.valid() || face.get() >= faces.size()) {
+            Subdiv2D_Error(Error::StsOutOfRange, "Invalid face ID");
+        }
     }
 
-    static int isRightOf2(const Point2f& pt, const Point2f& org, const Point2f& diff) {
-        double cw_area = ((double)org.x - pt.x) * diff.y - ((double)org.y - pt.y) * diff.x;
-        return (cw_area > 0) - (cw_area < 0);
+    std::size_t Subdiv2D::getNumFaces() const {
+        if (!validFaces) {
+            Subdiv2D_Error(Error::StsError, "Face table is out of date: call calcFaces() first");
+        }
+        return faces.size();
     }
 
-    VertexId Subdiv2D::findNearest(Point2f pt, Point2f* nearestPt) {
+    VertexArray const& Subdiv2D::getFaceVertices(FaceId face) const {
+        checkFace(face);
+        return faces[face.get()].vertices;
+    }
 
-        if (!validGeometry) {
-            calcVoronoi();
+    std::array<FaceId, 3> const& Subdiv2D::getFaceNeighbors(FaceId face) const {
+        checkFace(face);
+        return faces[face.get()].neighbors;
+    }
+
+    EdgeId Subdiv2D::getFaceEdge(FaceId face) const {
+        checkFace(face);
+        return faces[face.get()].edge;
+    }
+
+    FaceId Subdiv2D::getEdgeFace(EdgeId edge) const {
+        if (!validFaces) {
+            Subdiv2D_Error(Error::StsError, "Face table is out of date: call calcFaces() first");
+        }
+        if (!edge.valid() || static_cast<std::size_t>(edge.get()) >= getMaxNumEdges() || (edge.get() & 1)) {
+            Subdiv2D_Error(Error::StsBadArg, "Not a Delaunay edge");
         }
+        return edgeFaces[faceSlot(edge)];
+    }
 
-        VertexId vertex = InvalidVertex;
-        EdgeId edge = InvalidEdge;
-        auto loc = locate(pt, edge, vertex);
+    /// Batches smaller than this are located in input order: sorting them would cost more than it saves.
+    static const std::size_t MinBatchReorderSize = 32;
 
-        if (loc != PtLoc::PTLOC_ON_EDGE && loc != PtLoc::PTLOC_INSIDE) {
-            return vertex;
+    void Subdiv2D::locateBatch(Point2f const* pts, std::size_t n, PtLoc* outLocs, EdgeId* outEdges,
+                               VertexArray* outVertices, LocateCursor* cursor) const {
+        LocateCursor localCursor;
+        if (!cursor) {
+            cursor = &localCursor;
+        }
+        auto locateOne = [&](std::size_t i) {
+            detail::LocateSubResults result;
+            if (isInBounds(pts[i])) {
+                result = locateSub(pts[i], cursor);
+            } else {
+                result.locateStatus = PtLoc::PTLOC_OUTSIDE_RECT;
+            }
+            if (outLocs) {
+                outLocs[i] = result.locateStatus;
+            }
+            if (outEdges) {
+                outEdges[i] = result.getEdge();
+            }
+            if (outVertices) {
+                outVertices[i] = result.getVertices();
+            }
+        };
+        if (n < MinBatchReorderSize) {
+            for (std::size_t i = 0; i < n; ++i) {
+                locateOne(i);
+            }
+            return;
+        }
+        for (auto i : detail::hilbertOrder(pts, n, topLeft, bottomRight)) {
+            locateOne(i);
         }
+    }
 
-        vertex = InvalidVertex;
+    static inline double squaredDistance(Point2f const& a, Point2f const& b) {
+        const double dx = (double)a.x - b.x;
+        const double dy = (double)a.y - b.y;
+        return dx * dx + dy * dy;
+    }
 
-        Point2f start;
-        edgeOrg(edge, &start);
-        Point2f diff = pt - start;
+    VertexId Subdiv2D::findNearestByDescent(Point2f pt, EdgeId edge) const {
+        // Start from the nearer end of the located edge, then move to any closer neighbor until there is none: the
+        // Delaunay neighbors of a vertex include all of its Voronoi neighbors, so that vertex is the nearest.
+        Point2f org, dst;
+        edgeOrg(edge, &org);
+        edgeDst(edge, &dst);
+        if (squaredDistance(pt, dst) < squaredDistance(pt, org)) {
+            edge = symEdge(edge);
+        }
+        Point2f best;
+        VertexId vertex = edgeOrg(edge, &best);
+        double bestDist = squaredDistance(pt, best);
+        bool moved = true;
+        while (moved) {
+            moved = false;
+            const auto first = edge;
+            do {
+                Point2f t;
+                edgeDst(edge, &t);
+                const double dist = squaredDistance(pt, t);
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    edge = symEdge(edge);
+                    vertex = edgeOrg(edge);
+                    moved = true;
+                    break;
+                }
+                edge = nextEdge(edge);
+            } while (edge != first);
+        }
+        return vertex;
+    }
 
-        edge = rotateEdge(edge, 1);
+    VertexId Subdiv2D::findNearestSub(Point2f pt, LocateCursor* cursor) const {
+        auto result = locateSub(pt, cursor);
+        if (result.locateStatus == PtLoc::PTLOC_ON_EDGE || result.locateStatus == PtLoc::PTLOC_INSIDE) {
+            return findNearestByDescent(pt, result.getEdge());
+        }
+        return result.numVertices() == 1 ? result.getVertices().front() : InvalidVertex;
+    }
 
-        const auto total = vtx.size();
-        for (std::size_t i = 0; i < total; ++i) {
-            Point2f t;
+    VertexId Subdiv2D::findNearest(Point2f pt, Point2f* nearestPt, LocateCursor* cursor) const {
+        auto vertex = findNearestSub(pt, cursor);
+        if (nearestPt && vertex.valid()) {
+            *nearestPt = getVertex(vertex);
+        }
+        return vertex;
+    }
 
-            for (;;) {
-                Subdiv2D_Assert(edgeDst(edge, &t).valid());
-                if (isRightOf2(t, start, diff) >= 0)
-                    break;
+    /// Queries per block of findNearestBatch(): enough for the walks between them to be short, few enough that their keys
+    /// fit comfortably on the stack.
+    static const std::size_t NearestBatchBlockSize = 1024;
 
-                edge = getEdge(edge, NEXT_AROUND_LEFT);
+    void Subdiv2D::findNearestBatch(Point2f const* pts, std::size_t n, VertexId* outVertices,
+                                    LocateCursor* cursor) const {
+        LocateCursor localCursor;
+        if (!cursor) {
+            cursor = &localCursor;
+        }
+        // Each block is answered in order along a Hilbert curve, sorting its keys on the stack rather than allocating.
+        std::array<std::uint64_t, NearestBatchBlockSize> order;
+        const detail::HilbertKeyMaker keyMaker(topLeft, bottomRight);
+        for (std::size_t begin = 0; begin < n; begin += NearestBatchBlockSize) {
+            const auto count = std::min(n - begin, NearestBatchBlockSize);
+            for (std::size_t i = 0; i < count; ++i) {
+                order[i] = (std::uint64_t(keyMaker(pts[begin + i])) << 32) | std::uint64_t(i);
             }
+            std::sort(order.begin(), order.begin() + count);
+            for (std::size_t k = 0; k < count; ++k) {
+                const auto i = begin + static_cast<std::size_t>(order[k] & 0xffffffffu);
+                outVertices[i] = isInBounds(pts[i]) ? findNearestSub(pts[i], cursor) : InvalidVertex;
+            }
+        }
+    }
 
-            for (;;) {
-                Subdiv2D_Assert(edgeOrg(edge, &t).valid());
+    void NeighborSearchScratch::reset() {
+        heap_.clear();
+        for (auto slot : seenSlots_) {
+            seen_[slot] = InvalidVertex;
+        }
+        seenSlots_.clear();
+    }
 
-                if (isRightOf2(t, start, diff) < 0)
-                    break;
+    static inline std::size_t hashVertex(VertexId vertex, std::size_t mask) {
+        return (static_cast<std::size_t>(vertex.get()) * 2654435761u) & mask;
+    }
 
-                edge = getEdge(edge, PREV_AROUND_LEFT);
+    bool NeighborSearchScratch::markSeen(VertexId vertex) {
+        // Keep the table at most half full.
+        if (2 * (seenSlots_.size() + 1) > seen_.size()) {
+            growSeen();
+        }
+        const auto mask = seen_.size() - 1;
+        for (auto slot = hashVertex(vertex, mask);; slot = (slot + 1) & mask) {
+            if (seen_[slot] == vertex) {
+                return false;
             }
+            if (!seen_[slot].valid()) {
+                seen_[slot] = vertex;
+                seenSlots_.push_back(slot);
+                return true;
+            }
+        }
+    }
 
-            Point2f tempDiff;
-            edgeDst(edge, &tempDiff);
-            edgeOrg(edge, &t);
-            tempDiff -= t;
+    void NeighborSearchScratch::growSeen() {
+        std::vector<VertexId> old;
+        old.swap(seen_);
+        seen_.assign(std::max(std::size_t(64), 2 * old.size()), InvalidVertex);
+        const auto mask = seen_.size() - 1;
+        std::vector<std::size_t> oldSlots;
+        oldSlots.swap(seenSlots_);
+        for (auto oldSlot : oldSlots) {
+            auto slot = hashVertex(old[oldSlot], mask);
+            while (seen_[slot].valid()) {
+                slot = (slot + 1) & mask;
+            }
+            seen_[slot] = old[oldSlot];
+            seenSlots_.push_back(slot);
+        }
+    }
+
+    template <typename F>
+    void Subdiv2D::visitNeighborsBestFirst(Point2f pt, double maxDist2, NeighborSearchScratch& scratch,
+                                           LocateCursor* cursor, F&& visit) const {
+        using Candidate = NeighborSearchScratch::Candidate;
+        auto farther = [](Candidate const& a, Candidate const& b) { return a.dist > b.dist; };
+        auto& heap = scratch.heap_;
+        scratch.reset();
 
-            if (isRightOf2(pt, t, tempDiff) >= 0) {
-                vertex = edgeOrg(rotateEdge(edge, 3));
+        if (!isInBounds(pt)) {
+            Subdiv2D_Error(Error::StsOutOfRange, "");
+        }
+        const auto start = findNearestSub(pt, cursor);
+        if (!start.valid()) {
+            return;
+        }
+        scratch.markSeen(start);
+        heap.push_back(Candidate{squaredDistance(pt, getVertex(start)), start});
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), farther);
+            const auto current = heap.back();
+            heap.pop_back();
+            if (current.dist > maxDist2) {
+                // Only the start can be out here: nothing else farther is ever added.
                 break;
             }
-
-            edge = symEdge(edge);
+            // The bounding vertices are never results, but paths to results may pass through them.
+            if (!isVertexBoundary(current.vertex) && !visit(current.vertex)) {
+                break;
+            }
+            const auto first = getVertexInternal(current.vertex).firstEdge;
+            auto edge = first;
+            do {
+                Point2f t;
+                const auto neighbor = edgeDst(edge, &t);
+                if (scratch.markSeen(neighbor)) {
+                    const auto dist = squaredDistance(pt, t);
+                    if (dist <= maxDist2) {
+                        heap.push_back(Candidate{dist, neighbor});
+                        std::push_heap(heap.begin(), heap.end(), farther);
+                    }
+                }
+                edge = nextEdge(edge);
+            } while (edge != first);
         }
+    }
 
-        if (nearestPt && vertex.valid()) {
-            *nearestPt = getVertex(vertex);
+    std::size_t Subdiv2D::findKNearest(Point2f pt, std::size_t k, VertexId* outVertices,
+                                       NeighborSearchScratch* scratch, LocateCursor* cursor) const {
+        if (k == 0) {
+            return 0;
         }
+        NeighborSearchScratch localScratch;
+        if (!scratch) {
+            scratch = &localScratch;
+        }
+        std::size_t count = 0;
+        visitNeighborsBestFirst(pt, std::numeric_limits<double>::infinity(), *scratch, cursor, [&](VertexId vertex) {
+            outVertices[count++] = vertex;
+            return count < k;
+        });
+        return count;
+    }
 
-        return vertex;
+    void Subdiv2D::findWithinRadius(Point2f pt, float radius, std::vector<VertexId>& outVertices,
+                                    NeighborSearchScratch* scratch, LocateCursor* cursor) const {
+        outVertices.clear();
+        if (!(radius >= 0)) {
+            return;
+        }
+        NeighborSearchScratch localScratch;
+        if (!scratch) {
+            scratch = &localScratch;
+        }
+        const double maxDist2 = (double)radius * radius;
+        visitNeighborsBestFirst(pt, maxDist2, *scratch, cursor, [&](VertexId vertex) {
+            outVertices.push_back(vertex);
+            return true;
+        });
     }
 
     void Subdiv2D::getEdgeList(std::vector<Edge>& edgeList) const {
         edgeList.clear();
         const auto n = qedges.size();
         for (size_t i = 4; i < n; ++i) {
-            if (qedges[i].isfree()) {
+            if (qedges.isfree(i)) {
                 continue;
             }
-            const auto& qedge = qedges[i];
-            if (qedge.pt[0].valid() && qedge.pt[2].valid()) {
-                Point2f org = getVertex(qedge.pt[0]);
-                Point2f dst = getVertex(qedge.pt[2]);
+            const auto& primal = qedges.primal(i);
+            if (primal[0].valid() && primal[1].valid()) {
+                Point2f org = getVertex(primal[0]);
+                Point2f dst = getVertex(primal[1]);
                 edgeList.push_back(Edge{org, dst});
             }
         }
@@ -821,38 +1875,194 @@ namespace subdiv2d {
 
     void Subdiv2D::getLeadingEdgeList(std::vector<EdgeId>& leadingEdgeList) const {
         leadingEdgeList.clear();
-        for (detail::EdgeIterationHelper helper(qedges, 4, 2); helper; helper.advance()) {
-            auto edge = helper.get();
-            leadingEdgeList.push_back(edge);
-            edge = getEdge(edge, NEXT_AROUND_LEFT);
-            helper.markVisited(edge);
-            edge = getEdge(edge, NEXT_AROUND_LEFT);
-            helper.markVisited(edge);
+        for (detail::FaceIterationHelper helper(*this); helper; helper.advance()) {
+            leadingEdgeList.push_back(helper.get());
         }
     }
 
     void Subdiv2D::getTriangleList(std::vector<Triangle>& triangleList) const {
         triangleList.clear();
-        for (detail::EdgeIterationHelper helper(qedges, 4, 2); helper; helper.advance()) {
+        for (detail::FaceIterationHelper helper(*this); helper; helper.advance()) {
             auto edge = helper.get();
             Point2f a, b, c;
             edgeOrg(edge, &a);
 
             edge = getEdge(edge, NEXT_AROUND_LEFT);
-            helper.markVisited(edge);
             edgeOrg(edge, &b);
 
             edge = getEdge(edge, NEXT_AROUND_LEFT);
-            helper.markVisited(edge);
             edgeOrg(edge, &c);
 
             triangleList.push_back(Triangle{{a, b, c}});
         }
     }
 
+    Subdiv2D::Edge Subdiv2D::EdgeView::positions() const {
+        return Edge{subdiv_->vtx[org.get()].pt, subdiv_->vtx[dst.get()].pt};
+    }
+
+    Subdiv2D::Triangle Subdiv2D::TriangleView::positions() const {
+        auto const& v = subdiv_->vtx;
+        return Triangle{{v[vertices[0].get()].pt, v[vertices[1].get()].pt, v[vertices[2].get()].pt}};
+    }
+
+    template <> Subdiv2D::VertexView Subdiv2D::ElementIterator<Subdiv2D::VertexView>::operator*() const {
+        VertexView ret;
+        ret.id = VertexId(static_cast<int>(i_));
+        ret.subdiv_ = subdiv_;
+        return ret;
+    }
+
+    template <> bool Subdiv2D::ElementIterator<Subdiv2D::VertexView>::skip() const {
+        auto const& v = subdiv_->vtx[i_];
+        return v.isfree() || (v.isvirtual() && hasFilter(filter_, ElementFilter::SkipVirtual)) ||
+               (hasFilter(filter_, ElementFilter::SkipBoundary) && isVertexBoundary(VertexId(static_cast<int>(i_))));
+    }
+
+    template <> Subdiv2D::EdgeView Subdiv2D::ElementIterator<Subdiv2D::EdgeView>::operator*() const {
+        auto const& primal = subdiv_->qedges.primal(i_);
+        EdgeView ret;
+        ret.id = EdgeId(static_cast<int>(i_ * 4));
+        ret.org = primal[0];
+        ret.dst = primal[1];
+        ret.subdiv_ = subdiv_;
+        return ret;
+    }
+
+    template <> bool Subdiv2D::ElementIterator<Subdiv2D::EdgeView>::skip() const {
+        if (subdiv_->qedges.isfree(i_)) {
+            return true;
+        }
+        auto const& primal = subdiv_->qedges.primal(i_);
+        return !primal[0].valid() || !primal[1].valid() ||
+               (hasFilter(filter_, ElementFilter::SkipBoundary) &&
+                (isVertexBoundary(primal[0]) || isVertexBoundary(primal[1])));
+    }
+
+    template <> Subdiv2D::TriangleView Subdiv2D::ElementIterator<Subdiv2D::TriangleView>::operator*() const {
+        TriangleView ret;
+        ret.edge = EdgeId(static_cast<int>(i_));
+        auto edge = ret.edge;
+        for (std::size_t i = 0; i < 3; ++i) {
+            ret.vertices[i] = subdiv_->edgeOrg(edge);
+            edge = subdiv_->getEdge(edge, NEXT_AROUND_LEFT);
+        }
+        ret.subdiv_ = subdiv_;
+        return ret;
+    }
+
+    template <> bool Subdiv2D::ElementIterator<Subdiv2D::TriangleView>::skip() const {
+        const auto edge = EdgeId(static_cast<int>(i_));
+        if (subdiv_->qedges.isfree(i_ / 4) || !subdiv_->isLowestEdgeOfFace(edge)) {
+            return true;
+        }
+        VertexArray vertices;
+        auto faceEdge = edge;
+        for (std::size_t i = 0; i < 3; ++i) {
+            vertices[i] = subdiv_->edgeOrg(faceEdge);
+            faceEdge = subdiv_->getEdge(faceEdge, NEXT_AROUND_LEFT);
+        }
+        if (hasFilter(filter_, ElementFilter::SkipBoundary)) {
+            return std::any_of(vertices.begin(), vertices.end(), [](VertexId v) { return isVertexBoundary(v); });
+        }
+        return subdiv_->isOuterFace(vertices);
+    }
+
+    Subdiv2D::VertexRange Subdiv2D::vertices(ElementFilter filter) const {
+        // Vertex 0 and quad-edge 0 are placeholders.
+        using Iterator = ElementIterator<VertexView>;
+        const auto n = vtx.size();
+        return VertexRange(Iterator(*this, std::min<std::size_t>(1, n), n, 1, filter),
+                           Iterator(*this, n, n, 1, filter));
+    }
+
+    Subdiv2D::EdgeRange Subdiv2D::edges(ElementFilter filter) const {
+        using Iterator = ElementIterator<EdgeView>;
+        const auto n = qedges.size();
+        return EdgeRange(Iterator(*this, std::min<std::size_t>(1, n), n, 1, filter), Iterator(*this, n, n, 1, filter));
+    }
+
+    Subdiv2D::TriangleRange Subdiv2D::triangles(ElementFilter filter) const {
+        using Iterator = ElementIterator<TriangleView>;
+        const auto n = qedges.size() * 4;
+        return TriangleRange(Iterator(*this, std::min<std::size_t>(4, n), n, 2, filter),
+                             Iterator(*this, n, n, 2, filter));
+    }
+
+    void Subdiv2D::getIndexedMesh(IndexedMesh& mesh, bool includeBoundary) const {
+        static const auto NotExported = std::numeric_limits<std::uint32_t>::max();
+        mesh.vertices.clear();
+        mesh.vertexIds.clear();
+        mesh.indices.clear();
+
+        const auto n = vtx.size();
+        Subdiv2D_Assert(n <= NotExported);
+        mesh.remap_.assign(n, NotExported);
+        for (std::size_t i = 1; i < n; ++i) {
+            auto const& v = vtx[i];
+            const auto vertex = VertexId(static_cast<int>(i));
+            if (v.isfree() || v.isvirtual() || (!includeBoundary && isVertexBoundary(vertex))) {
+                continue;
+            }
+            mesh.remap_[i] = static_cast<std::uint32_t>(mesh.vertices.size());
+            mesh.vertices.push_back(v.pt);
+            mesh.vertexIds.push_back(vertex);
+        }
+
+        for (detail::FaceIterationHelper helper(*this); helper; helper.advance()) {
+            auto edge = helper.get();
+            const auto a = edgeOrg(edge);
+
+            edge = getEdge(edge, NEXT_AROUND_LEFT);
+            const auto b = edgeOrg(edge);
+
+            edge = getEdge(edge, NEXT_AROUND_LEFT);
+            const auto c = edgeOrg(edge);
+
+            // With no points inserted, the bounding triangle itself is a face of only bounding vertices too: only the
+            // clockwise one is the outside.
+            if (isOuterFace(VertexArray{{a, b, c}})) {
+                continue;
+            }
+            const auto ia = mesh.remap_[a.get()];
+            const auto ib = mesh.remap_[b.get()];
+            const auto ic = mesh.remap_[c.get()];
+            if (ia == NotExported || ib == NotExported || ic == NotExported) {
+                continue;
+            }
+            mesh.indices.push_back(ia);
+            mesh.indices.push_back(ib);
+            mesh.indices.push_back(ic);
+        }
+    }
+
+    void Subdiv2D::getVoronoiFacet(VertexId vertex, std::vector<Point2f>& facet) const {
+        facet.clear();
+        if (!vertex.valid() || static_cast<std::size_t>(vertex.get()) >= vtx.size()) {
+            Subdiv2D_Error(Error::StsBadArg, "Not a vertex of the triangulation");
+        }
+        auto const& v = getVertexInternal(vertex);
+        if (v.isfree() || v.isvirtual() || !v.firstEdge.valid()) {
+            Subdiv2D_Error(Error::StsBadArg, "Not a vertex of the triangulation");
+        }
+        // The faces around the vertex, in the same order as the stored diagram's: the right face of each edge out of
+        // it, counterclockwise.
+        const auto first = v.firstEdge;
+        auto edge = first;
+        do {
+            auto virt_point = faceCircumcenter(symEdge(edge));
+            facet.push_back(isRepresentable(virt_point) ? virt_point : Point2f(MAX_VAL(), MAX_VAL()));
+            edge = nextEdge(edge);
+        } while (edge != first);
+    }
+
     void Subdiv2D::getVoronoiFacetList(const std::vector<VertexId>& idx, std::vector<std::vector<Point2f> >& facetList,
                                        std::vector<Point2f>& facetCenters) {
-        calcVoronoi();
+        // Computing the whole diagram only pays off when all of it is wanted, and only when it can be kept.
+        const bool lazy = !validGeometry && (!idx.empty() || !qedges.hasDual());
+        if (!lazy) {
+            calcVoronoi();
+        }
         facetList.clear();
         facetCenters.clear();
 
@@ -872,15 +2082,20 @@ namespace subdiv2d {
             if (vertex.isfree() || vertex.isvirtual()) {
                 continue;
             }
-            auto edge = rotateEdge(vertex.firstEdge, 1);
-            auto t = edge;
-
-            // gather points
-            buf.clear();
-            do {
-                buf.push_back(getVertex(edgeOrg(t)));
-                t = getEdge(t, NEXT_AROUND_LEFT);
-            } while (t != edge);
+            if (lazy) {
+                getVoronoiFacet(k, buf);
+            } else {
+                auto edge = rotateEdge(vertex.firstEdge, 1);
+                auto t = edge;
+
+                // gather points
+                buf.clear();
+                do {
+                    auto virt = edgeOrg(t);
+                    buf.push_back(virt.valid() ? getVertex(virt) : Point2f(MAX_VAL(), MAX_VAL()));
+                    t = getEdge(t, NEXT_AROUND_LEFT);
+                } while (t != edge);
+            }
 
             facetList.push_back(buf);
             facetCenters.push_back(getVertex(k));
@@ -890,10 +2105,8 @@ namespace subdiv2d {
     void Subdiv2D::checkSubdiv() const {
 
         const auto total = qedges.size();
-        for (std::size_t i = 0; i < total; i) {
-            const QuadEdge& qe = qedges[i];
-
-            if (qe.isfree())
+        for (std::size_t i = 0; i < total; ++i) {
+            if (qedges.isfree(i))
                 continue;
 
             for (std::size_t j = 0; j < 4; ++j) {
@@ -932,23 +2145,22 @@ namespace subdiv2d {
         Subdiv2D_DbgAssert(static_cast<size_t>(vertex.get()) < vtx.size());
     }
 
-    static inline float simpleAbsPointDistance(Point2f const& a, Point2f const& b) {
-        // think this is the manhattan distance...
-        auto diff = a - b;
-        return std::abs(diff.x) + std::abs(diff.y);
-    }
-
-    detail::LocateSubResults Subdiv2D::locateSub(Point2f const& pt) {
+    detail::LocateSubResults Subdiv2D::locateSub(Point2f const& pt, LocateCursor* cursor) const {
         if (qedges.size() < 4) {
             Subdiv2D_Error(Error::StsError, "Subdivision is empty");
         }
-        if (pt.x < topLeft.x || pt.y < topLeft.y || pt.x >= bottomRight.x || pt.y >= bottomRight.y) {
+        if (!isInBounds(pt)) {
             Subdiv2D_Error(Error::StsOutOfRange, "");
         }
 
         detail::LocateSubResults ret;
         {
+            // Start from the cursor's edge, unless it has been deleted since.
             auto edge = recentEdge;
+            if (cursor && cursor->edge_.valid() && static_cast<std::size_t>(cursor->edge_.get()) < getMaxNumEdges() &&
+                !qedges.isfree(getQuadEdgeId(cursor->edge_).get())) {
+                edge = cursor->edge_;
+            }
             Subdiv2D_Assert(edge.valid());
 
             auto right_of_curr = isRightOf(pt, edge);
@@ -1008,7 +2220,9 @@ namespace subdiv2d {
                 }
             }
 
-            recentEdge = edge;
+            if (cursor) {
+                cursor->edge_ = edge;
+            }
         }
         if (ret.locateStatus != PtLoc::PTLOC_INSIDE) {
             // no further refinement.
@@ -1032,8 +2246,7 @@ namespace subdiv2d {
                 ret.locateStatus = PtLoc::PTLOC_VERTEX;
                 ret.setVertices({dstId});
                 ret.setEdges();
-            } else if ((orgDist < edgeDist || dstDist < edgeDist) &&
-                       std::abs(doubleTriangleArea(pt, org_pt, dst_pt)) < EPSILON()) {
+            } else if ((orgDist < edgeDist || dstDist < edgeDist) && triangleOrientation(pt, org_pt, dst_pt) == 0) {
                 ret.locateStatus = PtLoc::PTLOC_ON_EDGE;
                 ret.setEdges(ret.getEdge());
                 ret.setVertices({orgId, dstId});
@@ -1061,14 +2274,6 @@ namespace subdiv2d {
         return ret;
     }
 
-    Subdiv2D::QuadEdge& Subdiv2D::getQuadEdge(EdgeId edge) { return qedges[getQuadEdgeId(edge).get()]; }
-
-    Subdiv2D::QuadEdge const& Subdiv2D::getQuadEdge(EdgeId edge) const { return qedges[getQuadEdgeId(edge).get()]; }
-
-    Subdiv2D::QuadEdge& Subdiv2D::getQuadEdge(QuadEdgeId qedge) { return qedges[qedge.get()]; }
-
-    Subdiv2D::QuadEdge const& Subdiv2D::getQuadEdge(QuadEdgeId qedge) const { return qedges[qedge.get()]; }
-
     Subdiv2D::Vertex& Subdiv2D::getVertexInternal(VertexId vertex) { return vtx[vertex.get()]; }
 
     Subdiv2D::Vertex const& Subdiv2D::getVertexInternal(VertexId vertex) const { return vtx[vertex.get()]; }
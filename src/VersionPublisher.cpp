@@ -0,0 +1,125 @@
+/** @file
+    @brief Implementation of the epoch-based reclamation behind VersionPublisher.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+*/
+
+// Copyright 2017 Sensics, Inc.
+// SPDX-License-Identifier:BSD-3-Clause
+
+// Internal Includes
+#include "subdiv2d/VersionPublisher.h"
+#include "subdiv2d/AssertAndError.h"
+
+// Library/third-party includes
+// - none
+
+// Standard includes
+#include <algorithm>
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        VersionNode::~VersionNode() {}
+
+        // The orderings that matter are sequentially consistent: a reader's store to its slot comes before its load
+        // of current_, and a writer's swap of current_ comes before its advance of epoch_. So if a reader got the old
+        // version, it read epoch_ before the advance, and a writer scanning the slots afterward sees that epoch (or
+        // a release).
+
+        PublisherBase::PublisherBase(std::unique_ptr<VersionNode> initial) : current_(initial.release()) {
+            current_.load()->number = 1;
+        }
+
+        PublisherBase::~PublisherBase() {
+            Subdiv2D_DbgAssert(std::none_of(slots_.begin(), slots_.end(),
+                                            [](std::unique_ptr<PaddedSlot> const& slot) { return slot->inUse; }));
+            delete current_.load();
+        }
+
+        std::uint64_t PublisherBase::currentVersion() const { return currentNumber_.load(); }
+
+        std::uint64_t PublisherBase::publishNode(std::unique_ptr<VersionNode> node) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto number = current_.load()->number + 1;
+            node->number = number;
+            std::unique_ptr<VersionNode> old(current_.exchange(node.release()));
+            // After the swap, so a reader seeing this number pins this version or a newer one.
+            currentNumber_.store(number);
+            retired_.push_back(Retired{epoch_.fetch_add(1), std::move(old)});
+            reclaimLocked();
+            return number;
+        }
+
+        std::pair<VersionNode const*, std::unique_lock<std::mutex> > PublisherBase::lockCurrent() const {
+            // Only writers retire and delete versions, with the mutex held, so holding it keeps the current one.
+            std::unique_lock<std::mutex> lock(mutex_);
+            VersionNode const* current = current_.load();
+            return std::make_pair(current, std::move(lock));
+        }
+
+        std::size_t PublisherBase::reclaim() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return reclaimLocked();
+        }
+
+        std::size_t PublisherBase::reclaimLocked() {
+            if (retired_.empty()) {
+                return 0;
+            }
+            // The oldest epoch any reader may have pinned in: versions retired before it are unreachable.
+            auto oldest = epoch_.load();
+            for (auto const& slot : slots_) {
+                const auto pinned = slot->epoch.load();
+                if (pinned != 0) {
+                    oldest = std::min(oldest, pinned);
+                }
+            }
+            retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                          [&](Retired const& retired) { return retired.epoch < oldest; }),
+                           retired_.end());
+            return retired_.size();
+        }
+
+        std::size_t PublisherBase::numRetired() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return retired_.size();
+        }
+
+        ReaderSlot* PublisherBase::registerReader() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find_if(slots_.begin(), slots_.end(),
+                                   [](std::unique_ptr<PaddedSlot> const& slot) { return !slot->inUse; });
+            if (it == slots_.end()) {
+                slots_.emplace_back(new PaddedSlot);
+                it = slots_.end() - 1;
+            }
+            (*it)->inUse = true;
+            return &(*it)->epoch;
+        }
+
+        void PublisherBase::unregisterReader(ReaderSlot* slot) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& s : slots_) {
+                if (&s->epoch == slot) {
+                    s->epoch.store(0);
+                    s->inUse = false;
+                    return;
+                }
+            }
+        }
+
+        VersionNode const* PublisherBase::pin(ReaderSlot& slot) const {
+            if (slot.load(std::memory_order_relaxed) != 0) {
+                Subdiv2D_Error(Error::StsError, "This reader already has a version pinned: release it first");
+            }
+            slot.store(epoch_.load());
+            return current_.load();
+        }
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
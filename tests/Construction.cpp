@@ -0,0 +1,584 @@
+/** @file
+    @brief Tests
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#include <subdiv2d/Predicates.h>
+#include <subdiv2d/Subdivision2D.h>
+
+#include "TestPoints.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <tuple>
+
+using namespace sensics::subdiv2d;
+
+TEST_CASE("Bulk insertion", "[Subdivision2d]") {
+    const auto pts = makeRandomPoints(500, 99.f);
+    Subdiv2D subdiv(Rect(0, 0, 100, 100));
+    auto ids = subdiv.insert(pts);
+    REQUIRE(ids.size() == pts.size());
+    THEN("each returned ID should be the vertex for the input point at the same position") {
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(ids[i].valid());
+            REQUIRE(subdiv.getVertex(ids[i]) == pts[i]);
+        }
+    }
+    THEN("inserting the same points again should give the same IDs") {
+        auto again = subdiv.insert(pts);
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(again[i] == ids[i]);
+        }
+    }
+    THEN("the triangulation should match one built by single-point insertion") {
+        Subdiv2D serial(Rect(0, 0, 100, 100));
+        for (auto& pt : pts) {
+            serial.insert(pt);
+        }
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(serial));
+    }
+}
+
+TEST_CASE("Divide and conquer construction", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    auto pts = makeRandomPoints(1000, 99.f);
+    // a few duplicates
+    pts.push_back(pts[3]);
+    pts.push_back(pts[500]);
+
+    std::vector<VertexId> ids;
+    auto subdiv = Subdiv2D::buildDelaunay(bounds, pts, &ids);
+    REQUIRE_NOTHROW(subdiv.checkSubdiv());
+
+    THEN("each unique point should get its own ID, and duplicates the ID of the first occurrence") {
+        REQUIRE(ids.size() == pts.size());
+        std::set<int> uniqueIds;
+        for (auto id : ids) {
+            uniqueIds.insert(id.get());
+        }
+        REQUIRE(uniqueIds.size() == pts.size() - 2);
+        REQUIRE(*uniqueIds.begin() == 4);
+        REQUIRE(ids[pts.size() - 2] == ids[3]);
+        REQUIRE(ids[pts.size() - 1] == ids[500]);
+        REQUIRE(subdiv.getNumVertices() == pts.size() - 2 + 4);
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(subdiv.getVertex(ids[i]) == pts[i]);
+        }
+    }
+    THEN("the bounding vertices should be the same as from initDelaunay") {
+        Subdiv2D serial(bounds);
+        for (int i = 1; i <= 3; ++i) {
+            REQUIRE(subdiv.getVertex(VertexId(i)) == serial.getVertex(VertexId(i)));
+        }
+    }
+    THEN("the triangulation should match one built by incremental insertion") {
+        Subdiv2D serial(bounds);
+        serial.insert(pts);
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(serial));
+    }
+    THEN("every triangle should get a Voronoi vertex, as with incremental insertion") {
+        Subdiv2D serial(bounds);
+        serial.insert(pts);
+        // Sorted by center, and each facet's points sorted too: the two numberings visit them in different orders.
+        auto less = [](Point2f const& a, Point2f const& b) { return std::tie(a.x, a.y) < std::tie(b.x, b.y); };
+        auto sortedFacets = [&](Subdiv2D& s) {
+            std::vector<std::vector<Point2f> > facets;
+            std::vector<Point2f> centers;
+            s.getVoronoiFacetList({}, facets, centers);
+            std::vector<std::pair<Point2f, std::vector<Point2f> > > ret;
+            for (std::size_t i = 0; i < facets.size(); ++i) {
+                std::sort(facets[i].begin(), facets[i].end(), less);
+                ret.emplace_back(centers[i], facets[i]);
+            }
+            std::sort(ret.begin(), ret.end(),
+                      [&](std::pair<Point2f, std::vector<Point2f> > const& a,
+                          std::pair<Point2f, std::vector<Point2f> > const& b) { return less(a.first, b.first); });
+            return ret;
+        };
+        auto built = sortedFacets(subdiv);
+        auto expected = sortedFacets(serial);
+
+        // The triangles touching the bounding vertices may differ, so only the cells of vertices away from those are
+        // compared: the ones in as many listed triangles (which leave those out) as their facets have points.
+        std::vector<Subdiv2D::Triangle> tris;
+        serial.getTriangleList(tris);
+        std::vector<Point2f> corners;
+        for (auto& tri : tris) {
+            corners.insert(corners.end(), tri.begin(), tri.end());
+        }
+        std::sort(corners.begin(), corners.end(), less);
+
+        REQUIRE(built.size() == expected.size());
+        std::size_t compared = 0;
+        for (std::size_t i = 0; i < built.size(); ++i) {
+            REQUIRE(built[i].first == expected[i].first);
+            auto range = std::equal_range(corners.begin(), corners.end(), expected[i].first, less);
+            if (static_cast<std::size_t>(std::distance(range.first, range.second)) != expected[i].second.size()) {
+                continue;
+            }
+            ++compared;
+            REQUIRE(built[i].second.size() == expected[i].second.size());
+            for (std::size_t j = 0; j < built[i].second.size(); ++j) {
+                // Circumcenters are computed from a different vertex of each triangle, so thin ones round differently.
+                REQUIRE(built[i].second[j].x == Approx(expected[i].second[j].x).epsilon(1e-3).margin(1e-2));
+                REQUIRE(built[i].second[j].y == Approx(expected[i].second[j].y).epsilon(1e-3).margin(1e-2));
+            }
+        }
+        REQUIRE(compared > built.size() / 2);
+    }
+    THEN("the triangles made from the first quad-edges should get their Voronoi vertices too") {
+        // With so few points, the first triangle the builder makes joins two bounding vertices and a real one.
+        auto single = Subdiv2D::buildDelaunay(bounds, {Point2f(10, 10), Point2f(90, 10), Point2f(50, 80)});
+        std::vector<std::vector<Point2f> > facets;
+        std::vector<Point2f> centers;
+        single.getVoronoiFacetList({}, facets, centers);
+        REQUIRE(facets.size() == 3);
+        for (auto& facet : facets) {
+            for (auto& p : facet) {
+                REQUIRE(std::abs(p.x) < 1e6f);
+                REQUIRE(std::abs(p.y) < 1e6f);
+            }
+            // The circumcenter of the three points is (50, 235/7).
+            REQUIRE(std::any_of(facet.begin(), facet.end(), [](Point2f const& p) {
+                return p.x == Approx(50.f).margin(1e-3) && p.y == Approx(235.f / 7).margin(1e-3);
+            }));
+        }
+    }
+    THEN("location and further insertion should work") {
+        REQUIRE(1 == subdiv.locateVertexIds(pts[10]).size());
+        REQUIRE(3 == subdiv.locateVertexIds(Point2f(50.5f, 50.25f)).size());
+        auto id = subdiv.insert(Point2f(42.125f, 17.5f));
+        REQUIRE(id == VertexId(static_cast<int>(pts.size() - 2 + 4)));
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+    }
+    THEN("points outside the bounds should be rejected") {
+        REQUIRE_THROWS(Subdiv2D::buildDelaunay(bounds, {Point2f(1, 1), Point2f(100, 1)}));
+    }
+}
+
+TEST_CASE("Divide and conquer construction of degenerate input", "[Subdivision2d]") {
+    const Rect bounds(-10, -10, 20, 20);
+    WHEN("there are no points") {
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, {});
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(Subdiv2D(bounds)));
+    }
+    WHEN("the points are a grid") {
+        std::vector<Point2f> pts;
+        for (int y = -5; y <= 5; ++y) {
+            for (int x = -5; x <= 5; ++x) {
+                pts.emplace_back(float(x), float(y));
+            }
+        }
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, pts);
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        Subdiv2D serial(bounds);
+        serial.insert(pts);
+        // Cocircular ties may be broken differently, but the number of triangles is fixed.
+        REQUIRE(canonicalTriangles(subdiv).size() == canonicalTriangles(serial).size());
+        for (auto& pt : pts) {
+            REQUIRE(1 == subdiv.locateVertexIds(pt).size());
+        }
+    }
+}
+
+TEST_CASE("Parallel divide and conquer construction", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    // Large enough to be split across threads.
+    const auto pts = makeRandomPoints(10000, 99.f, 7);
+
+    std::vector<VertexId> singleIds;
+    auto single = Subdiv2D::buildDelaunay(bounds, pts, 1, &singleIds);
+    const auto singleTriangles = canonicalTriangles(single);
+    Subdiv2D serial(bounds);
+    serial.insert(pts);
+    REQUIRE(singleTriangles == canonicalTriangles(serial));
+
+    for (unsigned int numThreads : {2u, 4u, 0u}) {
+        CAPTURE(numThreads);
+        std::vector<VertexId> ids;
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, pts, numThreads, &ids);
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        // The result should not depend on the thread count.
+        REQUIRE(ids == singleIds);
+        REQUIRE(canonicalTriangles(subdiv) == singleTriangles);
+    }
+}
+
+/// Counts the triangles (among those not touching the bounding vertices) with an input point strictly inside their
+/// circumcircle: zero for a Delaunay triangulation.
+static std::size_t countNonDelaunayTriangles(Subdiv2D const& subdiv, std::vector<Point2f> const& pts, Rect bounds) {
+    auto inBounds = [&](Point2f const& pt) {
+        return pt.x >= bounds.x && pt.y >= bounds.y && pt.x < bounds.x + bounds.width &&
+               pt.y < bounds.y + bounds.height;
+    };
+    std::vector<Subdiv2D::Triangle> tris;
+    subdiv.getTriangleList(tris);
+    std::size_t ret = 0;
+    for (auto const& tri : tris) {
+        if (!std::all_of(tri.begin(), tri.end(), inBounds)) {
+            continue;
+        }
+        for (auto const& pt : pts) {
+            if (isPtInCircle3(pt, tri[0], tri[1], tri[2]) > 0) {
+                ++ret;
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+TEST_CASE("Construction of cocircular and nearly-cocircular grids", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 2000000, 2000000);
+    // Spacing that is not exactly representable, far from the origin, as from measurements on a grid: each point is
+    // rounded to the nearest float, so sets of four are cocircular to within a few units in the last place. (With an
+    // epsilon in the in-circle test, this broke the divide-and-conquer merge.)
+    std::vector<Point2f> nearlyCocircular;
+    std::vector<Point2f> cocircular;
+    for (int y = 0; y < 30; ++y) {
+        for (int x = 0; x < 30; ++x) {
+            nearlyCocircular.emplace_back(float(1000000.1 + x / 3.), float(1000000.1 + y / 3.));
+            cocircular.emplace_back(float(1000000 + x), float(1000000 + y));
+        }
+    }
+    for (auto const* pts : {&nearlyCocircular, &cocircular}) {
+        resetPredicateStats();
+        Subdiv2D incremental(bounds);
+        REQUIRE_NOTHROW(incremental.insert(*pts));
+        REQUIRE_NOTHROW(incremental.checkSubdiv());
+        auto built = Subdiv2D::buildDelaunay(bounds, *pts);
+        REQUIRE_NOTHROW(built.checkSubdiv());
+
+        for (auto const* subdiv : {&incremental, &built}) {
+            REQUIRE(0 == countNonDelaunayTriangles(*subdiv, *pts, bounds));
+            REQUIRE(canonicalTriangles(*subdiv).size() == canonicalTriangles(incremental).size());
+            for (auto const& pt : *pts) {
+                REQUIRE(1 == subdiv->locateVertexIds(pt).size());
+            }
+            // Midway between grid points: on an edge or inside a triangle, never a failed walk.
+            for (std::size_t i = 0; i + 1 < pts->size(); ++i) {
+                const Point2f mid((*pts)[i].x * 0.5f + (*pts)[i + 1].x * 0.5f,
+                                  (*pts)[i].y * 0.5f + (*pts)[i + 1].y * 0.5f);
+                VertexId vertex;
+                EdgeId edge;
+                const auto loc = subdiv->locate(mid, edge, vertex);
+                REQUIRE((loc == PtLoc::PTLOC_INSIDE || loc == PtLoc::PTLOC_ON_EDGE || loc == PtLoc::PTLOC_VERTEX));
+            }
+        }
+        if (pts == &cocircular) {
+            // Exactly cocircular points are exactly the case the floating-point filter can't settle.
+            REQUIRE(getPredicateStats().inCircleExact > 0);
+        }
+    }
+}
+
+/// Counts the allocations it passes on to the default resource.
+class CountingMemoryResource : public MemoryResource {
+  public:
+    void* allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        return getDefaultMemoryResource()->allocate(bytes, alignment);
+    }
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        getDefaultMemoryResource()->deallocate(p, bytes, alignment);
+    }
+    std::size_t allocations = 0;
+};
+
+TEST_CASE("Reserved storage and memory resources", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    const auto expected = canonicalTriangles(Subdiv2D::buildDelaunay(bounds, pts));
+
+    SECTION("inserting the reserved number of points should not reallocate") {
+        for (auto mode : {SubdivMode::DelaunayAndVoronoi, SubdivMode::DelaunayOnly}) {
+            CountingMemoryResource counter;
+            Subdiv2D subdiv(bounds, mode, &counter);
+            REQUIRE(subdiv.getMemoryResource() == &counter);
+            subdiv.reserve(pts.size());
+            const auto allocations = counter.allocations;
+            for (auto& pt : pts) {
+                subdiv.insert(pt);
+            }
+            REQUIRE(counter.allocations == allocations);
+            REQUIRE(canonicalTriangles(subdiv) == expected);
+        }
+    }
+
+    SECTION("the divide and conquer build should not reallocate") {
+        CountingMemoryResource counter;
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, pts, nullptr, SubdivMode::DelaunayAndVoronoi, &counter);
+        REQUIRE(subdiv.getMemoryResource() == &counter);
+        // One array of vertices, and one of each half of the quad-edges.
+        REQUIRE(counter.allocations == 3);
+        REQUIRE(canonicalTriangles(subdiv) == expected);
+    }
+
+    SECTION("an arena should give the same results") {
+        ArenaMemoryResource arena(1 << 16);
+        {
+            Subdiv2D subdiv(bounds, SubdivMode::DelaunayAndVoronoi, &arena);
+            subdiv.reserve(pts.size());
+            subdiv.insert(pts);
+            REQUIRE(canonicalTriangles(subdiv) == expected);
+            // Copies share the resource.
+            Subdiv2D copy = subdiv;
+            REQUIRE(copy.getMemoryResource() == &arena);
+            copy.calcVoronoi();
+            REQUIRE(canonicalTriangles(copy) == expected);
+        }
+        REQUIRE(arena.getBytesHeld() > 0);
+        arena.release();
+        REQUIRE(arena.getBytesHeld() == 0);
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, pts, 2u, nullptr, SubdivMode::DelaunayOnly, &arena);
+        REQUIRE(canonicalTriangles(subdiv) == expected);
+    }
+
+    SECTION("huge-page-backed storage should give the same results") {
+        HugePageMemoryResource hugePages;
+        const auto many = makeRandomPoints(100000, 99.f, 2);
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, many, nullptr, SubdivMode::DelaunayAndVoronoi, &hugePages);
+        subdiv.insert(pts);
+        Subdiv2D plain = Subdiv2D::buildDelaunay(bounds, many);
+        plain.insert(pts);
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(plain));
+    }
+}
+
+TEST_CASE("Binary snapshots", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    const auto more = makeRandomPoints(500, 99.f, 1);
+    const char* path = "subdiv2d_snapshot_test.bin";
+
+    auto checkRoundTrip = [&](SubdivMode mode) {
+        Subdiv2D original(bounds, mode);
+        original.insert(pts);
+        if (mode == SubdivMode::DelaunayAndVoronoi) {
+            original.calcVoronoi();
+        }
+        original.save(path);
+
+        CountingMemoryResource counter;
+        auto loaded = Subdiv2D::load(path, &counter);
+        REQUIRE(loaded.getMode() == mode);
+        REQUIRE(loaded.getMemoryResource() == &counter);
+        // Answered from the file's pages: nothing was allocated for the arrays.
+        REQUIRE(counter.allocations == 0);
+        REQUIRE_NOTHROW(loaded.checkSubdiv());
+        const auto expected = canonicalTriangles(original);
+        REQUIRE(canonicalTriangles(loaded) == expected);
+        for (auto& pt : more) {
+            REQUIRE(loaded.locate(pt) == original.locate(pt));
+            REQUIRE(loaded.findNearest(pt) == original.findNearest(pt));
+        }
+        if (mode == SubdivMode::DelaunayAndVoronoi) {
+            std::vector<std::vector<Point2f> > facets, expectedFacets;
+            std::vector<Point2f> centers, expectedCenters;
+            loaded.getVoronoiFacetList({}, facets, centers);
+            original.getVoronoiFacetList({}, expectedFacets, expectedCenters);
+            REQUIRE(facets == expectedFacets);
+        }
+
+        // Modifying a loaded subdivision works as usual, without changing the file.
+        loaded.insert(more);
+        original.insert(more);
+        REQUIRE(counter.allocations > 0);
+        REQUIRE_NOTHROW(loaded.checkSubdiv());
+        REQUIRE(canonicalTriangles(loaded) == canonicalTriangles(original));
+        REQUIRE(canonicalTriangles(Subdiv2D::load(path)) == expected);
+
+        // Copies have arrays of their own.
+        auto copy = Subdiv2D::load(path);
+        Subdiv2D copied = copy;
+        copy = Subdiv2D();
+        REQUIRE(canonicalTriangles(copied) == expected);
+        std::remove(path);
+    };
+
+    SECTION("a subdivision with a Voronoi diagram should round trip") {
+        checkRoundTrip(SubdivMode::DelaunayAndVoronoi);
+    }
+    SECTION("a subdivision without should round trip") { checkRoundTrip(SubdivMode::DelaunayOnly); }
+
+    SECTION("a loaded subdivision should save over the file it was loaded from") {
+        Subdiv2D original(bounds);
+        original.insert(pts);
+        original.save(path);
+        auto loaded = Subdiv2D::load(path);
+        // Still borrowing the file's pages, unmodified.
+        REQUIRE_NOTHROW(loaded.save(path));
+        REQUIRE(canonicalTriangles(Subdiv2D::load(path)) == canonicalTriangles(original));
+        loaded.insert(more);
+        original.insert(more);
+        REQUIRE_NOTHROW(loaded.save(path));
+        REQUIRE(canonicalTriangles(Subdiv2D::load(path)) == canonicalTriangles(original));
+        std::remove(path);
+    }
+
+    SECTION("files that are not snapshots should be refused") {
+        REQUIRE_THROWS(Subdiv2D::load("subdiv2d_no_such_file.bin"));
+        {
+            std::ofstream os(path, std::ios::binary);
+            os << "SUBDIV2D, but not really";
+        }
+        REQUIRE_THROWS(Subdiv2D::load(path));
+        std::remove(path);
+    }
+
+    SECTION("snapshots with edges pointing out of the arrays should be refused") {
+        Subdiv2D original(bounds, SubdivMode::DelaunayOnly);
+        original.insert(pts);
+        original.save(path);
+        {
+            // The last section is the edges: make the links and points of the last few out of range.
+            std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+            fs.seekp(-64, std::ios::end);
+            const std::string garbage(64, '\x7f');
+            fs.write(garbage.data(), garbage.size());
+        }
+        REQUIRE_THROWS(Subdiv2D::load(path));
+        std::remove(path);
+    }
+}
+
+static std::string readFile(const char* path) {
+    std::ifstream is(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const char* path, std::string const& contents) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    os << contents;
+}
+
+TEST_CASE("Journal recovery", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(1500, 99.f);
+    const char* snapshotPath = "subdiv2d_journal_test.snapshot";
+    const char* journalPath = "subdiv2d_journal_test.journal";
+
+    std::vector<VertexId> ids;
+    auto expectSame = [&](Subdiv2D& recovered, Subdiv2D& expected) {
+        REQUIRE_NOTHROW(recovered.checkSubdiv());
+        REQUIRE(canonicalTriangles(recovered) == canonicalTriangles(expected));
+        for (auto id : ids) {
+            REQUIRE(recovered.getVertex(id) == expected.getVertex(id));
+        }
+        std::vector<std::vector<Point2f> > facets, expectedFacets;
+        std::vector<Point2f> centers, expectedCenters;
+        recovered.getVoronoiFacetList({}, facets, centers);
+        expected.getVoronoiFacetList({}, expectedFacets, expectedCenters);
+        REQUIRE(facets == expectedFacets);
+        REQUIRE(recovered.getBounds() == expected.getBounds());
+        REQUIRE(recovered.hasGrowableBounds() == expected.hasGrowableBounds());
+    };
+
+    // Every kind of change, with checkpoints along the way.
+    Subdiv2D subdiv(bounds);
+    subdiv.startJournal(snapshotPath, journalPath, 700);
+    REQUIRE(subdiv.isJournaling());
+    for (std::size_t i = 0; i < 1000; ++i) {
+        ids.push_back(subdiv.insert(pts[i]));
+    }
+    subdiv.calcVoronoi();
+    const auto bulk = subdiv.insert(std::vector<Point2f>(pts.begin() + 1000, pts.end()));
+    ids.insert(ids.end(), bulk.begin(), bulk.end());
+    for (std::size_t i = 0; i < 100; ++i) {
+        subdiv.remove(ids[i]);
+    }
+    for (std::size_t i = 100; i < 200; ++i) {
+        subdiv.move(ids[i], pts[i] + Point2f(0.01f, 0.f));
+    }
+    ids.erase(ids.begin(), ids.begin() + 100);
+    const auto vertexMap = subdiv.compact();
+    for (auto& id : ids) {
+        id = vertexMap[id.get()];
+    }
+    for (std::size_t i = 0; i < 50; ++i) {
+        subdiv.remove(ids[i]);
+    }
+    ids.erase(ids.begin(), ids.begin() + 50);
+    subdiv.setGrowableBounds(true);
+    ids.push_back(subdiv.insert(Point2f(130.5f, 20)));
+    subdiv.move(ids[0], Point2f(-20.25f, 50));
+    subdiv.growBounds(Rect(0, 0, 100, 400));
+    REQUIRE_FALSE(Subdiv2D(subdiv).isJournaling());
+
+    SECTION("recovery should give the same subdivision, with the same IDs") {
+        subdiv.stopJournal();
+        auto recovered = Subdiv2D::recover(snapshotPath, journalPath);
+        REQUIRE(recovered.isJournaling());
+        expectSame(recovered, subdiv);
+
+        // Journaling resumes where it left off.
+        const auto more = makeRandomPoints(50, 99.f, 1);
+        for (auto& pt : more) {
+            ids.push_back(recovered.insert(pt));
+            subdiv.insert(pt);
+        }
+        recovered.stopJournal();
+        auto again = Subdiv2D::recover(snapshotPath, journalPath);
+        expectSame(again, subdiv);
+        again.stopJournal();
+    }
+
+    SECTION("a change cut short should be dropped") {
+        subdiv.stopJournal();
+        writeFile(journalPath, readFile(journalPath) + "torn");
+        auto recovered = Subdiv2D::recover(snapshotPath, journalPath);
+        expectSame(recovered, subdiv);
+        recovered.stopJournal();
+    }
+
+    SECTION("changes already in the snapshot should not be replayed") {
+        // As if the process stopped after a checkpoint replaced the snapshot, but before the journal started over.
+        const auto journal = readFile(journalPath);
+        subdiv.checkpoint();
+        subdiv.stopJournal();
+        writeFile(journalPath, journal);
+        auto recovered = Subdiv2D::recover(snapshotPath, journalPath);
+        expectSame(recovered, subdiv);
+        recovered.stopJournal();
+    }
+
+    SECTION("a journal cut short within its header after a checkpoint should hold no changes") {
+        subdiv.checkpoint();
+        subdiv.stopJournal();
+        const auto journal = readFile(journalPath);
+        for (std::size_t length : {std::size_t(0), std::size_t(10)}) {
+            CAPTURE(length);
+            writeFile(journalPath, journal.substr(0, length));
+            auto recovered = Subdiv2D::recover(snapshotPath, journalPath);
+            expectSame(recovered, subdiv);
+            recovered.stopJournal();
+        }
+        // Journaling starts over with a whole header, so changes after recovery are kept.
+        auto recovered = Subdiv2D::recover(snapshotPath, journalPath);
+        ids.push_back(recovered.insert(Point2f(50.5f, 50.25f)));
+        subdiv.insert(Point2f(50.5f, 50.25f));
+        recovered.stopJournal();
+        auto again = Subdiv2D::recover(snapshotPath, journalPath);
+        expectSame(again, subdiv);
+        again.stopJournal();
+    }
+    std::remove(snapshotPath);
+    std::remove(journalPath);
+}
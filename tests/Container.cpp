@@ -16,6 +16,8 @@
 
 #include "catch.hpp"
 
+#include <cstdio>
+
 using namespace sensics::subdiv2d;
 using SubdivDoubleContainer = SubdivContainer<double>;
 TEST_CASE("Container constructor behavior", "[SubdivContainer]") {
@@ -38,3 +40,168 @@ TEST_CASE("Simple retrieval", "[SubdivContainer]") {
 
     auto vertices = subdiv.findNeighborhood(Point2f(0.5, 0.5));
 }
+
+TEST_CASE("Erasing points", "[SubdivContainer]") {
+    SubdivDoubleContainer subdiv(Rect(0, 0, 10, 10));
+    for (int y = 1; y < 9; ++y) {
+        for (int x = 1; x < 9; ++x) {
+            subdiv.insert(Point2f(x + 0.1f * y, y), x * 10 + y);
+        }
+    }
+    const Point2f Erased(3.3f, 3);
+
+    REQUIRE(subdiv.erase(Erased));
+    REQUIRE(!subdiv.lookup(Erased));
+    REQUIRE(!subdiv.erase(Erased));
+    REQUIRE(!subdiv.erase(Point2f(5, 5.5f)));
+    THEN("the other values should stay attached to their points") {
+        for (int y = 1; y < 9; ++y) {
+            for (int x = 1; x < 9; ++x) {
+                const Point2f pt(x + 0.1f * y, y);
+                if (pt != Erased) {
+                    REQUIRE(subdiv.get(pt) == x * 10 + y);
+                }
+            }
+        }
+    }
+    THEN("reinserting should attach the new value") {
+        subdiv.insert(Erased, -1.0);
+        REQUIRE(subdiv.get(Erased) == -1.0);
+        subdiv.insert(Point2f(5, 5.5f), 2.0);
+        REQUIRE(subdiv.get(Point2f(5, 5.5f)) == 2.0);
+        REQUIRE(subdiv.get(Point2f(4.3f, 3)) == 43);
+    }
+}
+
+TEST_CASE("Moving points", "[SubdivContainer]") {
+    SubdivDoubleContainer subdiv(Rect(0, 0, 10, 10));
+    for (int y = 1; y < 9; ++y) {
+        for (int x = 1; x < 9; ++x) {
+            subdiv.insert(Point2f(x + 0.1f * y, y), x * 10 + y);
+        }
+    }
+    const Point2f From(3.3f, 3);
+    const Point2f Nudged(3.4f, 3.1f);
+    const Point2f Far(9.5f, 0.5f);
+
+    REQUIRE(subdiv.move(From, Nudged));
+    REQUIRE(!subdiv.lookup(From));
+    REQUIRE(subdiv.get(Nudged) == 33);
+    REQUIRE(subdiv.move(Nudged, Far));
+    REQUIRE(subdiv.get(Far) == 33);
+    REQUIRE(!subdiv.move(From, Nudged));
+    REQUIRE_THROWS(subdiv.move(Far, Point2f(4.3f, 3)));
+    THEN("the other values should stay attached to their points") {
+        for (int y = 1; y < 9; ++y) {
+            for (int x = 1; x < 9; ++x) {
+                const Point2f pt(x + 0.1f * y, y);
+                if (pt != From) {
+                    REQUIRE(subdiv.get(pt) == x * 10 + y);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Compacting", "[SubdivContainer]") {
+    SubdivDoubleContainer subdiv(Rect(0, 0, 10, 10));
+    for (int y = 1; y < 9; ++y) {
+        for (int x = 1; x < 9; ++x) {
+            subdiv.insert(Point2f(x + 0.1f * y, y), x * 10 + y);
+        }
+    }
+    for (int x = 1; x < 9; ++x) {
+        REQUIRE(subdiv.erase(Point2f(x + 0.4f, 4)));
+    }
+    subdiv.compact();
+    THEN("the values should stay attached to their points") {
+        for (int y = 1; y < 9; ++y) {
+            for (int x = 1; x < 9; ++x) {
+                const Point2f pt(x + 0.1f * y, y);
+                if (y == 4) {
+                    REQUIRE(!subdiv.lookup(pt));
+                } else {
+                    REQUIRE(subdiv.get(pt) == x * 10 + y);
+                }
+            }
+        }
+    }
+    THEN("points should be insertable and erasable again") {
+        subdiv.insert(Point2f(1.4f, 4), -1.0);
+        REQUIRE(subdiv.get(Point2f(1.4f, 4)) == -1.0);
+        REQUIRE(subdiv.erase(Point2f(1.1f, 1)));
+        REQUIRE(!subdiv.lookup(Point2f(1.1f, 1)));
+        REQUIRE(subdiv.get(Point2f(8.8f, 8)) == 88);
+    }
+}
+
+TEST_CASE("Container snapshots", "[SubdivContainer]") {
+    const char* path = "subdiv2d_container_snapshot_test.bin";
+    SubdivDoubleContainer subdiv(Rect(0, 0, 10, 10));
+    for (int y = 1; y < 9; ++y) {
+        for (int x = 1; x < 9; ++x) {
+            subdiv.insert(Point2f(x + 0.1f * y, y), x * 10 + y);
+        }
+    }
+    const Point2f Erased(3.3f, 3);
+    subdiv.erase(Erased);
+    subdiv.save(path);
+
+    auto loaded = SubdivDoubleContainer::load(path);
+    std::remove(path);
+    REQUIRE(!loaded.lookup(Erased));
+    for (int y = 1; y < 9; ++y) {
+        for (int x = 1; x < 9; ++x) {
+            const Point2f pt(x + 0.1f * y, y);
+            if (pt != Erased) {
+                REQUIRE(loaded.get(pt) == x * 10 + y);
+            }
+        }
+    }
+    loaded.insert(Erased, -1.0);
+    REQUIRE(loaded.get(Erased) == -1.0);
+    REQUIRE(!subdiv.lookup(Erased));
+}
+
+TEST_CASE("Container journal recovery", "[SubdivContainer]") {
+    const char* snapshotPath = "subdiv2d_container_journal_test.snapshot";
+    const char* journalPath = "subdiv2d_container_journal_test.journal";
+    const Point2f Erased(3.3f, 3);
+    const Point2f From(5.5f, 5), To(5.6f, 5.2f);
+    {
+        SubdivDoubleContainer subdiv(Rect(0, 0, 10, 10));
+        subdiv.startJournal(snapshotPath, journalPath, 20);
+        for (int y = 1; y < 9; ++y) {
+            for (int x = 1; x < 9; ++x) {
+                subdiv.insert(Point2f(x + 0.1f * y, y), x * 10 + y);
+            }
+        }
+        subdiv.erase(Erased);
+        subdiv.compact();
+        subdiv.move(From, To);
+        subdiv.insert(Point2f(1.1f, 1), -1.0);
+        subdiv.setGrowableBounds(true);
+        subdiv.insert(Point2f(12.5f, 4), 125.0);
+        subdiv.growBounds(Rect(-5, 0, 1, 1));
+    }
+
+    auto recovered = SubdivDoubleContainer::recover(snapshotPath, journalPath);
+    recovered.stopJournal();
+    std::remove(snapshotPath);
+    std::remove(journalPath);
+    REQUIRE(!recovered.lookup(Erased));
+    REQUIRE(!recovered.lookup(From));
+    REQUIRE(recovered.get(To) == 55);
+    REQUIRE(recovered.get(Point2f(1.1f, 1)) == -1.0);
+    REQUIRE(recovered.get(Point2f(12.5f, 4)) == 125.0);
+    REQUIRE(recovered.hasGrowableBounds());
+    REQUIRE(recovered.getBounds() == Rect(-5, 0, 20, 10));
+    for (int y = 2; y < 9; ++y) {
+        for (int x = 1; x < 9; ++x) {
+            const Point2f pt(x + 0.1f * y, y);
+            if (pt != Erased && pt != From) {
+                REQUIRE(recovered.get(pt) == x * 10 + y);
+            }
+        }
+    }
+}
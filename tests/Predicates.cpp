@@ -0,0 +1,116 @@
+/** @file
+    @brief Tests
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#include <subdiv2d/Predicates.h>
+
+#include "TestPoints.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace sensics::subdiv2d;
+
+/// Random points mixed with points on a small grid, so that collinear and cocircular cases (results of 0) come up.
+static std::vector<Point2f> makePredicateInput(std::size_t n, unsigned int seed) {
+    auto ret = makeRandomPoints(n, 10.f, seed);
+    for (std::size_t i = 0; i < n; i += 2) {
+        ret[i] = Point2f(float(int(ret[i].x) % 3), float(int(ret[i].y) % 3));
+    }
+    return ret;
+}
+
+TEST_CASE("Batch predicates", "[Predicates]") {
+    const std::size_t n = 1003;
+    const auto pt = makePredicateInput(n, 1);
+    const auto a = makePredicateInput(n, 2);
+    const auto b = makePredicateInput(n, 3);
+    const auto c = makePredicateInput(n, 4);
+
+    std::vector<double> expectedArea(n);
+    std::vector<int> expectedRightOf(n);
+    std::vector<int> expectedInCircle(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        expectedArea[i] = doubleTriangleArea(a[i], b[i], c[i]);
+        expectedRightOf[i] = isRightOf(pt[i], a[i], b[i]);
+        expectedInCircle[i] = isPtInCircle3(pt[i], a[i], b[i], c[i]);
+    }
+    REQUIRE(std::count(expectedInCircle.begin(), expectedInCircle.end(), 0) > 0);
+
+    const auto supported = getSupportedSimdLevel();
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (level > supported) {
+            continue;
+        }
+        CAPTURE(static_cast<int>(level));
+        setSimdLevel(level);
+        REQUIRE(getSimdLevel() == level);
+        // Every length up to a few blocks, to cover the leftovers after the last whole block.
+        for (std::size_t count : {std::size_t(0), std::size_t(1), std::size_t(2), std::size_t(3), std::size_t(5),
+                                  std::size_t(7), std::size_t(8), std::size_t(9), n}) {
+            CAPTURE(count);
+            std::vector<double> area(count);
+            doubleTriangleAreaBatch(a.data(), b.data(), c.data(), area.data(), count);
+            // Bit for bit, so not with ==: but memcmp() may not be given the null data() of an empty vector.
+            REQUIRE((count == 0 || 0 == std::memcmp(area.data(), expectedArea.data(), count * sizeof(double))));
+
+            std::vector<int> rightOf(count);
+            isRightOfBatch(pt.data(), a.data(), b.data(), rightOf.data(), count);
+            REQUIRE(std::equal(rightOf.begin(), rightOf.end(), expectedRightOf.begin()));
+
+            std::vector<int> inCircle(count);
+            isPtInCircle3Batch(pt.data(), a.data(), b.data(), c.data(), inCircle.data(), count);
+            REQUIRE(std::equal(inCircle.begin(), inCircle.end(), expectedInCircle.begin()));
+        }
+    }
+    setSimdLevel(supported);
+}
+
+TEST_CASE("Exact predicates", "[Predicates]") {
+    WHEN("points are exactly collinear or cocircular") {
+        resetPredicateStats();
+        // Exactly representable, and large enough that the determinants' terms are far from exact in double.
+        const float offset = 1048576.f;
+        const auto shift = [&](float x, float y) { return Point2f(offset + x, offset + y); };
+        REQUIRE(0 == triangleOrientation(shift(0, 0), shift(3, 1), shift(-6, -2)));
+        REQUIRE(0 == isRightOf(shift(0.5f, 0.25f), shift(-1, -0.5f), shift(4, 2)));
+        // All on the circle of radius 5 about the origin.
+        REQUIRE(0 == isPtInCircle3(shift(3, 4), shift(5, 0), shift(0, 5), shift(-4, -3)));
+        REQUIRE(0 == isPtInCircle3(shift(-3, 4), shift(4, -3), shift(0, -5), shift(-5, 0)));
+        THEN("the exact arithmetic should have been used") {
+            REQUIRE(getPredicateStats().orientationExact >= 2);
+            REQUIRE(getPredicateStats().inCircleExact >= 2);
+        }
+    }
+    WHEN("points are within a unit in the last place of degenerate") {
+        const float offset = 1048576.f;
+        const auto shift = [&](float x, float y) { return Point2f(offset + x, offset + y); };
+        // The next float up from offset + 2 in y: just left of the line through the others.
+        const Point2f above(offset + 2, std::nextafter(offset + 2, 2 * offset));
+        REQUIRE(1 == triangleOrientation(shift(0, 0), shift(4, 4), above));
+        REQUIRE(-1 == triangleOrientation(shift(4, 4), shift(0, 0), above));
+        REQUIRE(-1 == isRightOf(above, shift(0, 0), shift(4, 4)));
+
+        const Point2f outside(offset + 3, std::nextafter(offset + 4, 2 * offset));
+        const Point2f inside(offset + 3, std::nextafter(offset + 4, 0.f));
+        REQUIRE(-1 == isPtInCircle3(outside, shift(5, 0), shift(0, 5), shift(-4, -3)));
+        REQUIRE(1 == isPtInCircle3(inside, shift(5, 0), shift(0, 5), shift(-4, -3)));
+        THEN("the results should be consistent under permutation") {
+            // An odd permutation of a, b, c reverses the sign.
+            REQUIRE(1 == isPtInCircle3(outside, shift(0, 5), shift(5, 0), shift(-4, -3)));
+            REQUIRE(-1 == isPtInCircle3(inside, shift(-4, -3), shift(0, 5), shift(5, 0)));
+        }
+    }
+}
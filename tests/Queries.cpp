@@ -0,0 +1,1296 @@
+/** @file
+    @brief Tests
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#include <subdiv2d/SubdivContainer.h>
+#include <subdiv2d/Subdivision2D.h>
+#include <subdiv2d/VersionPublisher.h>
+
+#include "TestPoints.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
+#include <tuple>
+
+using namespace sensics::subdiv2d;
+
+namespace sensics {
+namespace subdiv2d {
+    namespace detail {
+        /// Reaches into a subdivision for what the public interface does not offer.
+        class SubdivTestAccess {
+          public:
+            /// With 0, growing the bounds always rebuilds the triangulation.
+            static void setMaxBoundingVertexSteps(Subdiv2D& subdiv, int steps) {
+                subdiv.maxBoundingVertexSteps = steps;
+            }
+        };
+    } // namespace detail
+} // namespace subdiv2d
+} // namespace sensics
+
+/// The vertices of a location, sorted: which edge a walk ends on (and so the order of the vertices) depends on where it
+/// started.
+static std::vector<int> sortedIds(VertexArray const& vertices) {
+    std::vector<int> ret;
+    for (auto v : vertices) {
+        ret.push_back(v.value());
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+TEST_CASE("Const point location with cursors", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    Subdiv2D subdiv(bounds);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    subdiv.insert(pts);
+    Subdiv2D const& constSubdiv = subdiv;
+    const auto queries = makeRandomPoints(500, 99.f, 1);
+
+    THEN("locating with a cursor should give the same results as without") {
+        LocateCursor cursor;
+        for (auto& q : queries) {
+            REQUIRE(sortedIds(constSubdiv.locateVertexIdsArray(q, &cursor)) == sortedIds(constSubdiv.locateVertexIdsArray(q)));
+        }
+        for (auto& pt : pts) {
+            EdgeId edge;
+            VertexId vertex;
+            REQUIRE(PtLoc::PTLOC_VERTEX == constSubdiv.locate(pt, edge, vertex, &cursor));
+            REQUIRE(constSubdiv.getVertex(vertex) == pt);
+        }
+    }
+
+    THEN("a cursor should survive modification of the subdivision") {
+        LocateCursor cursor;
+        subdiv.locate(queries.front(), &cursor);
+        subdiv.insert(queries.front());
+        for (auto& q : queries) {
+            REQUIRE(sortedIds(subdiv.locateVertexIdsArray(q, &cursor)) == sortedIds(subdiv.locateVertexIdsArray(q)));
+        }
+    }
+
+    THEN("the const findNearest should find the nearest vertex without the Voronoi diagram") {
+        LocateCursor cursor;
+        for (auto& q : queries) {
+            auto nearest = constSubdiv.findNearest(q, nullptr, &cursor);
+            REQUIRE(nearest == subdiv.findNearest(q));
+            REQUIRE(nearest == subdiv.findNearest(q, nullptr));
+            // Brute force check
+            auto closest = std::min_element(pts.begin(), pts.end(), [&](Point2f const& a, Point2f const& b) {
+                return (a - q).squaredNorm() < (b - q).squaredNorm();
+            });
+            REQUIRE((constSubdiv.getVertex(nearest) - q).squaredNorm() == (*closest - q).squaredNorm());
+        }
+        // Had the Voronoi diagram been computed, its vertices would have taken this ID.
+        REQUIRE(subdiv.insert(Point2f(0.5f, 99.5f)) == VertexId(static_cast<int>(pts.size()) + 4));
+    }
+
+    THEN("finding the nearest vertices in a batch should give the same results as one at a time") {
+        // Several blocks' worth, with a couple out of bounds.
+        auto batch = makeRandomPoints(3000, 99.f, 3);
+        batch[10] = Point2f(-1.f, 50.f);
+        batch[2000] = Point2f(50.f, 100.f);
+        std::vector<VertexId> nearest(batch.size());
+        constSubdiv.findNearestBatch(batch.data(), batch.size(), nearest.data());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            if (i == 10 || i == 2000) {
+                REQUIRE_FALSE(nearest[i].valid());
+            } else {
+                REQUIRE(nearest[i] == constSubdiv.findNearest(batch[i]));
+            }
+        }
+    }
+
+    THEN("many threads should be able to query concurrently, each with its own cursor") {
+        std::vector<std::vector<int> > expected;
+        for (auto& q : queries) {
+            expected.push_back(sortedIds(constSubdiv.locateVertexIdsArray(q)));
+        }
+        const std::size_t numThreads = 4;
+        std::vector<std::vector<std::vector<int> > > results(numThreads);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t] {
+                LocateCursor cursor;
+                for (std::size_t i = 0; i < queries.size(); ++i) {
+                    // Each thread walks the queries in a different order.
+                    auto& q = queries[(i * (t + 1)) % queries.size()];
+                    results[t].push_back(sortedIds(constSubdiv.locateVertexIdsArray(q, &cursor)));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (std::size_t t = 0; t < numThreads; ++t) {
+            for (std::size_t i = 0; i < queries.size(); ++i) {
+                REQUIRE(results[t][i] == expected[(i * (t + 1)) % queries.size()]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Const container lookup with cursors", "[SubdivContainer]") {
+    SubdivContainer<double> container(Rect(0, 0, 1, 1));
+    container.insert(Point2f(0.25f, 0.25f), 1.0);
+    container.insert(Point2f(0.75f, 0.25f), 2.0);
+    container.insert(Point2f(0.5f, 0.75f), 3.0);
+    auto const& constContainer = container;
+
+    LocateCursor cursor;
+    REQUIRE(2.0 == constContainer.get(Point2f(0.75f, 0.25f), &cursor));
+    double val = 0;
+    REQUIRE(constContainer.lookup(Point2f(0.5f, 0.75f), val, &cursor));
+    REQUIRE(3.0 == val);
+    REQUIRE_FALSE(constContainer.lookup(Point2f(0.5f, 0.5f), nullptr, &cursor));
+    REQUIRE(3 == constContainer.findNeighborhood(Point2f(0.5f, 0.4f), &cursor).size());
+}
+
+TEST_CASE("Batched point location", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    Subdiv2D subdiv(bounds);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    subdiv.insert(pts);
+
+    auto queries = makeRandomPoints(1000, 99.f, 2);
+    // Some exact vertices, and some out of bounds.
+    queries.insert(queries.end(), pts.begin(), pts.begin() + 50);
+    queries.emplace_back(-1.f, 50.f);
+    queries.emplace_back(50.f, 100.f);
+    const auto n = queries.size();
+
+    std::vector<PtLoc> locs(n);
+    std::vector<EdgeId> edges(n);
+    std::vector<VertexArray> vertices(n);
+    subdiv.locateBatch(queries.data(), n, locs.data(), edges.data(), vertices.data());
+
+    THEN("the results should be in input order and match individual location") {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto& q = queries[i];
+            if (q.x < 0 || q.y < 0 || q.x >= 100 || q.y >= 100) {
+                REQUIRE(locs[i] == PtLoc::PTLOC_OUTSIDE_RECT);
+                REQUIRE_FALSE(edges[i].valid());
+                REQUIRE(sortedIds(vertices[i]) == sortedIds(VertexArray{}));
+                continue;
+            }
+            EdgeId edge;
+            VertexId vertex;
+            REQUIRE(locs[i] == subdiv.locate(q, edge, vertex));
+            REQUIRE(sortedIds(vertices[i]) == sortedIds(subdiv.locateVertexIdsArray(q)));
+            if (locs[i] != PtLoc::PTLOC_VERTEX) {
+                REQUIRE(edges[i].valid());
+            }
+        }
+    }
+    THEN("outputs should be optional") {
+        std::vector<PtLoc> locsOnly(n);
+        LocateCursor cursor;
+        subdiv.locateBatch(queries.data(), n, locsOnly.data(), nullptr, nullptr, &cursor);
+        REQUIRE(locsOnly == locs);
+    }
+}
+
+/// The Voronoi facets of all of the real vertices, keyed by vertex location and each rotated to start from its least
+/// point, so that subdivisions can be compared regardless of vertex and edge numbering.
+static std::map<std::pair<float, float>, std::vector<Point2f> > canonicalFacets(Subdiv2D& subdiv) {
+    std::vector<std::vector<Point2f> > facets;
+    std::vector<Point2f> centers;
+    subdiv.getVoronoiFacetList({}, facets, centers);
+    auto less = [](Point2f const& a, Point2f const& b) { return std::tie(a.x, a.y) < std::tie(b.x, b.y); };
+    std::map<std::pair<float, float>, std::vector<Point2f> > ret;
+    for (std::size_t i = 0; i < facets.size(); ++i) {
+        auto& facet = facets[i];
+        std::rotate(facet.begin(), std::min_element(facet.begin(), facet.end(), less), facet.end());
+        ret[std::make_pair(centers[i].x, centers[i].y)] = facet;
+    }
+    return ret;
+}
+
+TEST_CASE("Delaunay-only mode", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    const auto queries = makeRandomPoints(500, 99.f, 1);
+    Subdiv2D full(bounds);
+    full.insert(pts);
+
+    auto checkNearest = [&](Subdiv2D& subdiv) {
+        Subdiv2D const& constSubdiv = subdiv;
+        LocateCursor cursor;
+        for (auto& q : queries) {
+            auto nearest = constSubdiv.findNearest(q, nullptr, &cursor);
+            REQUIRE(nearest == subdiv.findNearest(q));
+            auto closest = std::min_element(pts.begin(), pts.end(), [&](Point2f const& a, Point2f const& b) {
+                return (a - q).squaredNorm() < (b - q).squaredNorm();
+            });
+            REQUIRE((constSubdiv.getVertex(nearest) - q).squaredNorm() == (*closest - q).squaredNorm());
+            REQUIRE((constSubdiv.getVertex(nearest) - q).squaredNorm() ==
+                    (full.getVertex(full.findNearest(q)) - q).squaredNorm());
+        }
+        for (auto& pt : pts) {
+            REQUIRE(constSubdiv.getVertex(constSubdiv.findNearest(pt, nullptr, &cursor)) == pt);
+        }
+    };
+
+    // The facets are still available, computed one at a time. (Each circumcenter is computed starting from the
+    // lowest vertex ID, so to compare them to the bit, the reference must have been built the same way.)
+    auto checkNoVoronoi = [&](Subdiv2D& subdiv, Subdiv2D& reference) {
+        REQUIRE(subdiv.getMode() == SubdivMode::DelaunayOnly);
+        REQUIRE_THROWS(subdiv.calcVoronoi());
+        REQUIRE(canonicalFacets(subdiv) == canonicalFacets(reference));
+    };
+
+    REQUIRE(full.getMode() == SubdivMode::DelaunayAndVoronoi);
+
+    SECTION("built by insertion") {
+        Subdiv2D subdiv(bounds, SubdivMode::DelaunayOnly);
+        subdiv.insert(pts);
+        checkNoVoronoi(subdiv, full);
+        std::vector<Subdiv2D::Triangle> triangles, fullTriangles;
+        subdiv.getTriangleList(triangles);
+        full.getTriangleList(fullTriangles);
+        REQUIRE(triangles.size() == fullTriangles.size());
+        checkNearest(subdiv);
+        // Still usable after initDelaunay.
+        subdiv.initDelaunay(bounds);
+        REQUIRE(subdiv.getMode() == SubdivMode::DelaunayOnly);
+        subdiv.insert(pts);
+        checkNearest(subdiv);
+    }
+
+    SECTION("built by divide and conquer") {
+        auto subdiv = Subdiv2D::buildDelaunay(bounds, pts, nullptr, SubdivMode::DelaunayOnly);
+        auto reference = Subdiv2D::buildDelaunay(bounds, pts);
+        checkNoVoronoi(subdiv, reference);
+        checkNearest(subdiv);
+    }
+}
+
+TEST_CASE("Incremental Voronoi maintenance", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(500, 99.f);
+    auto more = makeRandomPoints(300, 99.f, 7);
+    Subdiv2D subdiv(bounds);
+    subdiv.insert(pts);
+    // Some points exactly between two others, to exercise insertion onto an edge, and some duplicates.
+    for (std::size_t i = 0; i < 50; ++i) {
+        more.push_back(Point2f(pts[i].x, pts[i + 1].y));
+        more.push_back(pts[i + 100]);
+    }
+    for (int i = 0; i < 10; ++i) {
+        more.push_back(Point2f(40.f + 2 * i, 50.f));
+    }
+    for (int i = 0; i < 10; ++i) {
+        more.push_back(Point2f(41.f + 2 * i, 50.f));
+    }
+
+    subdiv.calcVoronoi();
+    Subdiv2D const& constSubdiv = subdiv;
+    std::vector<Point2f> inserted = pts;
+    LocateCursor cursor;
+    for (auto& pt : more) {
+        subdiv.insert(pt);
+        inserted.push_back(pt);
+        // No calcVoronoi() needed: the diagram is still up to date.
+        const auto q = Point2f(99.f - pt.x, pt.y * 0.5f);
+        auto nearest = constSubdiv.findNearest(q, nullptr, &cursor);
+        auto closest = std::min_element(inserted.begin(), inserted.end(), [&](Point2f const& a, Point2f const& b) {
+            return (a - q).squaredNorm() < (b - q).squaredNorm();
+        });
+        REQUIRE((constSubdiv.getVertex(nearest) - q).squaredNorm() == (*closest - q).squaredNorm());
+    }
+
+    THEN("the Voronoi diagram should match one computed from scratch") {
+        Subdiv2D fresh(bounds);
+        fresh.insert(pts);
+        for (auto& pt : more) {
+            fresh.insert(pt);
+        }
+        REQUIRE(canonicalFacets(subdiv) == canonicalFacets(fresh));
+    }
+}
+
+TEST_CASE("Per-vertex Voronoi facets", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    Subdiv2D subdiv(bounds);
+    const auto ids = subdiv.insert(pts);
+    Subdiv2D const& constSubdiv = subdiv;
+
+    std::vector<std::vector<Point2f> > facets;
+    std::vector<Point2f> centers;
+    THEN("a few facets should be computed without computing the whole diagram") {
+        const std::vector<VertexId> some(ids.begin(), ids.begin() + 10);
+        subdiv.getVoronoiFacetList(some, facets, centers);
+        REQUIRE(facets.size() == some.size());
+        // Had the whole diagram been computed, its Voronoi vertices would have taken these IDs.
+        REQUIRE(subdiv.insert(Point2f(0.5f, 99.5f)) == VertexId(static_cast<int>(pts.size()) + 4));
+    }
+
+    THEN("each facet should match the one from the whole diagram") {
+        std::vector<Point2f> facet;
+        std::vector<std::vector<Point2f> > lazyFacets;
+        for (auto id : ids) {
+            constSubdiv.getVoronoiFacet(id, facet);
+            lazyFacets.push_back(facet);
+        }
+        subdiv.calcVoronoi();
+        subdiv.getVoronoiFacetList(ids, facets, centers);
+        REQUIRE(facets == lazyFacets);
+    }
+
+    THEN("the facets should surround their vertices") {
+        std::vector<Point2f> facet;
+        for (auto id : ids) {
+            constSubdiv.getVoronoiFacet(id, facet);
+            const auto center = constSubdiv.getVertex(id);
+            for (std::size_t i = 0; i < facet.size(); ++i) {
+                REQUIRE(isRightOf(center, facet[i], facet[(i + 1) % facet.size()]) <= 0);
+            }
+        }
+    }
+
+    THEN("only vertices of the triangulation should have facets") {
+        std::vector<Point2f> facet;
+        REQUIRE_THROWS(constSubdiv.getVoronoiFacet(VertexId(static_cast<int>(pts.size()) + 100), facet));
+    }
+}
+
+TEST_CASE("Nearest neighbor queries", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    Subdiv2D subdiv(bounds);
+    subdiv.insert(pts);
+    Subdiv2D const& constSubdiv = subdiv;
+    auto queries = makeRandomPoints(200, 99.f, 1);
+    // Some queries exactly on vertices.
+    queries.insert(queries.end(), pts.begin(), pts.begin() + 20);
+
+    /// Sorted squared distances of the results, or of the brute-force answer.
+    auto distances = [&](Point2f const& q, std::vector<VertexId> const& ids) {
+        std::vector<float> ret;
+        for (auto id : ids) {
+            ret.push_back((constSubdiv.getVertex(id) - q).squaredNorm());
+        }
+        return ret;
+    };
+    auto bruteForce = [&](Point2f const& q) {
+        std::vector<float> ret;
+        for (auto& pt : pts) {
+            ret.push_back((pt - q).squaredNorm());
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+
+    NeighborSearchScratch scratch;
+    LocateCursor cursor;
+    THEN("findKNearest should give the k nearest, nearest first") {
+        for (std::size_t k : {1, 5, 40}) {
+            std::vector<VertexId> result(k);
+            for (auto& q : queries) {
+                REQUIRE(constSubdiv.findKNearest(q, k, result.data(), &scratch, &cursor) == k);
+                auto dists = distances(q, result);
+                REQUIRE(std::is_sorted(dists.begin(), dists.end()));
+                auto expected = bruteForce(q);
+                expected.resize(k);
+                REQUIRE(dists == expected);
+            }
+        }
+        REQUIRE(constSubdiv.findKNearest(queries.front(), 0, nullptr) == 0);
+    }
+
+    THEN("findKNearest should give every vertex if there are fewer than k") {
+        Subdiv2D small(bounds);
+        small.insert(std::vector<Point2f>(pts.begin(), pts.begin() + 10));
+        std::vector<VertexId> result(20);
+        REQUIRE(small.findKNearest(queries.front(), 20, result.data()) == 10);
+    }
+
+    THEN("findWithinRadius should give the vertices within the radius, nearest first") {
+        std::vector<VertexId> result;
+        for (float radius : {0.f, 1.5f, 6.f}) {
+            for (auto& q : queries) {
+                constSubdiv.findWithinRadius(q, radius, result, &scratch, &cursor);
+                auto dists = distances(q, result);
+                REQUIRE(std::is_sorted(dists.begin(), dists.end()));
+                auto expected = bruteForce(q);
+                // The comparison is done in double precision: compare with a little slack at the boundary.
+                const double r2 = (double)radius * radius;
+                auto inside = std::count_if(expected.begin(), expected.end(), [&](float d) { return d < r2 * 0.999; });
+                auto maybe = std::count_if(expected.begin(), expected.end(), [&](float d) { return d <= r2 * 1.001; });
+                REQUIRE(static_cast<std::ptrdiff_t>(dists.size()) >= inside);
+                REQUIRE(static_cast<std::ptrdiff_t>(dists.size()) <= maybe);
+                REQUIRE(std::equal(dists.begin(), dists.begin() + inside, expected.begin()));
+            }
+        }
+    }
+
+    THEN("points outside of the bounds should raise an error") {
+        std::vector<VertexId> result(5);
+        REQUIRE_THROWS(constSubdiv.findKNearest(Point2f(-1.f, 50.f), 5, result.data()));
+        REQUIRE_THROWS(constSubdiv.findWithinRadius(Point2f(50.f, 100.f), 5.f, result));
+    }
+}
+
+TEST_CASE("Indexed mesh export", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(1000, 99.f);
+    Subdiv2D subdiv(bounds);
+    subdiv.insert(pts);
+    std::vector<Point2f> boundingPoints;
+    for (int i = 1; i <= 3; ++i) {
+        boundingPoints.push_back(subdiv.getVertex(VertexId(i)));
+    }
+    auto touchesBoundary = [&](Subdiv2D::Triangle const& tri) {
+        return std::any_of(tri.begin(), tri.end(), [&](Point2f const& pt) {
+            return std::find(boundingPoints.begin(), boundingPoints.end(), pt) != boundingPoints.end();
+        });
+    };
+    auto triangleKey = [](Subdiv2D::Triangle const& tri) {
+        // Rotate the lowest corner first, keeping the winding.
+        auto first = std::min_element(tri.begin(), tri.end(), [](Point2f const& a, Point2f const& b) {
+            return std::make_tuple(a.x, a.y) < std::make_tuple(b.x, b.y);
+        });
+        std::vector<float> ret;
+        for (std::size_t i = 0; i < 3; ++i) {
+            auto& pt = tri[(first - tri.begin() + i) % 3];
+            ret.push_back(pt.x);
+            ret.push_back(pt.y);
+        }
+        return ret;
+    };
+    auto meshTriangles = [&](IndexedMesh const& mesh) {
+        std::vector<std::vector<float> > ret;
+        for (std::size_t i = 0; i < mesh.indices.size(); i += 3) {
+            auto& v = mesh.vertices;
+            ret.push_back(triangleKey(
+                Subdiv2D::Triangle{{v[mesh.indices[i]], v[mesh.indices[i + 1]], v[mesh.indices[i + 2]]}}));
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    };
+    std::vector<Subdiv2D::Triangle> triangleList;
+    subdiv.getTriangleList(triangleList);
+
+    IndexedMesh mesh;
+    subdiv.getIndexedMesh(mesh);
+    THEN("it should hold each inserted point once, with its vertex ID") {
+        REQUIRE(mesh.vertices.size() == pts.size());
+        REQUIRE(mesh.vertexIds.size() == pts.size());
+        for (std::size_t i = 0; i < mesh.vertices.size(); ++i) {
+            REQUIRE(subdiv.getVertex(mesh.vertexIds[i]) == mesh.vertices[i]);
+        }
+        REQUIRE(std::is_sorted(mesh.vertexIds.begin(), mesh.vertexIds.end(),
+                               [](VertexId a, VertexId b) { return a.value() < b.value(); }));
+    }
+    THEN("it should give the triangles of getTriangleList() that do not touch the bounding vertices") {
+        std::vector<std::vector<float> > expected;
+        for (auto& tri : triangleList) {
+            if (!touchesBoundary(tri)) {
+                expected.push_back(triangleKey(tri));
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(mesh.numTriangles() == expected.size());
+        REQUIRE(meshTriangles(mesh) == expected);
+    }
+    THEN("with the boundary, it should give every triangle but the outer face") {
+        IndexedMesh full;
+        subdiv.getIndexedMesh(full, true);
+        REQUIRE(full.vertices.size() == pts.size() + 3);
+        REQUIRE(full.numTriangles() + 1 == triangleList.size());
+        // Every triangulation of n points inside a triangle has 2n + 1 triangles.
+        REQUIRE(full.numTriangles() == 2 * pts.size() + 1);
+    }
+    THEN("it should leave out the Voronoi vertices, and reuse its storage") {
+        auto before = meshTriangles(mesh);
+        const auto capacity = mesh.indices.capacity();
+        subdiv.calcVoronoi();
+        subdiv.getIndexedMesh(mesh);
+        REQUIRE(mesh.vertices.size() == pts.size());
+        REQUIRE(mesh.indices.capacity() == capacity);
+        REQUIRE(meshTriangles(mesh) == before);
+    }
+    THEN("an empty subdivision should give just the bounding triangle, with the boundary") {
+        Subdiv2D empty(bounds);
+        empty.getIndexedMesh(mesh, true);
+        REQUIRE(mesh.vertices.size() == 3);
+        // 2n + 1 triangles again, with n = 0.
+        REQUIRE(mesh.numTriangles() == 1);
+        std::vector<std::uint32_t> indices(mesh.indices.begin(), mesh.indices.end());
+        std::sort(indices.begin(), indices.end());
+        REQUIRE(indices == (std::vector<std::uint32_t>{0, 1, 2}));
+
+        empty.getIndexedMesh(mesh);
+        REQUIRE(mesh.vertices.empty());
+        REQUIRE(mesh.indices.empty());
+    }
+}
+
+/// Checks the face table of subdiv against its edges, returning the sorted vertex IDs of each face.
+static std::vector<std::vector<int> > checkFaceTable(Subdiv2D const& subdiv) {
+    REQUIRE(subdiv.hasValidFaces());
+    std::vector<std::vector<int> > ret;
+    const auto n = subdiv.getNumFaces();
+    for (std::uint32_t i = 0; i < n; ++i) {
+        const auto face = FaceId(i);
+        auto const& vertices = subdiv.getFaceVertices(face);
+        auto const& neighbors = subdiv.getFaceNeighbors(face);
+        auto edge = subdiv.getFaceEdge(face);
+        for (std::size_t j = 0; j < 3; ++j) {
+            REQUIRE(subdiv.edgeOrg(edge) == vertices[j]);
+            REQUIRE(subdiv.getEdgeFace(edge) == face);
+            REQUIRE(subdiv.getEdgeFace(subdiv.symEdge(edge)) == neighbors[j]);
+            if (neighbors[j].valid()) {
+                auto const& back = subdiv.getFaceNeighbors(neighbors[j]);
+                REQUIRE(std::count(back.begin(), back.end(), face) == 1);
+            } else {
+                // Only across the bounding triangle.
+                REQUIRE(subdiv.edgeOrg(edge).value() <= 3);
+                REQUIRE(subdiv.edgeDst(edge).value() <= 3);
+            }
+            edge = subdiv.getEdge(edge, Subdiv2D::NEXT_AROUND_LEFT);
+        }
+        ret.push_back(sortedIds(vertices));
+    }
+    return ret;
+}
+
+TEST_CASE("Face table", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(500, 99.f);
+    Subdiv2D subdiv(bounds);
+    subdiv.insert(pts);
+    REQUIRE_FALSE(subdiv.hasValidFaces());
+    REQUIRE_THROWS(subdiv.getNumFaces());
+    subdiv.calcFaces();
+
+    THEN("it should hold every triangle inside the bounding triangle, consistently") {
+        auto faces = checkFaceTable(subdiv);
+        REQUIRE(faces.size() == 2 * pts.size() + 1);
+        std::sort(faces.begin(), faces.end());
+        REQUIRE(std::unique(faces.begin(), faces.end()) == faces.end());
+    }
+
+    THEN("insertions should patch it, keeping the IDs of the faces they do not replace") {
+        auto before = checkFaceTable(subdiv);
+        const auto morePts = makeRandomPoints(300, 99.f, 7);
+        for (auto& pt : morePts) {
+            subdiv.insert(pt);
+        }
+        auto after = checkFaceTable(subdiv);
+        REQUIRE(after.size() == 2 * (pts.size() + morePts.size()) + 1);
+        std::map<std::vector<int>, std::size_t> afterIds;
+        for (std::size_t i = 0; i < after.size(); ++i) {
+            afterIds[after[i]] = i;
+        }
+        REQUIRE(afterIds.size() == after.size());
+        for (std::size_t i = 0; i < before.size(); ++i) {
+            auto it = afterIds.find(before[i]);
+            if (it != afterIds.end()) {
+                REQUIRE(it->second == i);
+            }
+        }
+
+        // The same triangles as a table built from scratch.
+        Subdiv2D rebuilt(bounds);
+        rebuilt.insert(pts);
+        for (auto& pt : morePts) {
+            rebuilt.insert(pt);
+        }
+        rebuilt.calcFaces();
+        auto expected = checkFaceTable(rebuilt);
+        std::sort(after.begin(), after.end());
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(after == expected);
+    }
+
+    THEN("insertions on edges should patch it too") {
+        Subdiv2D grid(bounds);
+        for (int y = 10; y < 90; y += 10) {
+            for (int x = 10; x < 90; x += 10) {
+                grid.insert(Point2f(x, y));
+            }
+        }
+        grid.calcFaces();
+        for (int y = 10; y < 90; y += 10) {
+            for (int x = 10; x < 80; x += 10) {
+                REQUIRE(std::get<0>(grid.locate(Point2f(x + 5.f, y))) == PtLoc::PTLOC_ON_EDGE);
+                grid.insert(Point2f(x + 5.f, y));
+            }
+        }
+        auto faces = checkFaceTable(grid);
+        REQUIRE(faces.size() == 2 * (64 + 56) + 1);
+    }
+
+    THEN("locate should give the face containing the point") {
+        LocateCursor cursor;
+        auto queries = makeRandomPoints(200, 99.f, 1);
+        queries.insert(queries.end(), pts.begin(), pts.begin() + 20);
+        for (auto& q : queries) {
+            EdgeId edge;
+            VertexId vertex;
+            FaceId face;
+            auto loc = subdiv.locate(q, edge, vertex, face, &cursor);
+            REQUIRE(face.valid());
+            auto const& vertices = subdiv.getFaceVertices(face);
+            if (loc == PtLoc::PTLOC_VERTEX) {
+                REQUIRE(std::count(vertices.begin(), vertices.end(), vertex) == 1);
+            } else {
+                REQUIRE(loc == PtLoc::PTLOC_INSIDE);
+                REQUIRE(sortedIds(vertices) == sortedIds(subdiv.locateVertexIdsArray(q)));
+            }
+        }
+    }
+
+    THEN("reinitializing should invalidate it") {
+        subdiv.initDelaunay(bounds);
+        REQUIRE_FALSE(subdiv.hasValidFaces());
+        subdiv.calcFaces();
+        REQUIRE(checkFaceTable(subdiv).size() == 1);
+    }
+}
+
+TEST_CASE("Lazy element ranges", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(300, 99.f);
+    Subdiv2D subdiv(bounds);
+    subdiv.insert(pts);
+    subdiv.calcVoronoi();
+    Subdiv2D const& constSubdiv = subdiv;
+
+    THEN("vertices() should give each vertex once, with the filters applied") {
+        std::size_t all = 0;
+        for (auto v : constSubdiv.vertices()) {
+            REQUIRE(v.position() == constSubdiv.getVertex(v.id));
+            ++all;
+        }
+        // The Voronoi vertices are there too.
+        REQUIRE(all > pts.size() + 3);
+
+        std::vector<Point2f> found;
+        for (auto v : constSubdiv.vertices(ElementFilter::SkipVirtual | ElementFilter::SkipBoundary)) {
+            REQUIRE(v.id.value() > 3);
+            found.push_back(v.position());
+        }
+        auto expected = pts;
+        auto byCoords = [](Point2f const& a, Point2f const& b) {
+            return std::make_tuple(a.x, a.y) < std::make_tuple(b.x, b.y);
+        };
+        std::sort(found.begin(), found.end(), byCoords);
+        std::sort(expected.begin(), expected.end(), byCoords);
+        REQUIRE(found == expected);
+
+        std::size_t real = 0;
+        for (auto v : constSubdiv.vertices(ElementFilter::SkipVirtual)) {
+            (void)v;
+            ++real;
+        }
+        REQUIRE(real == pts.size() + 3);
+    }
+
+    THEN("edges() should give the edges of getEdgeList(), and those of the bounding triangle") {
+        std::vector<Subdiv2D::Edge> expected;
+        constSubdiv.getEdgeList(expected);
+        std::size_t n = 0;
+        for (auto e : constSubdiv.edges()) {
+            REQUIRE(constSubdiv.edgeOrg(e.id) == e.org);
+            REQUIRE(constSubdiv.edgeDst(e.id) == e.dst);
+            auto pos = e.positions();
+            const bool listed = std::any_of(expected.begin(), expected.end(), [&](Subdiv2D::Edge const& other) {
+                return other.origin == pos.origin && other.destination == pos.destination;
+            });
+            REQUIRE((listed || (e.org.value() <= 3 && e.dst.value() <= 3)));
+            ++n;
+        }
+        REQUIRE(n == expected.size() + 3);
+        for (auto e : constSubdiv.edges(ElementFilter::SkipBoundary)) {
+            REQUIRE(e.org.value() > 3);
+            REQUIRE(e.dst.value() > 3);
+        }
+    }
+
+    THEN("triangles() should give the triangles of getTriangleList() but the outside") {
+        std::vector<Subdiv2D::Triangle> expected;
+        constSubdiv.getTriangleList(expected);
+        std::vector<Subdiv2D::Triangle> found;
+        for (auto t : constSubdiv.triangles()) {
+            REQUIRE(constSubdiv.edgeOrg(t.edge) == t.vertices[0]);
+            found.push_back(t.positions());
+        }
+        REQUIRE(found.size() == 2 * pts.size() + 1);
+        REQUIRE(found.size() + 1 == expected.size());
+        for (auto& tri : found) {
+            REQUIRE(std::find(expected.begin(), expected.end(), tri) != expected.end());
+        }
+
+        IndexedMesh mesh;
+        constSubdiv.getIndexedMesh(mesh);
+        std::size_t inner = 0;
+        for (auto t : constSubdiv.triangles(ElementFilter::SkipBoundary)) {
+            for (auto v : t.vertices) {
+                REQUIRE(v.value() > 3);
+            }
+            ++inner;
+        }
+        REQUIRE(inner == mesh.numTriangles());
+    }
+
+    THEN("an empty subdivision should give empty ranges") {
+        Subdiv2D empty;
+        REQUIRE(empty.vertices().begin() == empty.vertices().end());
+        REQUIRE(empty.edges().begin() == empty.edges().end());
+        REQUIRE(empty.triangles().begin() == empty.triangles().end());
+
+        Subdiv2D justBounds(bounds);
+        REQUIRE(std::distance(justBounds.triangles().begin(), justBounds.triangles().end()) == 1);
+        REQUIRE(justBounds.triangles(ElementFilter::SkipBoundary).begin() ==
+                justBounds.triangles(ElementFilter::SkipBoundary).end());
+    }
+}
+
+TEST_CASE("Vertex removal", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    auto pts = makeRandomPoints(600, 99.f);
+    // A grid patch, for cocircular holes.
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            pts.push_back(Point2f(60.5f + x, 60.5f + y));
+        }
+    }
+    Subdiv2D subdiv(bounds);
+    std::vector<VertexId> ids;
+    for (auto& pt : pts) {
+        ids.push_back(subdiv.insert(pt));
+    }
+    subdiv.calcVoronoi();
+
+    // Remove every third point, including some of the grid.
+    std::vector<Point2f> kept;
+    std::vector<VertexId> removed;
+    for (std::size_t i = 0; i < pts.size(); ++i) {
+        if (i % 3 == 0) {
+            subdiv.remove(ids[i]);
+            removed.push_back(ids[i]);
+        } else {
+            kept.push_back(pts[i]);
+        }
+    }
+    REQUIRE_NOTHROW(subdiv.checkSubdiv());
+
+    THEN("the triangulation should be the Delaunay triangulation of the rest") {
+        Subdiv2D fresh(bounds);
+        fresh.insert(kept);
+        // The grid's cocircular squares may be split either way: compare the rest.
+        auto inGrid = [](Subdiv2D::Triangle const& tri) {
+            return std::all_of(tri.begin(), tri.end(),
+                               [](Point2f const& p) { return p.x > 60 && p.x < 65 && p.y > 60 && p.y < 65; });
+        };
+        auto found = canonicalTriangles(subdiv);
+        auto expected = canonicalTriangles(fresh);
+        REQUIRE(found.size() == expected.size());
+        found.erase(std::remove_if(found.begin(), found.end(), inGrid), found.end());
+        expected.erase(std::remove_if(expected.begin(), expected.end(), inGrid), expected.end());
+        REQUIRE(found == expected);
+
+        std::vector<Point2f> vertices;
+        for (auto v : subdiv.vertices(ElementFilter::SkipVirtual | ElementFilter::SkipBoundary)) {
+            vertices.push_back(v.position());
+        }
+        REQUIRE(vertices.size() == kept.size());
+    }
+
+    THEN("the Voronoi diagram should be kept up to date") {
+        Subdiv2D fresh(bounds);
+        fresh.insert(kept);
+        // Only away from the grid, where the diagram does not depend on how cocircular squares are split.
+        auto facets = canonicalFacets(subdiv);
+        auto expected = canonicalFacets(fresh);
+        REQUIRE(facets.size() == expected.size());
+        for (auto& entry : expected) {
+            auto center = entry.first;
+            if (center.first > 57 && center.first < 68 && center.second > 57 && center.second < 68) {
+                continue;
+            }
+            auto& facet = facets[center];
+            REQUIRE(facet.size() == entry.second.size());
+            for (std::size_t i = 0; i < facet.size(); ++i) {
+                // Circumcenters are computed from a different first vertex, so may differ in rounding.
+                REQUIRE(facet[i].x == Approx(entry.second[i].x).epsilon(1e-4));
+                REQUIRE(facet[i].y == Approx(entry.second[i].y).epsilon(1e-4));
+            }
+        }
+    }
+
+    THEN("the IDs and edges should be reused by insertion") {
+        auto maxEdgeId = [&] {
+            int ret = 0;
+            for (auto e : subdiv.edges()) {
+                ret = std::max(ret, e.id.value());
+            }
+            return ret;
+        };
+        const auto numVertices = subdiv.getNumVertices();
+        const auto lastEdge = maxEdgeId();
+        // (Those freed by removal may have been taken by new Voronoi vertices, and vice versa.)
+        for (std::size_t i = 0; i < pts.size(); i += 3) {
+            subdiv.insert(pts[i]);
+        }
+        REQUIRE(subdiv.getNumVertices() == numVertices);
+        REQUIRE(maxEdgeId() <= lastEdge);
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+    }
+
+    THEN("without a Voronoi diagram, the next insertion should take the removed ID") {
+        Subdiv2D plain(bounds);
+        plain.insert(kept);
+        auto id = plain.findNearest(Point2f(50, 50));
+        plain.remove(id);
+        REQUIRE(plain.insert(Point2f(50, 50)) == id);
+    }
+
+    THEN("only inserted vertices may be removed") {
+        REQUIRE_THROWS(subdiv.remove(VertexId(1)));
+        REQUIRE_THROWS(subdiv.remove(removed.front()));
+        REQUIRE_THROWS(subdiv.remove(InvalidVertex));
+    }
+
+    THEN("removing every point should leave just the bounding triangle") {
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            if (i % 3 != 0) {
+                subdiv.remove(ids[i]);
+            }
+        }
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        REQUIRE(std::distance(subdiv.triangles().begin(), subdiv.triangles().end()) == 1);
+        REQUIRE(subdiv.insert(Point2f(50, 50)).valid());
+    }
+}
+
+TEST_CASE("Vertex relocation", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    auto pts = makeRandomPoints(600, 99.f);
+    Subdiv2D subdiv(bounds);
+    std::vector<VertexId> ids;
+    for (auto& pt : pts) {
+        ids.push_back(subdiv.insert(pt));
+    }
+    subdiv.calcVoronoi();
+    subdiv.calcFaces();
+
+    auto checkAgainstFresh = [&] {
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(subdiv.getVertex(ids[i]) == pts[i]);
+        }
+        Subdiv2D fresh(bounds);
+        fresh.insert(pts);
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(fresh));
+        auto facets = canonicalFacets(subdiv);
+        auto expected = canonicalFacets(fresh);
+        REQUIRE(facets.size() == expected.size());
+        for (auto& entry : expected) {
+            auto& facet = facets[entry.first];
+            REQUIRE(facet.size() == entry.second.size());
+            for (std::size_t i = 0; i < facet.size(); ++i) {
+                REQUIRE(facet[i].x == Approx(entry.second[i].x).epsilon(1e-4));
+                REQUIRE(facet[i].y == Approx(entry.second[i].y).epsilon(1e-4));
+            }
+        }
+    };
+
+    THEN("small moves should flip edges, keeping the Voronoi diagram and face table up to date") {
+        const auto offsets = makeRandomPoints(pts.size(), 0.02f, 3);
+        for (int pass = 0; pass < 3; ++pass) {
+            for (std::size_t i = 0; i < pts.size(); ++i) {
+                auto pt = pts[i] + offsets[(i + pass) % pts.size()] - Point2f(0.01f, 0.01f);
+                pt.x = std::min(std::max(pt.x, 0.f), 99.f);
+                pt.y = std::min(std::max(pt.y, 0.f), 99.f);
+                subdiv.move(ids[i], pt);
+                pts[i] = pt;
+            }
+        }
+        checkAgainstFresh();
+        REQUIRE(subdiv.hasValidFaces());
+        auto faces = checkFaceTable(subdiv);
+        REQUIRE(faces.size() == 2 * pts.size() + 1);
+    }
+
+    THEN("moves of about the spacing between points should give the same triangulation as building from scratch") {
+        const auto offsets = makeRandomPoints(pts.size(), 4.f, 7);
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            auto pt = pts[i] + offsets[i] - Point2f(2.f, 2.f);
+            pt.x = std::min(std::max(pt.x, 0.f), 99.f);
+            pt.y = std::min(std::max(pt.y, 0.f), 99.f);
+            subdiv.move(ids[i], pt);
+            pts[i] = pt;
+        }
+        checkAgainstFresh();
+    }
+
+    THEN("large moves should re-insert, keeping the IDs") {
+        const auto targets = makeRandomPoints(200, 99.f, 5);
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            subdiv.move(ids[i * 3], targets[i]);
+            pts[i * 3] = targets[i];
+        }
+        checkAgainstFresh();
+        subdiv.calcFaces();
+        checkFaceTable(subdiv);
+    }
+
+    THEN("moves onto other vertices, out of bounds, or of bounding vertices should be refused") {
+        REQUIRE_THROWS(subdiv.move(ids[0], pts[1]));
+        REQUIRE_THROWS(subdiv.move(ids[0], Point2f(-1, 50)));
+        REQUIRE_THROWS(subdiv.move(VertexId(2), Point2f(50, 50)));
+        checkAgainstFresh();
+    }
+}
+
+TEST_CASE("Compaction", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(900, 99.f);
+    Subdiv2D subdiv(bounds);
+    std::vector<VertexId> ids;
+    for (auto& pt : pts) {
+        ids.push_back(subdiv.insert(pt));
+    }
+    subdiv.calcVoronoi();
+    subdiv.calcFaces();
+    std::vector<Point2f> kept;
+    for (std::size_t i = 0; i < pts.size(); ++i) {
+        if (i % 3 == 0) {
+            subdiv.remove(ids[i]);
+        } else {
+            kept.push_back(pts[i]);
+        }
+    }
+    subdiv.calcFaces();
+    const auto triangles = canonicalTriangles(subdiv);
+    const auto facets = canonicalFacets(subdiv);
+
+    const auto vertexMap = subdiv.compact();
+    REQUIRE_NOTHROW(subdiv.checkSubdiv());
+
+    THEN("the vertices should be numbered densely, keeping their positions") {
+        REQUIRE(vertexMap.size() >= ids.size() + 4);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(vertexMap[i] == VertexId(i));
+        }
+        std::vector<int> newIds;
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            auto id = vertexMap[ids[i].get()];
+            if (i % 3 == 0) {
+                REQUIRE_FALSE(id.valid());
+            } else {
+                REQUIRE(subdiv.getVertex(id) == pts[i]);
+                newIds.push_back(id.value());
+            }
+        }
+        std::sort(newIds.begin(), newIds.end());
+        REQUIRE(newIds.front() == 4);
+        REQUIRE(newIds.back() == static_cast<int>(kept.size()) + 3);
+        REQUIRE(std::adjacent_find(newIds.begin(), newIds.end()) == newIds.end());
+    }
+
+    THEN("the triangulation, Voronoi diagram and face table should be the same") {
+        REQUIRE(canonicalTriangles(subdiv) == triangles);
+        REQUIRE(canonicalFacets(subdiv).size() == facets.size());
+        for (auto& entry : facets) {
+            auto found = canonicalFacets(subdiv)[entry.first];
+            REQUIRE(found.size() == entry.second.size());
+            for (std::size_t i = 0; i < found.size(); ++i) {
+                // Circumcenters are computed from a different first vertex, so may differ in rounding.
+                REQUIRE(found[i].x == Approx(entry.second[i].x).epsilon(1e-4));
+                REQUIRE(found[i].y == Approx(entry.second[i].y).epsilon(1e-4));
+            }
+        }
+        REQUIRE(subdiv.hasValidFaces());
+        REQUIRE(checkFaceTable(subdiv).size() == 2 * kept.size() + 1);
+    }
+
+    THEN("the Voronoi vertices should follow the inserted ones, and no slots should be free") {
+        std::size_t numVirtual = 0;
+        for (auto v : subdiv.vertices()) {
+            if (v.id.value() >= static_cast<int>(kept.size()) + 4) {
+                ++numVirtual;
+            }
+        }
+        REQUIRE(subdiv.getNumVertices() == kept.size() + 4 + numVirtual);
+        REQUIRE(std::distance(subdiv.vertices().begin(), subdiv.vertices().end()) ==
+                static_cast<std::ptrdiff_t>(subdiv.getNumVertices() - 1));
+        // 3n + 3 edges, and the placeholder.
+        int maxEdge = 0;
+        for (auto e : subdiv.edges()) {
+            maxEdge = std::max(maxEdge, e.id.value());
+        }
+        REQUIRE(maxEdge / 4 == static_cast<int>(3 * kept.size() + 3));
+    }
+
+    THEN("later changes should work as before") {
+        Subdiv2D fresh(bounds);
+        fresh.insert(pts);
+        for (std::size_t i = 0; i < pts.size(); i += 3) {
+            subdiv.insert(pts[i]);
+        }
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(fresh));
+        LocateCursor cursor;
+        for (std::size_t i = 1; i < pts.size(); i += 3) {
+            REQUIRE(subdiv.locateVertexIdsArray(pts[i], &cursor)[0] == vertexMap[ids[i].get()]);
+        }
+    }
+}
+
+TEST_CASE("Growable bounds", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    auto pts = makeRandomPoints(800, 99.f);
+    Subdiv2D subdiv(bounds);
+    std::vector<VertexId> ids;
+    for (auto& pt : pts) {
+        ids.push_back(subdiv.insert(pt));
+    }
+    subdiv.calcVoronoi();
+    subdiv.calcFaces();
+
+    auto checkAgainstFresh = [&] {
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(subdiv.getVertex(ids[i]) == pts[i]);
+        }
+        Subdiv2D fresh(subdiv.getBounds());
+        fresh.insert(pts);
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(fresh));
+        auto facets = canonicalFacets(subdiv);
+        auto expected = canonicalFacets(fresh);
+        REQUIRE(facets.size() == expected.size());
+        // Circumcenters of triangles with a bounding vertex are rounded in proportion to the size of the bounds.
+        const auto margin = 1e-5 * std::max(subdiv.getBounds().width, subdiv.getBounds().height);
+        for (auto& entry : expected) {
+            auto& facet = facets[entry.first];
+            REQUIRE(facet.size() == entry.second.size());
+            for (std::size_t i = 0; i < facet.size(); ++i) {
+                REQUIRE(facet[i].x == Approx(entry.second[i].x).epsilon(1e-4).margin(margin));
+                REQUIRE(facet[i].y == Approx(entry.second[i].y).epsilon(1e-4).margin(margin));
+            }
+        }
+    };
+
+    THEN("points outside should be refused unless the bounds are growable") {
+        REQUIRE_FALSE(subdiv.hasGrowableBounds());
+        REQUIRE_THROWS(subdiv.insert(Point2f(150, 50)));
+        REQUIRE(subdiv.getBounds() == bounds);
+        subdiv.setGrowableBounds(true);
+        REQUIRE(subdiv.hasGrowableBounds());
+        ids.push_back(subdiv.insert(Point2f(150, 50)));
+        pts.push_back(Point2f(150, 50));
+        // By half the width, or to the point if further.
+        REQUIRE(subdiv.getBounds() == Rect(0, 0, 151, 100));
+        checkAgainstFresh();
+        REQUIRE(subdiv.hasValidFaces());
+        REQUIRE(checkFaceTable(subdiv).size() == 2 * pts.size() + 1);
+    }
+
+    THEN("growing explicitly should move the bounding triangle out, keeping the Voronoi diagram and face table") {
+        subdiv.growBounds(Rect(50, 50, 10, 10));
+        REQUIRE(subdiv.getBounds() == bounds);
+        for (auto rect : {Rect(-20, 0, 1, 1), Rect(0, -300, 100, 100), Rect(0, 0, 4000, 100),
+                          Rect(-100000, -100000, 200000, 200000)}) {
+            subdiv.growBounds(rect);
+            checkAgainstFresh();
+            REQUIRE(subdiv.hasValidFaces());
+            REQUIRE(checkFaceTable(subdiv).size() == 2 * pts.size() + 1);
+        }
+        REQUIRE(subdiv.getBounds() == Rect(-100000, -100000, 200000, 200000));
+        REQUIRE_THROWS(subdiv.growBounds(Rect(0, 0, 1 << 25, 1)));
+    }
+
+    THEN("growing should rebuild the triangulation, keeping the vertex IDs, if the bounding vertices cannot move") {
+        detail::SubdivTestAccess::setMaxBoundingVertexSteps(subdiv, 0);
+        subdiv.setGrowableBounds(true);
+        for (auto rect : {Rect(-20, 0, 1, 1), Rect(0, 0, 4000, 100)}) {
+            subdiv.growBounds(rect);
+            checkAgainstFresh();
+            REQUIRE(subdiv.hasValidFaces());
+            REQUIRE(checkFaceTable(subdiv).size() == 2 * pts.size() + 1);
+        }
+        ids.push_back(subdiv.insert(Point2f(-3000, 20)));
+        pts.push_back(Point2f(-3000, 20));
+        checkAgainstFresh();
+        for (std::size_t i = 0; i < ids.size(); i += 50) {
+            EdgeId edge;
+            VertexId vertex;
+            REQUIRE(PtLoc::PTLOC_VERTEX == subdiv.locate(pts[i], edge, vertex));
+            REQUIRE(vertex == ids[i]);
+        }
+    }
+
+    THEN("points walking outward should grow the bounds only a few times, and moves should grow them too") {
+        subdiv.setGrowableBounds(true);
+        std::set<int> widths;
+        for (int i = 1; i <= 200; ++i) {
+            const Point2f pt(50.f + 10.f * i, 0.5f * i);
+            ids.push_back(subdiv.insert(pt));
+            pts.push_back(pt);
+            widths.insert(subdiv.getBounds().width);
+        }
+        REQUIRE(widths.size() < 10);
+        subdiv.move(ids[0], Point2f(-75.5f, 20));
+        pts[0] = Point2f(-75.5f, 20);
+        checkAgainstFresh();
+    }
+
+    THEN("inserting a batch should grow the bounds once, before any are inserted") {
+        subdiv.setGrowableBounds(true);
+        const auto batch = makeRandomPoints(300, 1000.f, 3);
+        const auto batchIds = subdiv.insert(batch);
+        ids.insert(ids.end(), batchIds.begin(), batchIds.end());
+        pts.insert(pts.end(), batch.begin(), batch.end());
+        checkAgainstFresh();
+    }
+}
+
+TEST_CASE("Growable bounds past 46341 on a side", "[Subdivision2d]") {
+    // Where the area of the bounds no longer fits in an int.
+    const Rect bounds(0, 0, 65536, 65536);
+    auto pts = makeRandomPoints(500, 65535.f);
+    Subdiv2D subdiv(bounds);
+    auto ids = subdiv.insert(pts);
+
+    auto checkAgainstFresh = [&](Rect expectedBounds) {
+        REQUIRE(subdiv.getBounds() == expectedBounds);
+        REQUIRE_NOTHROW(subdiv.checkSubdiv());
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(subdiv.getVertex(ids[i]) == pts[i]);
+        }
+        Subdiv2D fresh(expectedBounds);
+        fresh.insert(pts);
+        REQUIRE(canonicalTriangles(subdiv) == canonicalTriangles(fresh));
+    };
+
+    THEN("growing explicitly should take the union with the old bounds") {
+        subdiv.growBounds(Rect(-10, -10, 5, 5));
+        checkAgainstFresh(Rect(-10, -10, 65546, 65546));
+        subdiv.growBounds(Rect(0, 0, 100000, 70000));
+        checkAgainstFresh(Rect(-10, -10, 100010, 70010));
+    }
+
+    THEN("inserting a point outside should grow them by half their size") {
+        subdiv.setGrowableBounds(true);
+        ids.push_back(subdiv.insert(Point2f(-1.5f, 100)));
+        pts.push_back(Point2f(-1.5f, 100));
+        checkAgainstFresh(Rect(-32768, 0, 98304, 65536));
+    }
+}
+
+TEST_CASE("Published versions", "[Subdivision2d]") {
+    const Rect bounds(0, 0, 100, 100);
+    const auto pts = makeRandomPoints(2000, 99.f);
+    // Version k has the first 200 * k points.
+    const std::size_t PerVersion = 200;
+    auto nextVersion = [&](Subdiv2D subdiv, std::uint64_t version) {
+        subdiv.insert(
+            std::vector<Point2f>(pts.begin() + (version - 1) * PerVersion, pts.begin() + version * PerVersion));
+        return subdiv;
+    };
+    auto numPoints = [](Subdiv2D const& subdiv) {
+        auto range = subdiv.vertices(ElementFilter::SkipVirtual | ElementFilter::SkipBoundary);
+        return static_cast<std::size_t>(std::distance(range.begin(), range.end()));
+    };
+    VersionPublisher<Subdiv2D> publisher(nextVersion(Subdiv2D(bounds), 1));
+    REQUIRE(publisher.currentVersion() == 1);
+
+    THEN("a pinned version should stay as it was while newer ones are published, until released") {
+        VersionReader<Subdiv2D> reader(publisher);
+        auto pinned = reader.pin();
+        REQUIRE(pinned.version() == 1);
+        REQUIRE(publisher.publish(nextVersion(publisher.copyCurrent(), 2)) == 2);
+        REQUIRE(publisher.currentVersion() == 2);
+        REQUIRE(numPoints(*pinned) == PerVersion);
+        REQUIRE_NOTHROW(pinned->checkSubdiv());
+        REQUIRE(publisher.numRetired() == 1);
+        REQUIRE(publisher.reclaim() == 1);
+        REQUIRE_THROWS(reader.pin());
+
+        pinned.release();
+        REQUIRE_FALSE(pinned);
+        REQUIRE(publisher.reclaim() == 0);
+        auto current = reader.pin();
+        REQUIRE(current.version() == 2);
+        REQUIRE(numPoints(*current) == 2 * PerVersion);
+    }
+
+    THEN("readers should each see whole versions, never going back, while a writer publishes") {
+        const std::size_t numThreads = 4;
+        std::atomic<bool> done(false);
+        std::vector<std::vector<std::pair<std::uint64_t, std::size_t> > > seen(numThreads);
+        std::vector<std::size_t> behind(numThreads, 0);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t] {
+                VersionReader<Subdiv2D> reader(publisher);
+                LocateCursor cursor;
+                std::size_t i = t;
+                do {
+                    // The version number is read without pinning anything, while versions are being deleted.
+                    const auto latest = publisher.currentVersion();
+                    auto pinned = reader.pin();
+                    if (pinned.version() < latest) {
+                        ++behind[t];
+                    }
+                    // Query it as well, to touch the arrays while newer versions replace it.
+                    pinned->findNearest(pts[i++ % pts.size()], nullptr, &cursor);
+                    seen[t].emplace_back(pinned.version(), numPoints(*pinned));
+                } while (!done);
+            });
+        }
+        for (std::uint64_t version = 2; version <= pts.size() / PerVersion; ++version) {
+            REQUIRE(publisher.publish(nextVersion(publisher.copyCurrent(), version)) == version);
+            std::this_thread::yield();
+        }
+        done = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (auto n : behind) {
+            REQUIRE(n == 0);
+        }
+        for (auto& results : seen) {
+            REQUIRE_FALSE(results.empty());
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                REQUIRE(results[i].second == results[i].first * PerVersion);
+                if (i > 0) {
+                    REQUIRE(results[i].first >= results[i - 1].first);
+                }
+            }
+        }
+        REQUIRE(publisher.reclaim() == 0);
+    }
+
+    THEN("containers should be publishable as well") {
+        SubdivContainer<double> container(bounds);
+        container.insert(pts[0], 1.0);
+        VersionPublisher<SubdivContainer<double> > containers(container);
+        container.insert(pts[1], 2.0);
+        containers.publish(container);
+        VersionReader<SubdivContainer<double> > reader(containers);
+        auto pinned = reader.pin();
+        REQUIRE(pinned->get(pts[0]) == 1.0);
+        REQUIRE(pinned->get(pts[1]) == 2.0);
+    }
+}
@@ -0,0 +1,56 @@
+/** @file
+    @brief Header with point sets and comparisons shared by the tests.
+
+    @date 2017
+
+    @author
+    Sensics, Inc.
+    <http://sensics.com/osvr>
+
+    SPDX-License-Identifier:BSD-3-Clause
+*/
+
+// Copyright 2017 Sensics, Inc.
+
+#ifndef INCLUDED_TestPoints_h_GUID_2F6A9C41_7B3E_4D58_A1C0_95E7D24B8F13
+#define INCLUDED_TestPoints_h_GUID_2F6A9C41_7B3E_4D58_A1C0_95E7D24B8F13
+
+#include <subdiv2d/Subdivision2D.h>
+#include <subdiv2d/Types.h>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+/// Uniformly-distributed points in [0, size) x [0, size), reproducible for a given seed.
+inline std::vector<sensics::subdiv2d::Point2f> makeRandomPoints(std::size_t n, float size, unsigned int seed = 42) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.f, size);
+    std::vector<sensics::subdiv2d::Point2f> ret;
+    for (std::size_t i = 0; i < n; ++i) {
+        ret.emplace_back(dist(rng), dist(rng));
+    }
+    return ret;
+}
+
+/// The triangles of a subdivision (all but the outer face), each with its vertices rotated so the lexicographically
+/// least comes first, then sorted, so that two triangulations can be compared regardless of vertex and edge numbering.
+inline std::vector<sensics::subdiv2d::Subdiv2D::Triangle>
+canonicalTriangles(sensics::subdiv2d::Subdiv2D const& subdiv) {
+    using sensics::subdiv2d::Point2f;
+    using sensics::subdiv2d::Subdiv2D;
+    auto less = [](Point2f const& a, Point2f const& b) { return std::tie(a.x, a.y) < std::tie(b.x, b.y); };
+    std::vector<Subdiv2D::Triangle> ret;
+    for (auto t : subdiv.triangles()) {
+        auto tri = t.positions();
+        std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end(), less), tri.end());
+        ret.push_back(tri);
+    }
+    std::sort(ret.begin(), ret.end(), [&](Subdiv2D::Triangle const& a, Subdiv2D::Triangle const& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), less);
+    });
+    return ret;
+}
+
+#endif // INCLUDED_TestPoints_h_GUID_2F6A9C41_7B3E_4D58_A1C0_95E7D24B8F13